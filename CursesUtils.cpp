@@ -1,64 +1,133 @@
-#include "CursesUtils.h"
-#include "curses.h"
-
-void InitializeCurses(bool noDelay)
-{
-	initscr();
-	noecho();
-	curs_set(false);
-
-	nodelay(stdscr, noDelay);
-	keypad(stdscr, true);
-}
-
-void ShutDownCurses()
-{
-	endwin();
-}
-void ClearScreen()
-{
-	clear();
-}
-
-void RefreshScreen()
-{
-	refresh();
-}
-
-int ScreenWidth()
-{
-	return COLS;
-}
-
-int ScreenHeight()
-{
-	return LINES;
-}
-
-int GetChar()
-{
-	return getch();
-}
-
-void DrawCharacter(int xPos, int yPos, char aCharacter)
-{
-	mvaddch(yPos, xPos, aCharacter);
-}
-
-void MoveCursor(int xPos, int yPos)
-{
-	move(yPos, xPos);
-}
-
-void DrawSprite(int xPos, int yPos, const char* sprite[], int spriteHeight, int offset)
-{
-	for (int h = 0; h < spriteHeight; h++)
-	{
-		mvprintw(yPos + h, xPos, "%s", sprite[h+offset]);
-	}
-}
-
-void DrawString(int xPos, int yPos, const std::string& string)
-{
-	mvprintw(yPos, xPos, string.c_str());
-}
\ No newline at end of file
+#include "CursesUtils.h"
+#include "curses.h"
+
+void InitializeCurses(bool noDelay)
+{
+	initscr();
+	noecho();
+	curs_set(false);
+
+	nodelay(stdscr, noDelay);
+	keypad(stdscr, true);
+}
+
+bool InitializeOffscreenCurses(int width, int height)
+{
+#ifdef _WIN32
+	const char* NULL_DEVICE = "NUL";
+#else
+	const char* NULL_DEVICE = "/dev/null";
+#endif
+
+	FILE* out = fopen(NULL_DEVICE, "w");
+	FILE* in = fopen(NULL_DEVICE, "r");
+
+	if (out == nullptr || in == nullptr || newterm("dumb", out, in) == nullptr) // any terminal type will do, nothing is ever sent to it
+	{
+		if (out != nullptr)
+		{
+			fclose(out);
+		}
+		if (in != nullptr)
+		{
+			fclose(in);
+		}
+		return false;
+	}
+
+	resize_term(height, width);
+	return true;
+}
+
+void ShutDownCurses()
+{
+	endwin();
+}
+void ClearScreen()
+{
+	clear();
+}
+
+void ClearScreenArea(int width, int height)
+{
+	for (int y = 0; y < height; y++)
+	{
+		mvhline(y, 0, ' ', width);
+	}
+}
+
+void RefreshScreen()
+{
+	refresh();
+}
+
+int ScreenWidth()
+{
+	return COLS;
+}
+
+int ScreenHeight()
+{
+	return LINES;
+}
+
+int GetChar()
+{
+	return getch();
+}
+
+void DrawCharacter(int xPos, int yPos, char aCharacter)
+{
+	mvaddch(yPos, xPos, aCharacter);
+}
+
+void MoveCursor(int xPos, int yPos)
+{
+	move(yPos, xPos);
+}
+
+void DrawSprite(int xPos, int yPos, const char* const sprite[], int spriteHeight, int offset)
+{
+	for (int h = 0; h < spriteHeight; h++)
+	{
+		mvprintw(yPos + h, xPos, "%s", sprite[h+offset]);
+	}
+}
+
+void DrawString(int xPos, int yPos, const std::string& string)
+{
+	mvprintw(yPos, xPos, string.c_str());
+}
+
+void DrawCells(const char* cells, int width, int height)
+{
+	for (int y = 0; y < height; y++)
+	{
+		mvaddnstr(y, 0, cells + y * width, width);
+	}
+}
+
+void ReadScreenRow(int yPos, char* row, int width)
+{
+	const int CHUNK_SIZE = 256;
+	char buffer[CHUNK_SIZE + 1];
+
+	for (int x = 0; x < width; x += CHUNK_SIZE)
+	{
+		int numToRead = (width - x < CHUNK_SIZE) ? width - x : CHUNK_SIZE;
+		int numRead = mvinnstr(yPos, x, buffer, numToRead);
+
+		for (int i = 0; i < numToRead; i++)
+		{
+			row[x + i] = (i < numRead && buffer[i] != '\0') ? buffer[i] : ' ';
+		}
+	}
+}
+
+void ReadScreen(char* cells, int width, int height)
+{
+	for (int y = 0; y < height; y++)
+	{
+		ReadScreenRow(y, cells + y * width, width);
+	}
+}
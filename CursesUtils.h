@@ -1,30 +1,35 @@
-#pragma once
-#ifndef CURSESUTILS_H_
-#define CURSESUTILS_H_
-
-#include <string>
-#include <curses.h>
-
-
-enum ArrowKeys
-{
-	AK_UP = KEY_UP,
-	AK_DOWN = KEY_DOWN,
-	AK_LEFT = KEY_LEFT,
-	AK_RIGHT = KEY_RIGHT
-};
-
-void InitializeCurses(bool nodelay);
-void ShutDownCurses();
-void ClearScreen();
-void RefreshScreen();
-int ScreenWidth();
-int ScreenHeight();
-int GetChar();
-void DrawCharacter(int xPos, int yPos, char aCharacter);
-void MoveCursor(int xPos, int yPos);
-void DrawSprite(int xPos, int yPos, const char* sprite[], int spriteHeight, int offset = 0);
-void DrawString(int xPos, int yPos, const std::string& string);
-
-#endif // CURSESUTILS_H_
-
+#pragma once
+#ifndef CURSESUTILS_H_
+#define CURSESUTILS_H_
+
+#include <string>
+#include <curses.h>
+
+
+enum ArrowKeys
+{
+	AK_UP = KEY_UP,
+	AK_DOWN = KEY_DOWN,
+	AK_LEFT = KEY_LEFT,
+	AK_RIGHT = KEY_RIGHT
+};
+
+void InitializeCurses(bool nodelay);
+bool InitializeOffscreenCurses(int width, int height); // a screen that is drawn and read back but never shown - returns false if curses could not make one
+void ShutDownCurses();
+void ClearScreen();
+void ClearScreenArea(int width, int height); // just the top left corner, without clearing the whole screen
+void RefreshScreen();
+int ScreenWidth();
+int ScreenHeight();
+int GetChar();
+void DrawCharacter(int xPos, int yPos, char aCharacter);
+void MoveCursor(int xPos, int yPos);
+void DrawSprite(int xPos, int yPos, const char* const sprite[], int spriteHeight, int offset = 0);
+void DrawString(int xPos, int yPos, const std::string& string);
+void DrawCells(const char* cells, int width, int height); // draws a whole screen of characters, row by row
+void ReadScreenRow(int yPos, char* row, int width); // copies what has been drawn on a row (characters only), space padded to width
+void ReadScreen(char* cells, int width, int height); // copies the whole screen, row by row
+
+#endif // CURSESUTILS_H_
+
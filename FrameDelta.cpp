@@ -0,0 +1,121 @@
+
+#include "FrameDelta.h"
+
+void EncodeFrameDelta(const char* previous, const char* current, int numCells, std::string& out)
+{
+	int cell = 0;
+	int lastRunEnd = 0;
+
+	while (cell < numCells)
+	{
+		if (current[cell] == previous[cell])
+		{
+			cell++;
+			continue;
+		}
+
+		char value = current[cell];
+		int runStart = cell;
+
+		while (cell < numCells && current[cell] == value && current[cell] != previous[cell])
+		{
+			cell++;
+		}
+
+		WriteVarInt(out, runStart - lastRunEnd);
+		WriteVarInt(out, cell - runStart);
+		out.push_back(value);
+
+		lastRunEnd = cell;
+	}
+}
+
+bool ApplyFrameDelta(const unsigned char* data, size_t length, char* cells, int numCells)
+{
+	const unsigned char* end = data + length;
+	unsigned int cell = 0;
+
+	while (data < end)
+	{
+		unsigned int skip;
+		unsigned int count;
+
+		if (!ReadVarInt(data, end, skip) || !ReadVarInt(data, end, count) || data >= end)
+		{
+			return false;
+		}
+
+		char value = (char)*data++;
+		cell += skip;
+
+		if (cell + count > (unsigned int)numCells)
+		{
+			return false;
+		}
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			cells[cell++] = value;
+		}
+	}
+
+	return true;
+}
+
+void WriteVarInt(std::string& out, unsigned int value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back((char)value);
+}
+
+bool ReadVarInt(const unsigned char*& data, const unsigned char* end, unsigned int& value)
+{
+	value = 0;
+
+	for (int shift = 0; shift < 35 && data < end; shift += 7)
+	{
+		unsigned char byte = *data++;
+		value |= (unsigned int)(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WriteUInt16(std::string& out, unsigned int value)
+{
+	out.push_back((char)(value & 0xFF));
+	out.push_back((char)((value >> 8) & 0xFF));
+}
+
+void WriteUInt32(std::string& out, unsigned int value)
+{
+	WriteUInt16(out, value & 0xFFFF);
+	WriteUInt16(out, value >> 16);
+}
+
+void PatchUInt32(std::string& out, size_t offset, unsigned int value)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		out[offset + i] = (char)((value >> (8 * i)) & 0xFF);
+	}
+}
+
+unsigned int ReadUInt16(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8);
+}
+
+unsigned int ReadUInt32(const unsigned char* data)
+{
+	return ReadUInt16(data) | (ReadUInt16(data + 2) << 16);
+}
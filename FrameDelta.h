@@ -0,0 +1,35 @@
+#pragma once
+#ifndef FRAMEDELTA_H_
+#define FRAMEDELTA_H_
+
+#include <cstddef>
+#include <string>
+
+/*
+Frame Delta:
+
+Encodes the difference between two character grids of the same size as a list of runs:
+
+varint skip - number of cells that did not change
+varint count - number of changed cells that follow, all with the same character
+char value - the character for those cells
+
+repeated until the end of the grid. Cells that did not change cost nothing except the skip, so a typical frame where a
+few aliens step over costs a few dozen bytes. Encoding against an all blank grid gives a keyframe.
+*/
+
+void EncodeFrameDelta(const char* previous, const char* current, int numCells, std::string& out); // appends to out
+bool ApplyFrameDelta(const unsigned char* data, size_t length, char* cells, int numCells); // returns false if the data is malformed
+
+void WriteVarInt(std::string& out, unsigned int value);
+bool ReadVarInt(const unsigned char*& data, const unsigned char* end, unsigned int& value);
+
+/* Little endian helpers for the formats built on top of frame deltas */
+
+void WriteUInt16(std::string& out, unsigned int value);
+void WriteUInt32(std::string& out, unsigned int value);
+void PatchUInt32(std::string& out, size_t offset, unsigned int value); // overwrites a value written earlier, e.g. a length
+unsigned int ReadUInt16(const unsigned char* data);
+unsigned int ReadUInt32(const unsigned char* data);
+
+#endif // FRAMEDELTA_H_
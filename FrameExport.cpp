@@ -0,0 +1,331 @@
+
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FrameExport.h"
+#include "CursesUtils.h"
+#include "TextInvaders.h"
+
+static const uint32_t CACHE_LINE_SIZE = 64; // keeps slots from sharing cache lines with the header or each other
+
+/* Shared memory helpers */
+
+static void* MapSharedMemory(FrameExporter& exporter, uint32_t size, bool create)
+{
+#ifdef _WIN32
+	HANDLE handle;
+	if (create)
+	{
+		handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, size, exporter.name);
+	}
+	else
+	{
+		handle = OpenFileMappingA(FILE_MAP_READ, FALSE, exporter.name);
+	}
+
+	if (handle == NULL)
+	{
+		return nullptr;
+	}
+
+	void* memory = MapViewOfFile(handle, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+	if (memory == NULL)
+	{
+		CloseHandle(handle);
+		return nullptr;
+	}
+
+	exporter.mappingHandle = handle;
+	return memory;
+#else
+	int fd = shm_open(exporter.name, create ? (O_CREAT | O_RDWR) : O_RDONLY, 0644);
+	if (fd < 0)
+	{
+		return nullptr;
+	}
+
+	if (create && ftruncate(fd, size) != 0)
+	{
+		close(fd);
+		shm_unlink(exporter.name);
+		return nullptr;
+	}
+
+	if (size == 0) // reader - map as much as the writer made
+	{
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(FrameExportHeader))
+		{
+			close(fd);
+			return nullptr;
+		}
+		size = (uint32_t)info.st_size;
+	}
+
+	void* memory = mmap(nullptr, size, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // the mapping keeps the memory alive
+
+	if (memory == MAP_FAILED)
+	{
+		if (create)
+		{
+			shm_unlink(exporter.name);
+		}
+		return nullptr;
+	}
+
+	exporter.mappingSize = size;
+	return memory;
+#endif
+}
+
+static void UnmapSharedMemory(FrameExporter& exporter)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(exporter.header);
+	CloseHandle((HANDLE)exporter.mappingHandle);
+#else
+	munmap(exporter.header, exporter.mappingSize);
+	if (exporter.isWriter)
+	{
+		shm_unlink(exporter.name);
+	}
+#endif
+}
+
+static uint32_t RoundUp(uint32_t value, uint32_t multiple)
+{
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+static unsigned char* GetSlot(const FrameExporter& exporter, uint32_t frameNumber)
+{
+	return exporter.slots + (frameNumber % exporter.header->numSlots) * exporter.header->slotSize;
+}
+
+/* Writer */
+
+bool InitFrameExport(FrameExporter& exporter, const char* name, int width, int height)
+{
+	exporter.header = nullptr;
+	exporter.slots = nullptr;
+	exporter.frameNumber = 0;
+	exporter.isWriter = true;
+	strncpy(exporter.name, name, sizeof(exporter.name) - 1);
+	exporter.name[sizeof(exporter.name) - 1] = '\0';
+
+	uint32_t entitiesOffset = sizeof(FrameSlotHeader);
+	uint32_t cellsOffset = entitiesOffset + FRAME_EXPORT_MAX_ENTITIES * sizeof(FrameEntity);
+	uint32_t slotSize = RoundUp(cellsOffset + width * height, CACHE_LINE_SIZE);
+	uint32_t headerSize = RoundUp(sizeof(FrameExportHeader), CACHE_LINE_SIZE);
+
+	exporter.mappingSize = headerSize + FRAME_EXPORT_NUM_SLOTS * slotSize;
+
+	void* memory = MapSharedMemory(exporter, exporter.mappingSize, true);
+	if (memory == nullptr)
+	{
+		return false;
+	}
+
+	memset(memory, 0, exporter.mappingSize);
+
+	exporter.header = new (memory) FrameExportHeader;
+	exporter.slots = (unsigned char*)memory + headerSize;
+
+	exporter.header->width = width;
+	exporter.header->height = height;
+	exporter.header->numSlots = FRAME_EXPORT_NUM_SLOTS;
+	exporter.header->slotSize = slotSize;
+	exporter.header->entitiesOffset = entitiesOffset;
+	exporter.header->cellsOffset = cellsOffset;
+	exporter.header->latestFrame.store(0, std::memory_order_relaxed);
+
+	for (int i = 0; i < FRAME_EXPORT_NUM_SLOTS; i++)
+	{
+		FrameSlotHeader* slot = new (exporter.slots + i * slotSize) FrameSlotHeader;
+		slot->sequence.store(0, std::memory_order_relaxed);
+	}
+
+	exporter.header->version = FRAME_EXPORT_VERSION;
+	std::atomic_thread_fence(std::memory_order_release);
+	exporter.header->magic = FRAME_EXPORT_MAGIC; // readers treat the mapping as valid once the magic is there
+
+	return true;
+}
+
+static void AddEntity(FrameEntity entities[], uint8_t& numEntities, FrameEntityType type, int x, int y, int width, int height, int state)
+{
+	if (numEntities < FRAME_EXPORT_MAX_ENTITIES)
+	{
+		FrameEntity& entity = entities[numEntities++];
+		entity.x = (int16_t)x;
+		entity.y = (int16_t)y;
+		entity.type = (uint8_t)type;
+		entity.state = (uint8_t)state;
+		entity.width = (uint8_t)width;
+		entity.height = (uint8_t)height;
+	}
+}
+
+void PublishFrame(FrameExporter& exporter, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo)
+{
+	if (exporter.header == nullptr)
+	{
+		return;
+	}
+
+	uint32_t frameNumber = ++exporter.frameNumber;
+	unsigned char* slotMemory = GetSlot(exporter, frameNumber);
+	FrameSlotHeader* slot = (FrameSlotHeader*)slotMemory;
+	FrameEntity* entities = (FrameEntity*)(slotMemory + exporter.header->entitiesOffset);
+	char* cells = (char*)(slotMemory + exporter.header->cellsOffset);
+
+	uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+	slot->sequence.store(sequence + 1, std::memory_order_relaxed); // odd - readers will back off
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot->frameNumber = frameNumber;
+	slot->score = player.score;
+	slot->gameState = (uint8_t)game.currentState;
+	slot->level = (uint8_t)game.level;
+	slot->lives = (uint8_t)player.lives;
+
+	uint8_t numEntities = 0;
+
+	if (game.currentState == GS_PLAY || game.currentState == GS_PLAYER_DEAD || game.currentState == GS_WAIT) // same screens DrawGame draws the playfield on
+	{
+		AddEntity(entities, numEntities, FET_PLAYER, player.position.x, player.position.y, player.spriteSize.width, player.spriteSize.height, player.animation);
+
+		if (player.missile.x != NOT_IN_PLAY)
+		{
+			AddEntity(entities, numEntities, FET_PLAYER_MISSILE, player.missile.x, player.missile.y, 1, 1, 0);
+		}
+
+		for (int i = 0; i < numberOfShields; i++)
+		{
+			AddEntity(entities, numEntities, FET_SHIELD, shields[i].position.x, shields[i].position.y, SHIELD_SPRITE_WIDTH, SHIELD_SPRITE_HEIGHT, 0);
+		}
+
+		for (int row = 0; row < NUM_ALIEN_ROWS; row++)
+		{
+			for (int col = 0; col < NUM_ALIEN_COLUMNS; col++)
+			{
+				if (aliens.aliens[row][col] != AS_DEAD)
+				{
+					int xPos = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
+					int yPos = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING);
+
+					AddEntity(entities, numEntities, FET_ALIEN, xPos, yPos, aliens.spriteSize.width, aliens.spriteSize.height, aliens.aliens[row][col]);
+				}
+			}
+		}
+
+		for (int i = 0; i < MAX_NUMBER_OF_ALIEN_BOMBS; i++)
+		{
+			if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
+			{
+				AddEntity(entities, numEntities, FET_ALIEN_BOMB, aliens.bombs[i].position.x, aliens.bombs[i].position.y, 1, 1, aliens.bombs[i].animation);
+			}
+		}
+
+		if (ufo.position.x != NOT_IN_PLAY)
+		{
+			AddEntity(entities, numEntities, FET_ALIEN_UFO, ufo.position.x, ufo.position.y, ufo.size.width, ufo.size.height, 0);
+		}
+	}
+
+	slot->numEntities = numEntities;
+
+	ReadScreen(cells, exporter.header->width, exporter.header->height);
+
+	slot->sequence.store(sequence + 2, std::memory_order_release); // even again - frame is consistent
+	exporter.header->latestFrame.store(frameNumber, std::memory_order_release);
+}
+
+void ShutDownFrameExport(FrameExporter& exporter)
+{
+	if (exporter.header != nullptr)
+	{
+		UnmapSharedMemory(exporter);
+		exporter.header = nullptr;
+		exporter.slots = nullptr;
+	}
+}
+
+/* Reader */
+
+bool OpenFrameExport(FrameExporter& reader, const char* name)
+{
+	reader.header = nullptr;
+	reader.slots = nullptr;
+	reader.mappingSize = 0;
+	reader.frameNumber = 0;
+	reader.isWriter = false;
+	strncpy(reader.name, name, sizeof(reader.name) - 1);
+	reader.name[sizeof(reader.name) - 1] = '\0';
+
+	FrameExportHeader* header = (FrameExportHeader*)MapSharedMemory(reader, 0, false);
+	if (header == nullptr)
+	{
+		return false;
+	}
+
+	reader.header = header;
+
+	if (header->magic != FRAME_EXPORT_MAGIC || header->version != FRAME_EXPORT_VERSION)
+	{
+		ShutDownFrameExport(reader);
+		return false;
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	reader.slots = (unsigned char*)header + RoundUp(sizeof(FrameExportHeader), CACHE_LINE_SIZE);
+
+	return true;
+}
+
+const FrameSlotHeader* BeginReadFrame(const FrameExporter& reader, uint32_t& sequence)
+{
+	uint32_t latestFrame = reader.header->latestFrame.load(std::memory_order_acquire);
+	if (latestFrame == 0)
+	{
+		return nullptr;
+	}
+
+	const FrameSlotHeader* slot = (const FrameSlotHeader*)GetSlot(reader, latestFrame);
+	sequence = slot->sequence.load(std::memory_order_acquire);
+
+	if (sequence & 1) // the writer already lapped the ring and is rewriting this slot
+	{
+		return nullptr;
+	}
+
+	return slot;
+}
+
+bool EndReadFrame(const FrameSlotHeader* slot, uint32_t sequence)
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+const FrameEntity* GetFrameEntities(const FrameExporter& exporter, const FrameSlotHeader* slot)
+{
+	return (const FrameEntity*)((const unsigned char*)slot + exporter.header->entitiesOffset);
+}
+
+const char* GetFrameCells(const FrameExporter& exporter, const FrameSlotHeader* slot)
+{
+	return (const char*)((const unsigned char*)slot + exporter.header->cellsOffset);
+}
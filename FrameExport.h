@@ -0,0 +1,110 @@
+#pragma once
+#ifndef FRAMEEXPORT_H_
+#define FRAMEEXPORT_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "TextInvaders.h"
+
+/*
+Frame Export:
+
+Publishes every finished frame into a named shared memory ring so other processes (viewers, bots, training code) can
+watch a live game without the game drawing anything extra. Each frame is the character grid DrawGame produced plus a
+compact table of the entities on screen.
+
+Memory layout (all offsets from the start of the mapping):
+
+FrameExportHeader
+slot 0: FrameSlotHeader, FrameEntity[FRAME_EXPORT_MAX_ENTITIES], char cells[width * height]
+slot 1: ...
+...
+slot numSlots - 1
+
+Every slot is guarded by its own sequence lock. The writer makes the sequence odd, writes the slot, then makes it even
+again. A reader loads the sequence, reads the slot in place (no copy needed), then loads the sequence again - if it
+changed or was odd, the frame was overwritten under it and it should move on to a newer one. The writer never waits for
+readers, so readers can poll at any rate.
+*/
+
+enum
+{
+	FRAME_EXPORT_MAGIC = 0x58464954, // "TIFX" in memory
+	FRAME_EXPORT_VERSION = 1,
+	FRAME_EXPORT_NUM_SLOTS = 8,
+	FRAME_EXPORT_MAX_ENTITIES = 80,
+};
+
+enum FrameEntityType
+{
+	FET_PLAYER = 0,
+	FET_PLAYER_MISSILE,
+	FET_ALIEN,
+	FET_ALIEN_BOMB,
+	FET_ALIEN_UFO,
+	FET_SHIELD
+};
+
+struct FrameEntity
+{
+	int16_t x;
+	int16_t y;
+	uint8_t type; // FrameEntityType
+	uint8_t state; // AlienState for aliens, animation frame for everything else
+	uint8_t width;
+	uint8_t height;
+};
+
+struct FrameSlotHeader
+{
+	std::atomic<uint32_t> sequence; // odd while the writer is inside the slot
+	uint32_t frameNumber;
+	int32_t score;
+	uint8_t gameState;
+	uint8_t level;
+	uint8_t lives;
+	uint8_t numEntities;
+};
+
+struct FrameExportHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t numSlots;
+	uint32_t slotSize; // bytes from one slot to the next
+	uint32_t entitiesOffset; // from the start of a slot
+	uint32_t cellsOffset; // from the start of a slot
+	std::atomic<uint32_t> latestFrame; // frame number of the newest complete slot, 0 until the first frame is out
+};
+
+struct FrameExporter
+{
+	FrameExportHeader* header;
+	unsigned char* slots;
+	uint32_t mappingSize;
+	uint32_t frameNumber;
+	bool isWriter;
+	char name[64];
+#ifdef _WIN32
+	void* mappingHandle;
+#endif
+};
+
+/* Writer (the game) */
+
+bool InitFrameExport(FrameExporter& exporter, const char* name, int width, int height); // returns false if the shared memory could not be created
+void PublishFrame(FrameExporter& exporter, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo);
+void ShutDownFrameExport(FrameExporter& exporter);
+
+/* Reader (external processes) */
+
+bool OpenFrameExport(FrameExporter& reader, const char* name); // returns false if no game is exporting under that name
+const FrameSlotHeader* BeginReadFrame(const FrameExporter& reader, uint32_t& sequence); // newest frame or nullptr if none yet, read it in place then call EndReadFrame
+bool EndReadFrame(const FrameSlotHeader* slot, uint32_t sequence); // true if the frame was not overwritten while it was being read
+const FrameEntity* GetFrameEntities(const FrameExporter& exporter, const FrameSlotHeader* slot);
+const char* GetFrameCells(const FrameExporter& exporter, const FrameSlotHeader* slot);
+
+#endif // FRAMEEXPORT_H_
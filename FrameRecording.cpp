@@ -0,0 +1,415 @@
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FrameRecording.h"
+#include "FrameDelta.h"
+#include "CursesUtils.h"
+#include "TextInvaders.h"
+
+static const char RECORDING_MAGIC[] = "TIRC";
+static const char INDEX_MAGIC[] = "TIDX";
+
+/* Recording */
+
+static void WriteRecord(FrameRecorder& recorder, FrameRecordType type, const char* previous)
+{
+	std::string& record = recorder.record;
+
+	record.clear();
+	record.push_back((char)type);
+	WriteUInt32(record, recorder.frameNumber);
+	WriteUInt32(record, recorder.timeMs);
+	WriteUInt32(record, 0); // payload length, patched below
+
+	EncodeFrameDelta(previous, recorder.cells.data(), recorder.width * recorder.height, record);
+
+	if (type == FRT_DELTA && record.size() == FRAME_RECORDING_RECORD_HEADER_SIZE)
+	{
+		return; // nothing changed since the last frame
+	}
+
+	PatchUInt32(record, 9, (unsigned int)(record.size() - FRAME_RECORDING_RECORD_HEADER_SIZE));
+
+	if (type == FRT_KEYFRAME)
+	{
+		FrameRecordingKeyframe keyframe;
+		keyframe.frameNumber = recorder.frameNumber;
+		keyframe.timeMs = recorder.timeMs;
+		keyframe.fileOffset = recorder.fileOffset;
+		recorder.keyframes.push_back(keyframe);
+	}
+
+	fwrite(record.data(), 1, record.size(), recorder.file);
+	recorder.fileOffset += (unsigned int)record.size();
+}
+
+bool StartFrameRecording(FrameRecorder& recorder, const char* fileName, int width, int height)
+{
+	recorder.file = fopen(fileName, "wb");
+	if (recorder.file == nullptr)
+	{
+		return false;
+	}
+
+	recorder.width = width;
+	recorder.height = height;
+	recorder.frameNumber = 0;
+	recorder.timeMs = 0;
+	recorder.cells.assign(width * height, ' ');
+	recorder.previousCells.assign(width * height, ' ');
+	recorder.blankCells.assign(width * height, ' ');
+	recorder.keyframes.clear();
+
+	std::string header(RECORDING_MAGIC, 4);
+	WriteUInt32(header, FRAME_RECORDING_VERSION);
+	WriteUInt16(header, width);
+	WriteUInt16(header, height);
+	WriteUInt32(header, FRAME_RECORDING_KEYFRAME_INTERVAL);
+
+	fwrite(header.data(), 1, header.size(), recorder.file);
+	recorder.fileOffset = (unsigned int)header.size();
+
+	return true;
+}
+
+void RecordFrame(FrameRecorder& recorder, unsigned int timeMs)
+{
+	if (recorder.file == nullptr)
+	{
+		return;
+	}
+
+	recorder.timeMs = timeMs;
+	ReadScreen(recorder.cells.data(), recorder.width, recorder.height);
+
+	if (recorder.frameNumber % FRAME_RECORDING_KEYFRAME_INTERVAL == 0)
+	{
+		WriteRecord(recorder, FRT_KEYFRAME, recorder.blankCells.data());
+	}
+	else
+	{
+		WriteRecord(recorder, FRT_DELTA, recorder.previousCells.data());
+	}
+
+	recorder.previousCells.swap(recorder.cells);
+	recorder.frameNumber++;
+}
+
+void StopFrameRecording(FrameRecorder& recorder)
+{
+	if (recorder.file == nullptr)
+	{
+		return;
+	}
+
+	std::string index;
+
+	for (size_t i = 0; i < recorder.keyframes.size(); i++)
+	{
+		WriteUInt32(index, recorder.keyframes[i].frameNumber);
+		WriteUInt32(index, recorder.keyframes[i].timeMs);
+		WriteUInt32(index, recorder.keyframes[i].fileOffset);
+	}
+
+	WriteUInt32(index, recorder.fileOffset);
+	WriteUInt32(index, (unsigned int)recorder.keyframes.size());
+	WriteUInt32(index, recorder.frameNumber);
+	WriteUInt32(index, recorder.timeMs);
+	index.append(INDEX_MAGIC, 4);
+
+	fwrite(index.data(), 1, index.size(), recorder.file);
+	fclose(recorder.file);
+	recorder.file = nullptr;
+}
+
+/* Playback */
+
+static const unsigned char* MapFile(const char* fileName, size_t& size, void*& mappingHandle)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	CloseHandle(file); // the mapping keeps the file open
+
+	if (mapping == NULL)
+	{
+		return nullptr;
+	}
+
+	const unsigned char* data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle(mapping);
+		return nullptr;
+	}
+
+	size = (size_t)fileSize.QuadPart;
+	mappingHandle = mapping;
+	return data;
+#else
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+	{
+		return nullptr;
+	}
+
+	struct stat info;
+	void* data = MAP_FAILED;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	madvise(data, info.st_size, MADV_SEQUENTIAL); // playback mostly streams forward
+	size = (size_t)info.st_size;
+	mappingHandle = nullptr;
+	return (const unsigned char*)data;
+#endif
+}
+
+static void UnmapFile(FramePlayback& playback)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(playback.data);
+	CloseHandle((HANDLE)playback.mappingHandle);
+#else
+	munmap((void*)playback.data, playback.size);
+#endif
+	playback.data = nullptr;
+}
+
+bool OpenFramePlayback(FramePlayback& playback, const char* fileName)
+{
+	playback.data = MapFile(fileName, playback.size, playback.mappingHandle);
+	if (playback.data == nullptr)
+	{
+		return false;
+	}
+
+	const unsigned char* data = playback.data;
+	size_t size = playback.size;
+
+	bool valid = size >= FRAME_RECORDING_HEADER_SIZE + FRAME_RECORDING_FOOTER_SIZE &&
+		memcmp(data, RECORDING_MAGIC, 4) == 0 &&
+		ReadUInt32(data + 4) == FRAME_RECORDING_VERSION &&
+		memcmp(data + size - 4, INDEX_MAGIC, 4) == 0; // no footer means the game did not shut down cleanly
+
+	if (valid)
+	{
+		const unsigned char* footer = data + size - FRAME_RECORDING_FOOTER_SIZE;
+		unsigned int indexOffset = ReadUInt32(footer);
+		unsigned int numKeyframes = ReadUInt32(footer + 4);
+
+		playback.numFrames = ReadUInt32(footer + 8);
+		playback.durationMs = ReadUInt32(footer + 12);
+		playback.width = ReadUInt16(data + 8);
+		playback.height = ReadUInt16(data + 10);
+		playback.recordsEnd = indexOffset;
+
+		valid = numKeyframes > 0 && indexOffset + (size_t)numKeyframes * FRAME_RECORDING_INDEX_ENTRY_SIZE + FRAME_RECORDING_FOOTER_SIZE == size;
+
+		playback.keyframes.clear();
+		for (unsigned int i = 0; valid && i < numKeyframes; i++)
+		{
+			const unsigned char* entry = data + indexOffset + i * FRAME_RECORDING_INDEX_ENTRY_SIZE;
+
+			FrameRecordingKeyframe keyframe;
+			keyframe.frameNumber = ReadUInt32(entry);
+			keyframe.timeMs = ReadUInt32(entry + 4);
+			keyframe.fileOffset = ReadUInt32(entry + 8);
+			playback.keyframes.push_back(keyframe);
+
+			valid = keyframe.fileOffset < indexOffset;
+		}
+	}
+
+	if (!valid)
+	{
+		UnmapFile(playback);
+		return false;
+	}
+
+	playback.corrupt = false;
+	SeekFramePlayback(playback, 0);
+	return true;
+}
+
+static bool KeyframeTimeCompare(unsigned int timeMs, const FrameRecordingKeyframe& keyframe)
+{
+	return timeMs < keyframe.timeMs;
+}
+
+void SeekFramePlayback(FramePlayback& playback, unsigned int timeMs)
+{
+	std::vector<FrameRecordingKeyframe>::const_iterator next = std::upper_bound(playback.keyframes.begin(), playback.keyframes.end(), timeMs, KeyframeTimeCompare);
+
+	if (next != playback.keyframes.begin())
+	{
+		next--;
+	}
+
+	playback.cells.assign(playback.width * playback.height, ' ');
+	playback.nextRecordOffset = next->fileOffset;
+	playback.timeMs = next->timeMs;
+
+	AdvanceFramePlayback(playback, std::max(timeMs, next->timeMs));
+}
+
+bool AdvanceFramePlayback(FramePlayback& playback, unsigned int timeMs)
+{
+	bool changed = false;
+
+	while (!playback.corrupt && playback.nextRecordOffset + FRAME_RECORDING_RECORD_HEADER_SIZE <= playback.recordsEnd)
+	{
+		const unsigned char* record = playback.data + playback.nextRecordOffset;
+		unsigned int recordTimeMs = ReadUInt32(record + 5);
+		unsigned int payloadLength = ReadUInt32(record + 9);
+
+		if (recordTimeMs > timeMs)
+		{
+			break;
+		}
+
+		if (playback.nextRecordOffset + FRAME_RECORDING_RECORD_HEADER_SIZE + payloadLength > playback.recordsEnd)
+		{
+			playback.corrupt = true; // runs into the index
+			break;
+		}
+
+		if (record[0] == FRT_KEYFRAME)
+		{
+			std::fill(playback.cells.begin(), playback.cells.end(), ' ');
+		}
+
+		if (!ApplyFrameDelta(record + FRAME_RECORDING_RECORD_HEADER_SIZE, payloadLength, playback.cells.data(), playback.width * playback.height))
+		{
+			playback.corrupt = true;
+			break;
+		}
+
+		playback.timeMs = recordTimeMs;
+		playback.nextRecordOffset += FRAME_RECORDING_RECORD_HEADER_SIZE + payloadLength;
+		changed = true;
+	}
+
+	return changed;
+}
+
+void CloseFramePlayback(FramePlayback& playback)
+{
+	if (playback.data != nullptr)
+	{
+		UnmapFile(playback);
+	}
+}
+
+int RunFramePlayback(const char* fileName)
+{
+	const unsigned int SEEK_AMOUNT_MS = 5000;
+
+	FramePlayback playback;
+	if (!OpenFramePlayback(playback, fileName))
+	{
+		fprintf(stderr, "Could not open recording %s\n", fileName);
+		return 1;
+	}
+
+	InitializeCurses(true);
+
+	unsigned int playTimeMs = 0;
+	bool paused = false;
+	bool redraw = true;
+	bool quit = false;
+	clock_t lastTime = clock();
+
+	while (!quit)
+	{
+		switch (GetChar())
+		{
+		case 'q':
+			quit = true;
+			break;
+		case ' ':
+			paused = !paused;
+			break;
+		case AK_LEFT:
+			playTimeMs = playTimeMs > SEEK_AMOUNT_MS ? playTimeMs - SEEK_AMOUNT_MS : 0;
+			SeekFramePlayback(playback, playTimeMs);
+			redraw = true;
+			break;
+		case AK_RIGHT:
+			playTimeMs = std::min(playTimeMs + SEEK_AMOUNT_MS, playback.durationMs);
+			SeekFramePlayback(playback, playTimeMs);
+			redraw = true;
+			break;
+		}
+
+		clock_t currentTime = clock();
+		clock_t dt = currentTime - lastTime;
+
+		if (dt > CLOCKS_PER_SEC / FPS)
+		{
+			lastTime = currentTime;
+
+			if (!paused && playTimeMs < playback.durationMs)
+			{
+				playTimeMs = std::min(playTimeMs + (unsigned int)(dt * 1000 / CLOCKS_PER_SEC), playback.durationMs);
+				redraw = AdvanceFramePlayback(playback, playTimeMs) || redraw;
+			}
+
+			if (playback.corrupt)
+			{
+				quit = true; // not a frame worth showing
+			}
+			else if (redraw)
+			{
+				ClearScreen();
+				DrawCells(playback.cells.data(), playback.width, playback.height);
+				RefreshScreen();
+				redraw = false;
+			}
+		}
+	}
+
+	ShutDownCurses();
+
+	if (playback.corrupt)
+	{
+		fprintf(stderr, "Recording %s is damaged at %u ms, playback stopped\n", fileName, playback.timeMs);
+		CloseFramePlayback(playback);
+		return 1;
+	}
+
+	CloseFramePlayback(playback);
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#ifndef FRAMERECORDING_H_
+#define FRAMERECORDING_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+Frame Recording:
+
+Records exactly what the player saw (TextInvaders --record file) so a game can be watched back later
+(TextInvaders --play file) without re-simulating it.
+
+File layout (all integers little endian):
+
+header - "TIRC", uint32 version, uint16 width, uint16 height, uint32 keyframeInterval
+records - uint8 type, uint32 frameNumber, uint32 timeMs, uint32 payloadLength, payload
+index - one entry per keyframe: uint32 frameNumber, uint32 timeMs, uint32 fileOffset of the record
+footer - uint32 indexOffset, uint32 numKeyframes, uint32 numFrames, uint32 durationMs, "TIDX"
+
+Payloads are FrameDelta runs - keyframes against a blank grid, every other frame against the frame before it. Frames
+where nothing changed are not written at all. A keyframe goes out every keyframeInterval frames, so seeking is a binary
+search of the index and then at most keyframeInterval deltas.
+*/
+
+enum
+{
+	FRAME_RECORDING_VERSION = 1,
+	FRAME_RECORDING_KEYFRAME_INTERVAL = 100, // 5 seconds at FPS
+	FRAME_RECORDING_HEADER_SIZE = 16,
+	FRAME_RECORDING_RECORD_HEADER_SIZE = 13,
+	FRAME_RECORDING_INDEX_ENTRY_SIZE = 12,
+	FRAME_RECORDING_FOOTER_SIZE = 20,
+};
+
+enum FrameRecordType
+{
+	FRT_KEYFRAME = 1,
+	FRT_DELTA
+};
+
+struct FrameRecordingKeyframe
+{
+	unsigned int frameNumber;
+	unsigned int timeMs;
+	unsigned int fileOffset;
+};
+
+struct FrameRecorder
+{
+	FILE* file;
+	int width;
+	int height;
+	unsigned int frameNumber;
+	unsigned int fileOffset;
+	unsigned int timeMs;
+	std::vector<char> cells;
+	std::vector<char> previousCells;
+	std::vector<char> blankCells;
+	std::vector<FrameRecordingKeyframe> keyframes;
+	std::string record;
+};
+
+struct FramePlayback
+{
+	const unsigned char* data;
+	size_t size;
+	int width;
+	int height;
+	unsigned int durationMs;
+	unsigned int numFrames;
+	std::vector<FrameRecordingKeyframe> keyframes;
+	std::vector<char> cells;
+	size_t nextRecordOffset; // where streaming picks up
+	size_t recordsEnd;
+	unsigned int timeMs; // time of the frame in cells
+	bool corrupt; // a record did not decode - cells are not a real frame and playback goes no further
+	void* mappingHandle;
+};
+
+/* Recording */
+
+bool StartFrameRecording(FrameRecorder& recorder, const char* fileName, int width, int height); // returns false if the file could not be created
+void RecordFrame(FrameRecorder& recorder, unsigned int timeMs); // call once the frame is drawn
+void StopFrameRecording(FrameRecorder& recorder); // writes the index and closes the file
+
+/* Playback */
+
+bool OpenFramePlayback(FramePlayback& playback, const char* fileName); // returns false if the file is missing or not a finished recording
+void SeekFramePlayback(FramePlayback& playback, unsigned int timeMs); // cells become the last frame at or before timeMs
+bool AdvanceFramePlayback(FramePlayback& playback, unsigned int timeMs); // streams forward to timeMs, returns true if cells changed - stops at a record that does not decode and sets corrupt
+void CloseFramePlayback(FramePlayback& playback);
+
+int RunFramePlayback(const char* fileName); // watch a recording - left/right seek, space pauses, q quits
+
+#endif // FRAMERECORDING_H_
@@ -0,0 +1,58 @@
+
+#include "GameRandom.h"
+
+static void StepGameRandom(GameRandom& random)
+{
+	random.front = random.front + 1 < GAME_RANDOM_DEGREE ? random.front + 1 : 0;
+	random.rear = random.rear + 1 < GAME_RANDOM_DEGREE ? random.rear + 1 : 0;
+}
+
+void SeedGameRandom(GameRandom& random, unsigned int seed)
+{
+	int32_t word = seed != 0 ? (int32_t)seed : 1;
+	random.state[0] = (uint32_t)word;
+
+	for (int i = 1; i < GAME_RANDOM_DEGREE; i++)
+	{
+		// 16807 * word % 2147483647 without overflowing
+		int32_t high = word / 127773;
+		int32_t low = word % 127773;
+		word = 16807 * low - 2836 * high;
+
+		if (word < 0)
+		{
+			word += 2147483647;
+		}
+
+		random.state[i] = (uint32_t)word;
+	}
+
+	random.front = GAME_RANDOM_SEPARATION;
+	random.rear = 0;
+
+	for (int i = 0; i < GAME_RANDOM_DEGREE * 10; i++)
+	{
+		DrawGameRandom(random);
+	}
+}
+
+int DrawGameRandom(GameRandom& random)
+{
+	uint32_t value = random.state[random.front] += random.state[random.rear];
+	StepGameRandom(random);
+
+	return (int)(value >> 1); // the lowest bit is the least random
+}
+
+int SkipGameRandomUntil(GameRandom& random, int divisor, int remainder, int maxDraws)
+{
+	int numDraws = 0;
+
+	while (numDraws < maxDraws && (int)((random.state[random.front] + random.state[random.rear]) >> 1) % divisor != remainder)
+	{
+		DrawGameRandom(random);
+		numDraws++;
+	}
+
+	return numDraws;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef GAMERANDOM_H_
+#define GAMERANDOM_H_
+
+#include <cstdint>
+
+/*
+Game Random:
+
+The game's own random numbers, kept in the Game instead of behind rand(), so they are saved and restored with the rest
+of it (GameSnapshot), every game has its own, and the numbers still to come can be looked at without drawing them.
+
+It is the additive generator glibc's rand() uses, seeded the same way, so a game seeded with s draws what rand() did
+after srand(s) on Linux - on every platform.
+*/
+
+enum
+{
+	GAME_RANDOM_DEGREE = 31,
+	GAME_RANDOM_SEPARATION = 3,
+	GAME_RANDOM_MAX = 0x7fffffff,
+};
+
+struct GameRandom
+{
+	uint32_t state[GAME_RANDOM_DEGREE];
+	int front; // the word the next number is added into
+	int rear;
+};
+
+void SeedGameRandom(GameRandom& random, unsigned int seed);
+int DrawGameRandom(GameRandom& random); // 0 to GAME_RANDOM_MAX
+int SkipGameRandomUntil(GameRandom& random, int divisor, int remainder, int maxDraws); // draws until the next number would be remainder modulo divisor, at most maxDraws - returns how many it drew
+
+#endif // GAMERANDOM_H_
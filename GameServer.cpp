@@ -0,0 +1,938 @@
+
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <cstdlib>
+#include <new>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "GameServer.h"
+#include "SpectatorBroadcast.h"
+#include "FrameDelta.h"
+#include "CursesUtils.h"
+#include "ScoreService.h"
+
+#ifndef _WIN32
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL; // a player closing their terminal should not take the server down with SIGPIPE
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+static volatile sig_atomic_t stopServer = 0;
+
+static void StopServer(int)
+{
+	stopServer = 1;
+}
+
+static bool SetNonBlocking(int socket)
+{
+	int flags = fcntl(socket, F_GETFL, 0);
+	return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/* Sessions */
+
+static void WatchSession(GameServer& server, ServerSession& session, bool write)
+{
+	epoll_event event;
+	event.events = (uint32_t)EPOLLIN | (write ? (uint32_t)EPOLLOUT : 0u);
+	event.data.ptr = &session;
+
+	epoll_ctl(server.epollHandle, EPOLL_CTL_MOD, session.socket, &event);
+	session.waitingToWrite = write;
+}
+
+static void FlushSession(GameServer& server, ServerSession& session)
+{
+	while (session.sentBytes < session.outgoing.size())
+	{
+		ssize_t numSent = send(session.socket, session.outgoing.data() + session.sentBytes, session.outgoing.size() - session.sentBytes, SEND_FLAGS);
+
+		if (numSent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				if (!session.waitingToWrite)
+				{
+					WatchSession(server, session, true); // the rest goes when the socket has room
+				}
+			}
+			else
+			{
+				session.closing = true;
+			}
+			return;
+		}
+
+		session.sentBytes += numSent;
+	}
+
+	session.outgoing.clear();
+	session.sentBytes = 0;
+
+	if (session.waitingToWrite)
+	{
+		WatchSession(server, session, false);
+	}
+}
+
+static void ScheduleSession(GameServer& server, ServerSession& session) // into the emptiest tick slot
+{
+	int slot = 0;
+
+	for (int i = 1; i < SERVER_TICK_SLOTS; i++)
+	{
+		if (server.tickSlots[i].size() < server.tickSlots[slot].size())
+		{
+			slot = i;
+		}
+	}
+
+	server.tickSlots[slot].push_back(&session);
+	session.tickSlot = slot;
+	server.numPlaying++;
+}
+
+static void ParkSession(GameServer& server, ServerSession& session)
+{
+	std::vector<ServerSession*>& slot = server.tickSlots[session.tickSlot];
+
+	for (size_t i = 0; i < slot.size(); i++)
+	{
+		if (slot[i] == &session)
+		{
+			slot[i] = slot.back();
+			slot.pop_back();
+			break;
+		}
+	}
+
+	session.tickSlot = -1;
+	server.numPlaying--;
+}
+
+static void AddSession(GameServer& server, int socket)
+{
+	if (server.freeSessions.empty() || !SetNonBlocking(socket))
+	{
+		close(socket);
+		server.load->numClosed.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	ServerSession* session = server.freeSessions.back();
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = session;
+
+	if (epoll_ctl(server.epollHandle, EPOLL_CTL_ADD, socket, &event) != 0)
+	{
+		close(socket);
+		server.load->numClosed.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	server.freeSessions.pop_back();
+
+	// a session from the pool keeps the capacity of its strings and vectors from last time
+	session->socket = socket;
+	session->joined = false;
+	session->bot = false;
+	session->closing = false;
+	session->tickSlot = -1;
+	session->hello.clear();
+	session->frameNumber = 0;
+	session->outgoing.clear();
+	session->sentBytes = 0;
+	session->needsKeyframe = true;
+	session->waitingToWrite = false;
+	InitRawInput(session->keys, false);
+
+	server.sessions.push_back(session);
+}
+
+static void ReceiveSessions(GameServer& server) // the sockets the first process has handed over
+{
+	for (;;)
+	{
+		char byte;
+		iovec data;
+		data.iov_base = &byte;
+		data.iov_len = 1;
+
+		char control[CMSG_SPACE(sizeof(int))];
+		msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = &data;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		ssize_t numRead = recvmsg(server.handoffSocket, &message, 0);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			stopServer = 1; // the first process has gone
+			return;
+		}
+
+		if (numRead < 0)
+		{
+			return;
+		}
+
+		cmsghdr* header = CMSG_FIRSTHDR(&message);
+
+		if (header != nullptr && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+		{
+			int socket;
+			memcpy(&socket, CMSG_DATA(header), sizeof(socket));
+			AddSession(server, socket);
+		}
+	}
+}
+
+static void JoinSession(GameServer& server, ServerSession& session)
+{
+	const unsigned char* hello = (const unsigned char*)session.hello.data();
+
+	session.width = (int)ReadUInt16(hello);
+	session.height = (int)ReadUInt16(hello + 2);
+	session.bot = (session.width & SERVER_HELLO_BOT) != 0;
+	session.width &= ~SERVER_HELLO_BOT;
+	session.width = session.width < SERVER_MAX_WIDTH ? session.width : SERVER_MAX_WIDTH;
+	session.height = session.height < SERVER_MAX_HEIGHT ? session.height : SERVER_MAX_HEIGHT;
+
+	session.cells.assign(session.width * session.height, ' ');
+	session.previousCells.assign(session.width * session.height, ' ');
+
+	StartServerGame(session.state, session.width, session.height, (unsigned int)rand());
+	session.joined = true;
+
+	ScheduleSession(server, session); // for its first frame
+}
+
+static void ReadSession(GameServer& server, ServerSession& session)
+{
+	unsigned char bytes[SERVER_READ_SIZE];
+
+	for (;;)
+	{
+		ssize_t numRead = recv(session.socket, bytes, sizeof(bytes), 0);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			session.closing = true; // hung up
+			return;
+		}
+
+		if (numRead < 0)
+		{
+			return; // everything that has arrived has been read
+		}
+
+		long long microseconds = InputClockMicroseconds();
+		int first = 0;
+
+		if (!session.joined)
+		{
+			while (first < numRead && session.hello.size() < SERVER_HELLO_SIZE)
+			{
+				session.hello.push_back((char)bytes[first++]);
+			}
+
+			if (session.hello.size() < SERVER_HELLO_SIZE)
+			{
+				continue;
+			}
+
+			JoinSession(server, session);
+		}
+
+		DecodeInputBytes(session.keys, bytes + first, (int)numRead - first, microseconds);
+
+		InputEvent event;
+
+		while (TakeInputEvent(session.keys, event))
+		{
+			if (HandleServerInput(event, session.state, session.bot ? server.botTable : *server.table) == 'q')
+			{
+				session.closing = true;
+				return;
+			}
+
+			server.botTable.scores.clear(); // a bot's score, if that key ended its name entry
+
+			if (session.tickSlot < 0)
+			{
+				ScheduleSession(server, session); // a key on a parked screen - it changes or starts the game
+			}
+		}
+	}
+}
+
+static bool DrawSession(GameServer& server, ServerSession& session) // returns false if the frame was dropped
+{
+	if (session.sentBytes < session.outgoing.size())
+	{
+		session.needsKeyframe = true; // still sending an earlier frame - skip this one, it catches up on a keyframe
+		server.numDroppedFrames++;
+		return false;
+	}
+
+	ClearScreenArea(session.width, session.height);
+	DrawServerGame(session.state, *server.table);
+	ReadScreen(session.cells.data(), session.width, session.height);
+
+	session.frameNumber++;
+	server.numFrames++;
+
+	if (session.needsKeyframe)
+	{
+		BuildFrameMessage(session.outgoing, SMT_KEYFRAME, session.width, session.height, session.frameNumber, server.blankCells.data(), session.cells.data());
+		session.needsKeyframe = false;
+	}
+	else
+	{
+		BuildFrameMessage(session.outgoing, SMT_DELTA, session.width, session.height, session.frameNumber, session.previousCells.data(), session.cells.data());
+
+		if (session.outgoing.size() == SPECTATOR_MESSAGE_HEADER_SIZE)
+		{
+			session.outgoing.clear(); // nothing changed, nothing to send
+		}
+	}
+
+	session.previousCells.swap(session.cells);
+	FlushSession(server, session);
+
+	return true;
+}
+
+static void TickSlot(GameServer& server, int slotIndex)
+{
+	std::vector<ServerSession*>& slot = server.tickSlots[slotIndex];
+
+	for (size_t i = 0; i < slot.size(); )
+	{
+		ServerSession& session = *slot[i];
+
+		UpdateServerGame(session.state);
+		server.numTicks++;
+
+		GameState state = session.state.game.currentState;
+
+		if (DrawSession(server, session) && (state == GS_INTRO || state == GS_HIGH_SCORE))
+		{
+			ParkSession(server, session); // its screen is out and will not change until a key - moves the last one in the slot to i
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+static void RemoveClosedSessions(GameServer& server)
+{
+	for (size_t i = 0; i < server.sessions.size(); )
+	{
+		ServerSession* session = server.sessions[i];
+
+		if (session->closing)
+		{
+			if (session->tickSlot >= 0)
+			{
+				ParkSession(server, *session);
+			}
+
+			close(session->socket); // takes it out of the epoll set as well
+			server.freeSessions.push_back(session);
+			server.sessions[i] = server.sessions.back();
+			server.sessions.pop_back();
+			server.load->numClosed.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+/* Shards */
+
+static bool InitShard(GameServer& server, int shard, int capacity, int handoffSocket, ShardLoad* load, HighScoreTable& table)
+{
+	server.shard = shard;
+	server.handoffSocket = handoffSocket;
+	server.load = load;
+	server.table = &table;
+	server.botTable.fileName = nullptr;
+	server.botTable.service = nullptr;
+	server.numPlaying = 0;
+	server.numFrames = 0;
+	server.numDroppedFrames = 0;
+	server.numTicks = 0;
+	server.blankCells.assign(SERVER_MAX_WIDTH * SERVER_MAX_HEIGHT, ' ');
+
+	server.sessionPool.resize(capacity);
+	server.freeSessions.clear();
+	for (int i = capacity - 1; i >= 0; i--)
+	{
+		server.freeSessions.push_back(&server.sessionPool[i]);
+	}
+
+	server.sessions.clear();
+	server.sessions.reserve(capacity);
+	for (int i = 0; i < SERVER_TICK_SLOTS; i++)
+	{
+		server.tickSlots[i].clear();
+		server.tickSlots[i].reserve(capacity);
+	}
+
+	server.epollHandle = epoll_create1(0);
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = nullptr; // the handoff socket - sessions have their ServerSession
+
+	return server.epollHandle >= 0 && SetNonBlocking(handoffSocket) &&
+		epoll_ctl(server.epollHandle, EPOLL_CTL_ADD, handoffSocket, &event) == 0;
+}
+
+static void ShutDownShard(GameServer& server)
+{
+	for (size_t i = 0; i < server.sessions.size(); i++)
+	{
+		close(server.sessions[i]->socket);
+	}
+	server.sessions.clear();
+
+	if (server.epollHandle >= 0)
+	{
+		close(server.epollHandle);
+		server.epollHandle = -1;
+	}
+
+	close(server.handoffSocket);
+}
+
+static void PinToCPU(int cpu)
+{
+#ifdef __linux__
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	sched_setaffinity(0, sizeof(cpus), &cpus); // only a hint for the scheduler - the shard runs anywhere if it fails
+#endif
+}
+
+static int RunShard(int shard, int capacity, int handoffSocket, ShardLoad* load, HighScoreTable& table)
+{
+	GameServer server;
+
+	if (!InitShard(server, shard, capacity, handoffSocket, load, table) || !InitializeOffscreenCurses(SERVER_MAX_WIDTH, SERVER_MAX_HEIGHT))
+	{
+		fprintf(stderr, "Shard %i could not start\n", shard);
+		ShutDownShard(server);
+		return 1;
+	}
+
+	const long long slotMicroseconds = 1000000 / FPS / SERVER_TICK_SLOTS;
+	long long nextSlotTime = InputClockMicroseconds() + slotMicroseconds;
+	int nextSlot = 0;
+	epoll_event events[SERVER_MAX_EPOLL_EVENTS];
+
+	while (!stopServer)
+	{
+		bool idle = server.numPlaying == 0; // nothing to tick - sleep until a socket wakes the shard
+		long long now = InputClockMicroseconds();
+		int timeout = idle ? -1 : (nextSlotTime > now ? (int)((nextSlotTime - now + 999) / 1000) : 0);
+
+		int numEvents = epoll_wait(server.epollHandle, events, SERVER_MAX_EPOLL_EVENTS, timeout);
+
+		for (int i = 0; i < numEvents; i++)
+		{
+			ServerSession* session = (ServerSession*)events[i].data.ptr;
+
+			if (session == nullptr)
+			{
+				ReceiveSessions(server);
+				continue;
+			}
+
+			if (!session->closing && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+			{
+				ReadSession(server, *session);
+			}
+
+			if (!session->closing && (events[i].events & EPOLLOUT))
+			{
+				FlushSession(server, *session);
+			}
+		}
+
+		RemoveClosedSessions(server);
+
+		now = InputClockMicroseconds();
+
+		if (idle)
+		{
+			nextSlotTime = now + slotMicroseconds; // not the slots that went by while it slept
+		}
+
+		for (int lagSlots = 0; now >= nextSlotTime && lagSlots < SERVER_MAX_LAG_TICKS * SERVER_TICK_SLOTS; lagSlots++)
+		{
+			TickSlot(server, nextSlot);
+
+			nextSlot = (nextSlot + 1) % SERVER_TICK_SLOTS;
+			nextSlotTime += slotMicroseconds;
+		}
+
+		if (now >= nextSlotTime)
+		{
+			nextSlotTime = now + slotMicroseconds; // too far behind to catch up
+		}
+
+		RemoveClosedSessions(server);
+		load->numPlaying.store(server.numPlaying, std::memory_order_relaxed);
+
+		if (server.table->service != nullptr)
+		{
+			UpdateScoreClient(*server.table->service, server.table->scores); // this pass's scores in one batch - a reply waits for the next pass
+		}
+	}
+
+	if (server.table->service != nullptr)
+	{
+		ShutDownScoreClient(*server.table->service);
+	}
+
+	printf("Shard %i: ticked %u games, sent %u frames, dropped %u for slow players\n", shard, server.numTicks, server.numFrames, server.numDroppedFrames);
+	fflush(stdout);
+
+	ShutDownCurses();
+	ShutDownShard(server);
+
+	return 0;
+}
+
+/* Server */
+
+enum HandOffResult
+{
+	HOR_SENT,
+	HOR_BUSY, // its queue is full - it is behind, or hung
+	HOR_GONE // its end has closed
+};
+
+static HandOffResult HandOffSession(int handoffSocket, int socket)
+{
+	char byte = 0;
+	iovec data;
+	data.iov_base = &byte;
+	data.iov_len = 1;
+
+	char control[CMSG_SPACE(sizeof(int))];
+	memset(control, 0, sizeof(control));
+
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	cmsghdr* header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(header), &socket, sizeof(socket));
+
+	ssize_t numSent;
+	do
+	{
+		numSent = sendmsg(handoffSocket, &message, SEND_FLAGS | MSG_DONTWAIT); // a shard that is not reading must not hold up the others
+	} while (numSent < 0 && errno == EINTR);
+
+	if (numSent == 1)
+	{
+		return HOR_SENT;
+	}
+
+	return (numSent < 0 && (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN)) ? HOR_GONE : HOR_BUSY;
+}
+
+static void DropShard(int shard, int* handoffSockets, const char* reason)
+{
+	printf("Shard %i %s, no more players go to it\n", shard, reason);
+	fflush(stdout);
+
+	close(handoffSockets[shard]);
+	handoffSockets[shard] = -1;
+}
+
+static int FindLeastLoadedShard(const int* handoffSockets, const int* numHandedOff, ShardLoad* loads, int numShards, int capacity, const bool* tried)
+{
+	int bestShard = -1;
+	int bestLoad = 0;
+
+	for (int shard = 0; shard < numShards; shard++)
+	{
+		if (handoffSockets[shard] < 0 || tried[shard])
+		{
+			continue;
+		}
+
+		int numSessions = numHandedOff[shard] - loads[shard].numClosed.load(std::memory_order_relaxed);
+		int load = numSessions + loads[shard].numPlaying.load(std::memory_order_relaxed);
+
+		if (numSessions < capacity && (bestShard < 0 || load < bestLoad))
+		{
+			bestShard = shard;
+			bestLoad = load;
+		}
+	}
+
+	return bestShard;
+}
+
+int RunGameServer(const char* path, int maxSessions, int numShards, HighScoreTable& table)
+{
+	int numCPUs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	numCPUs = numCPUs > 0 ? numCPUs : 1;
+
+	numShards = numShards > 0 ? numShards : numCPUs;
+	numShards = numShards < SERVER_MAX_SHARDS ? numShards : SERVER_MAX_SHARDS;
+	numShards = numShards < maxSessions ? numShards : (maxSessions > 0 ? maxSessions : 1);
+
+	int capacity = (maxSessions + numShards - 1) / numShards; // sessions per shard
+
+	int listenSocket = ListenOnGameSocket(path);
+
+	if (listenSocket < 0)
+	{
+		return 1;
+	}
+
+	void* sharedMemory = mmap(nullptr, sizeof(ShardLoad) * numShards, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if (sharedMemory == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not share the shard loads\n");
+		close(listenSocket);
+		unlink(path);
+		return 1;
+	}
+
+	ShardLoad* loads = (ShardLoad*)sharedMemory;
+	int handoffSockets[SERVER_MAX_SHARDS];
+	pid_t shardProcesses[SERVER_MAX_SHARDS];
+	int numStarted = 0;
+
+	signal(SIGINT, StopServer);
+	signal(SIGTERM, StopServer);
+
+	unsigned int seed = (unsigned int)rand();
+
+	for (int shard = 0; shard < numShards; shard++)
+	{
+		new (&loads[shard]) ShardLoad();
+		loads[shard].numClosed.store(0);
+		loads[shard].numPlaying.store(0);
+
+		int sockets[2];
+
+		if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0)
+		{
+			break;
+		}
+
+		fflush(stdout);
+		pid_t process = fork();
+
+		if (process == 0)
+		{
+			close(listenSocket);
+			close(sockets[0]);
+			for (int i = 0; i < numStarted; i++)
+			{
+				close(handoffSockets[i]);
+			}
+
+			srand(seed + shard); // not the same games on every shard
+			PinToCPU(shard % numCPUs);
+			_exit(RunShard(shard, capacity, sockets[1], &loads[shard], table));
+		}
+
+		close(sockets[1]);
+
+		if (process < 0)
+		{
+			close(sockets[0]);
+			break;
+		}
+
+		handoffSockets[numStarted] = sockets[0];
+		shardProcesses[numStarted] = process;
+		numStarted++;
+	}
+
+	if (numStarted == 0)
+	{
+		fprintf(stderr, "Could not start any shards\n");
+		stopServer = 1;
+	}
+	else
+	{
+		printf("Serving up to %i players on %s with %i shards\n", capacity * numStarted, path, numStarted);
+		fflush(stdout);
+	}
+
+	int numHandedOff[SERVER_MAX_SHARDS] = {}; // sessions given to each shard - less the ones it has closed, that is its sessions
+	int numRunning = numStarted;
+
+	while (!stopServer && numRunning > 0)
+	{
+		for (int shard = 0; shard < numStarted; shard++)
+		{
+			if (shardProcesses[shard] > 0 && waitpid(shardProcesses[shard], nullptr, WNOHANG) == shardProcesses[shard])
+			{
+				shardProcesses[shard] = -1; // its load stopped changing when it died, it would look the least loaded forever
+
+				if (handoffSockets[shard] >= 0)
+				{
+					DropShard(shard, handoffSockets, "has stopped");
+					numRunning--;
+				}
+			}
+		}
+
+		pollfd pollInfo;
+		pollInfo.fd = listenSocket;
+		pollInfo.events = POLLIN;
+		pollInfo.revents = 0;
+
+		if (poll(&pollInfo, 1, 1000) <= 0)
+		{
+			continue;
+		}
+
+		int socket;
+
+		while ((socket = accept(listenSocket, nullptr, nullptr)) >= 0)
+		{
+			bool tried[SERVER_MAX_SHARDS] = {};
+			int shard;
+
+			while ((shard = FindLeastLoadedShard(handoffSockets, numHandedOff, loads, numStarted, capacity, tried)) >= 0)
+			{
+				HandOffResult result = HandOffSession(handoffSockets[shard], socket);
+
+				if (result == HOR_SENT)
+				{
+					numHandedOff[shard]++;
+					break;
+				}
+
+				if (result == HOR_GONE)
+				{
+					DropShard(shard, handoffSockets, "has gone");
+					numRunning--;
+				}
+
+				tried[shard] = true; // the next best, before giving up on the player
+			}
+
+			close(socket); // the shard has its own copy now, or they were all full
+		}
+	}
+
+	if (numStarted > 0 && numRunning == 0)
+	{
+		fprintf(stderr, "Every shard has stopped\n");
+	}
+
+	for (int shard = 0; shard < numStarted; shard++)
+	{
+		if (handoffSockets[shard] >= 0)
+		{
+			close(handoffSockets[shard]); // the shard stops when its handoff socket closes, or on the signal if it had one
+		}
+
+		if (shardProcesses[shard] > 0)
+		{
+			kill(shardProcesses[shard], SIGTERM);
+		}
+	}
+
+	for (int shard = 0; shard < numStarted; shard++)
+	{
+		if (shardProcesses[shard] > 0)
+		{
+			waitpid(shardProcesses[shard], nullptr, 0);
+		}
+	}
+
+	close(listenSocket);
+	unlink(path);
+	munmap(sharedMemory, sizeof(ShardLoad) * numShards);
+
+	return numRunning > 0 ? 0 : 1;
+}
+
+/* Player */
+
+static void SendBytes(int socketHandle, const char* bytes, size_t numBytes)
+{
+	while (numBytes > 0)
+	{
+		ssize_t numSent = send(socketHandle, bytes, numBytes, SEND_FLAGS);
+
+		if (numSent < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numSent <= 0)
+		{
+			return; // the server has gone - the next read finds out
+		}
+
+		bytes += numSent;
+		numBytes -= numSent;
+	}
+}
+
+int RunServerPlayer(const char* path, bool rawInput)
+{
+	int socketHandle = ConnectToGame(path);
+
+	if (socketHandle < 0)
+	{
+		return 1;
+	}
+
+	InitializeCurses(true);
+
+	RawInput keyboard;
+	InitRawInput(keyboard, rawInput);
+
+	std::string hello;
+	WriteUInt16(hello, ScreenWidth());
+	WriteUInt16(hello, ScreenHeight());
+	SendBytes(socketHandle, hello.data(), hello.size());
+
+	FrameReceiver receiver;
+	InitFrameReceiver(receiver);
+	bool quit = false;
+
+	while (!quit)
+	{
+		pollfd pollInfo[2];
+		pollInfo[0].fd = socketHandle;
+		pollInfo[0].events = POLLIN;
+		pollInfo[0].revents = 0;
+		pollInfo[1].fd = STDIN_FILENO;
+		pollInfo[1].events = POLLIN;
+		pollInfo[1].revents = 0;
+
+		// with raw input a key wakes the poll straight away, GetChar has to be asked every so often
+		poll(pollInfo, keyboard.active ? 2 : 1, keyboard.active ? -1 : 1000 / 60);
+
+		if (keyboard.active)
+		{
+			unsigned char bytes[RAW_INPUT_READ_SIZE];
+			int numRead;
+
+			while ((numRead = ReadTerminalBytes(keyboard, bytes, sizeof(bytes))) > 0)
+			{
+				SendBytes(socketHandle, (const char*)bytes, numRead);
+			}
+		}
+		else
+		{
+			int key;
+
+			while ((key = GetChar()) != ERR)
+			{
+				char bytes[RAW_INPUT_MAX_KEY_BYTES];
+				SendBytes(socketHandle, bytes, EncodeInputKey(key, bytes)); // as the terminal would have typed it
+			}
+		}
+
+		if ((pollInfo[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+		{
+			continue;
+		}
+
+		char buffer[16 * 1024];
+		ssize_t numRead = recv(socketHandle, buffer, sizeof(buffer), 0);
+
+		if (numRead <= 0)
+		{
+			quit = numRead == 0 || (errno != EINTR && errno != EAGAIN);
+			continue;
+		}
+
+		if (ReceiveFrameMessages(receiver, buffer, numRead))
+		{
+			ClearScreen();
+			DrawCells(receiver.cells.data(), receiver.width, receiver.height);
+			RefreshScreen();
+		}
+	}
+
+	ShutDownRawInput(keyboard);
+	ShutDownCurses();
+	close(socketHandle);
+
+	return 0;
+}
+
+#else
+
+int RunGameServer(const char*, int, int, HighScoreTable&)
+{
+	fprintf(stderr, "The game server is not supported on this platform\n");
+	return 1;
+}
+
+int RunServerPlayer(const char*, bool)
+{
+	fprintf(stderr, "Joining a game server is not supported on this platform\n");
+	return 1;
+}
+
+#endif
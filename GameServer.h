@@ -0,0 +1,104 @@
+#pragma once
+#ifndef GAMESERVER_H_
+#define GAMESERVER_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "TextInvaders.h"
+#include "RawInput.h"
+
+/*
+Game Server:
+
+TextInvaders --serve [path] hosts many players, each in their own game, on a Unix domain socket, and TextInvaders
+--join [path] plays on it from any terminal. A player sends uint16 width, uint16 height once (little endian), then the
+bytes typed on its terminal, and gets the Spectator Broadcast messages (SpectatorBroadcast.h) for its own screen. A load
+test bot sets SERVER_HELLO_BOT in its width, and its scores are thrown away.
+
+The games are split between shards (--shards n, one per CPU by default), processes of their own that share nothing -
+curses has one screen per process. The first process only accepts connections and hands each socket to the least
+loaded shard that can take it without waiting, dropping shards that have died. A shard runs its sessions from one epoll
+loop, ticking each in one of SERVER_TICK_SLOTS slots a tick. A session whose player has not taken its last frame is not
+drawn until it has, and one on a screen with nothing moving is parked until a key comes in.
+
+Shards never save the high score file: their scores go to the score service (ScoreService.h), which the server starts
+if none is running. Not available on Windows builds.
+*/
+
+enum
+{
+	SERVER_MAX_SESSIONS = 512, // the default for --max-sessions, across all the shards
+	SERVER_MAX_SHARDS = 64,
+	SERVER_TICK_SLOTS = 10,
+	SERVER_MAX_WIDTH = 256, // the offscreen screen - bigger terminals are played at this size
+	SERVER_MAX_HEIGHT = 96,
+	SERVER_HELLO_SIZE = 4,
+	SERVER_HELLO_BOT = 0x8000, // in the hello's width
+	SERVER_READ_SIZE = 4 * 1024,
+	SERVER_MAX_EPOLL_EVENTS = 256, // per epoll_wait
+	SERVER_MAX_LAG_TICKS = 10, // ticks caught up after a stall - any further behind and the games slow down instead
+};
+
+struct ServerSession
+{
+	int socket;
+	bool joined; // its size has arrived and its game has started
+	bool bot; // SERVER_HELLO_BOT - its scores are not kept
+	bool closing; // 'q', a hang up or an error - removed once the events being handled are done
+	int tickSlot; // -1 while parked
+	std::string hello; // the size, until it has all arrived
+
+	GameWorld state;
+	RawInput keys; // only the decoder, it never reads a terminal
+	int width;
+	int height;
+	unsigned int frameNumber;
+	std::vector<char> cells;
+	std::vector<char> previousCells; // what the player has been sent
+
+	std::string outgoing; // bytes of the last frame not yet accepted by the socket
+	size_t sentBytes;
+	bool needsKeyframe;
+	bool waitingToWrite; // registered for EPOLLOUT
+};
+
+struct ShardLoad // in memory shared by all the server's processes
+{
+	std::atomic<int> numClosed; // sessions the shard has ended since it started
+	std::atomic<int> numPlaying; // sessions in a tick slot right now
+};
+
+struct GameServer // one shard
+{
+	int shard;
+	int handoffSocket; // sessions arrive on it from the first process
+	int epollHandle;
+	ShardLoad* load;
+	HighScoreTable* table;
+	HighScoreTable botTable; // where bots' scores go, in memory and emptied after each
+
+	std::vector<ServerSession> sessionPool; // never resized, epoll holds pointers into it
+	std::vector<ServerSession*> freeSessions;
+	std::vector<ServerSession*> sessions;
+	std::vector<ServerSession*> tickSlots[SERVER_TICK_SLOTS];
+	int numPlaying;
+
+	std::vector<char> blankCells; // for keyframes
+	unsigned int numFrames;
+	unsigned int numDroppedFrames;
+	unsigned int numTicks; // games ticked
+};
+
+int RunGameServer(const char* path, int maxSessions, int numShards, HighScoreTable& table); // serves until SIGINT or SIGTERM - numShards 0 for one per CPU
+int RunServerPlayer(const char* path, bool rawInput); // --join - plays on a server until 'q' is pressed or the server goes away
+
+/* The game side, in TextInvaders.cpp with the rest of the game loop */
+
+void StartServerGame(GameWorld& state, int width, int height, unsigned int seed);
+int HandleServerInput(const InputEvent& event, GameWorld& state, HighScoreTable& table); // returns the key
+void UpdateServerGame(GameWorld& state); // one tick
+void DrawServerGame(GameWorld& state, const HighScoreTable& table);
+
+#endif // GAMESERVER_H_
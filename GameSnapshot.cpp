@@ -0,0 +1,52 @@
+
+#include <cstring>
+
+#include "GameSnapshot.h"
+
+template<class Config>
+void SaveGameSnapshot(GameSnapshotT<Config>& snapshot, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo)
+{
+	memset(&snapshot, 0, sizeof(snapshot));
+
+	snapshot.currentState = game.currentState;
+	snapshot.level = game.level;
+	snapshot.gameTimer = game.gameTimer;
+	snapshot.timers = game.timers;
+	snapshot.subTick = game.subTick;
+	snapshot.random = game.random;
+	snapshot.player = player;
+	snapshot.aliens = aliens;
+	snapshot.ufo = ufo;
+
+	for (int i = 0; i < numberOfShields && i < Config::NUM_SHIELDS; i++)
+	{
+		snapshot.shields[i].position = shields[i].position; // field by field - a Shield has a padding byte after its rows
+		memcpy(snapshot.shields[i].rows, shields[i].rows, sizeof(shields[i].rows));
+	}
+}
+
+template<class Config>
+void LoadGameSnapshot(const GameSnapshotT<Config>& snapshot, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens, AlienUFO& ufo)
+{
+	game.currentState = snapshot.currentState;
+	game.level = snapshot.level;
+	game.gameTimer = snapshot.gameTimer;
+	game.timers = snapshot.timers;
+	game.subTick = snapshot.subTick;
+	game.random = snapshot.random;
+	player = snapshot.player;
+	aliens = snapshot.aliens;
+	ufo = snapshot.ufo;
+
+	for (int i = 0; i < numberOfShields && i < Config::NUM_SHIELDS; i++)
+	{
+		shields[i] = snapshot.shields[i];
+	}
+}
+
+/* The configs in GAME_VARIANTS */
+
+template void SaveGameSnapshot(GameSnapshotT<ClassicConfig>&, const Game&, const Player&, const Shield[], int, const AlienSwarmT<ClassicConfig>&, const AlienUFO&);
+template void LoadGameSnapshot(const GameSnapshotT<ClassicConfig>&, Game&, Player&, Shield[], int, AlienSwarmT<ClassicConfig>&, AlienUFO&);
+template void SaveGameSnapshot(GameSnapshotT<WideConfig>&, const Game&, const Player&, const Shield[], int, const AlienSwarmT<WideConfig>&, const AlienUFO&);
+template void LoadGameSnapshot(const GameSnapshotT<WideConfig>&, Game&, Player&, Shield[], int, AlienSwarmT<WideConfig>&, AlienUFO&);
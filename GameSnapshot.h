@@ -0,0 +1,44 @@
+#pragma once
+#ifndef GAMESNAPSHOT_H_
+#define GAMESNAPSHOT_H_
+
+#include <ctime>
+
+#include "TextInvaders.h"
+
+/*
+Game Snapshot:
+
+Everything needed to put a game back exactly where it was, as one flat block of bytes. The high score table and the name
+entry cursors are not part of the simulation and are left out.
+
+Snapshots are zeroed before they are filled so padding bytes are always the same, which keeps byte-wise deltas between
+two snapshots small.
+
+A snapshot is laid out for one game config (GameSnapshotT<Config>), GameSnapshot is the classic game's. The functions are
+compiled in GameSnapshot.cpp for every config in GAME_VARIANTS.
+*/
+
+template<class Config>
+struct GameSnapshotT
+{
+	GameState currentState;
+	int level;
+	clock_t gameTimer;
+	TimerWheel timers;
+	int subTick; // the tick rate is not part of it - a snapshot only goes back into a game running at the same rate
+	GameRandom random;
+	Player player;
+	AlienSwarmT<Config> aliens;
+	AlienUFO ufo;
+	Shield shields[Config::NUM_SHIELDS];
+};
+
+typedef GameSnapshotT<ClassicConfig> GameSnapshot;
+
+template<class Config>
+void SaveGameSnapshot(GameSnapshotT<Config>& snapshot, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo);
+template<class Config>
+void LoadGameSnapshot(const GameSnapshotT<Config>& snapshot, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens, AlienUFO& ufo);
+
+#endif // GAMESNAPSHOT_H_
@@ -0,0 +1,154 @@
+
+#include <cstring>
+
+#include "InputReplay.h"
+#include "FrameDelta.h"
+#include "TextInvaders.h"
+
+static const char INPUT_REPLAY_MAGIC[] = "TIIR";
+
+bool StartInputRecording(InputRecorder& recorder, const char* fileName, const char* variant, unsigned int seed, int width, int height, int tickRate)
+{
+	recorder.file = fopen(fileName, "wb");
+	if (recorder.file == nullptr)
+	{
+		return false;
+	}
+
+	recorder.pendingInputs.clear();
+
+	std::string header(INPUT_REPLAY_MAGIC, 4);
+	WriteUInt32(header, INPUT_REPLAY_VERSION);
+	WriteUInt32(header, seed);
+	WriteUInt16(header, width);
+	WriteUInt16(header, height);
+
+	std::string variantName(variant, strnlen(variant, INPUT_REPLAY_VARIANT_SIZE - 1));
+	variantName.resize(INPUT_REPLAY_VARIANT_SIZE, '\0');
+	header += variantName;
+	WriteUInt32(header, tickRate);
+
+	fwrite(header.data(), 1, header.size(), recorder.file);
+	return true;
+}
+
+void RecordInput(InputRecorder& recorder, int input)
+{
+	if (recorder.file != nullptr && input >= 0)
+	{
+		recorder.pendingInputs.push_back(input);
+	}
+}
+
+void RecordTick(InputRecorder& recorder, unsigned int dt)
+{
+	if (recorder.file == nullptr)
+	{
+		return;
+	}
+
+	recorder.tick.clear();
+	WriteVarInt(recorder.tick, (unsigned int)recorder.pendingInputs.size());
+
+	for (size_t i = 0; i < recorder.pendingInputs.size(); i++)
+	{
+		WriteVarInt(recorder.tick, recorder.pendingInputs[i]);
+	}
+
+	WriteVarInt(recorder.tick, dt);
+
+	fwrite(recorder.tick.data(), 1, recorder.tick.size(), recorder.file);
+	recorder.pendingInputs.clear();
+}
+
+void StopInputRecording(InputRecorder& recorder)
+{
+	if (recorder.file != nullptr)
+	{
+		fclose(recorder.file);
+		recorder.file = nullptr;
+	}
+}
+
+bool LoadInputReplay(InputReplay& replay, const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	std::string contents;
+	char buffer[4096];
+	size_t numRead;
+
+	while ((numRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		contents.append(buffer, numRead);
+	}
+	fclose(file);
+
+	const unsigned char* data = (const unsigned char*)contents.data();
+	const unsigned char* end = data + contents.size();
+
+	if (contents.size() < INPUT_REPLAY_V2_HEADER_SIZE || memcmp(data, INPUT_REPLAY_MAGIC, 4) != 0)
+	{
+		return false;
+	}
+
+	unsigned int version = ReadUInt32(data + 4);
+	size_t headerSize = version == 2 ? INPUT_REPLAY_V2_HEADER_SIZE : version == 3 ? INPUT_REPLAY_V3_HEADER_SIZE : INPUT_REPLAY_HEADER_SIZE;
+
+	if (version < 2 || version > INPUT_REPLAY_VERSION || contents.size() < headerSize)
+	{
+		return false;
+	}
+
+	replay.variant = "classic"; // the only game that could be recorded before the header named it
+	replay.tickRate = FPS;
+
+	if (version >= 3)
+	{
+		replay.variant.assign((const char*)data + INPUT_REPLAY_V2_HEADER_SIZE, strnlen((const char*)data + INPUT_REPLAY_V2_HEADER_SIZE, INPUT_REPLAY_VARIANT_SIZE));
+	}
+
+	if (version >= 4)
+	{
+		replay.tickRate = (int)ReadUInt32(data + INPUT_REPLAY_V3_HEADER_SIZE);
+	}
+
+	replay.seed = ReadUInt32(data + 8);
+	replay.width = ReadUInt16(data + 12);
+	replay.height = ReadUInt16(data + 14);
+	replay.inputs.clear();
+	replay.tickInputsEnd.clear();
+	replay.tickDts.clear();
+
+	data += headerSize;
+
+	while (data < end)
+	{
+		size_t tickStart = replay.inputs.size();
+		unsigned int numInputs;
+		unsigned int dt;
+		bool complete = ReadVarInt(data, end, numInputs);
+
+		for (unsigned int i = 0; complete && i < numInputs; i++)
+		{
+			unsigned int input;
+			complete = ReadVarInt(data, end, input);
+			replay.inputs.push_back((int)input);
+		}
+
+		if (!complete || !ReadVarInt(data, end, dt))
+		{
+			replay.inputs.resize(tickStart); // the last tick was cut off - the game did not shut down cleanly
+			break;
+		}
+
+		replay.tickInputsEnd.push_back((unsigned int)replay.inputs.size());
+		replay.tickDts.push_back(dt);
+	}
+
+	return true;
+}
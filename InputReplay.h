@@ -0,0 +1,59 @@
+#pragma once
+#ifndef INPUTREPLAY_H_
+#define INPUTREPLAY_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+Input Replay:
+
+Records what is needed to re-simulate a game exactly (TextInvaders --record-inputs file) and plays it back without a
+terminal (TextInvaders --replay file).
+
+header - "TIIR", uint32 version, uint32 random seed, uint16 width, uint16 height, the --variant name (zero padded to
+INPUT_REPLAY_VARIANT_SIZE bytes), uint32 --tick-rate
+ticks - varint number of inputs, varint input for each, varint dt (clock ticks passed to UpdateGame)
+
+The seed, the window size, the keys handled before each update and the dt of each update are everything the simulation
+reads from the outside world, so feeding them back reproduces the game tick for tick - as long as it is the same variant
+at the same tick rate, so a replay only plays back with the --variant and --tick-rate it was recorded with.
+*/
+
+enum
+{
+	INPUT_REPLAY_VERSION = 4, // 2 - hits are tested against SPRITE_MASKS, so a version 1 game would not play out the same, 3 - the variant, 4 - the tick rate (2 and 3 still load, as classic and FPS)
+	INPUT_REPLAY_VARIANT_SIZE = 16,
+	INPUT_REPLAY_V2_HEADER_SIZE = 16,
+	INPUT_REPLAY_V3_HEADER_SIZE = INPUT_REPLAY_V2_HEADER_SIZE + INPUT_REPLAY_VARIANT_SIZE,
+	INPUT_REPLAY_HEADER_SIZE = INPUT_REPLAY_V3_HEADER_SIZE + 4,
+};
+
+struct InputRecorder
+{
+	FILE* file;
+	std::vector<int> pendingInputs; // handled since the last tick
+	std::string tick;
+};
+
+struct InputReplay
+{
+	unsigned int seed;
+	int width;
+	int height;
+	std::string variant;
+	int tickRate;
+	std::vector<int> inputs; // every input of every tick, in order
+	std::vector<unsigned int> tickInputsEnd; // one past the last input of each tick
+	std::vector<unsigned int> tickDts;
+};
+
+bool StartInputRecording(InputRecorder& recorder, const char* fileName, const char* variant, unsigned int seed, int width, int height, int tickRate); // returns false if the file could not be created
+void RecordInput(InputRecorder& recorder, int input);
+void RecordTick(InputRecorder& recorder, unsigned int dt);
+void StopInputRecording(InputRecorder& recorder);
+
+bool LoadInputReplay(InputReplay& replay, const char* fileName); // returns false if the file is missing or corrupt
+
+#endif // INPUTREPLAY_H_
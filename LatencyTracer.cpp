@@ -0,0 +1,195 @@
+
+#include <cstring>
+
+#include "LatencyTracer.h"
+#include "CursesUtils.h"
+
+static const char* const LATENCY_INPUT_NAMES[NUM_LATENCY_INPUT_TYPES] = { "move", "fire", "menu" };
+
+static int FindLatencyBucket(long long microseconds)
+{
+	int bucket = 0;
+
+	for (long long rest = microseconds >> LATENCY_FIRST_BUCKET_BITS; rest > 0 && bucket < LATENCY_NUM_BUCKETS - 1; rest >>= 1)
+	{
+		bucket++;
+	}
+
+	return bucket;
+}
+
+static long long LatencyBucketLimit(int bucket) // microseconds every latency in the bucket is under - the last one has no limit
+{
+	return 1LL << (LATENCY_FIRST_BUCKET_BITS + bucket);
+}
+
+long long FindLatencyPercentile(const LatencyHistogram& histogram, int percent)
+{
+	unsigned int wanted = (unsigned int)(((unsigned long long)histogram.count * percent + 99) / 100);
+	unsigned int seen = 0;
+
+	for (int bucket = 0; bucket < LATENCY_NUM_BUCKETS - 1; bucket++)
+	{
+		seen += histogram.buckets[bucket];
+
+		if (seen >= wanted)
+		{
+			return LatencyBucketLimit(bucket) < histogram.maxMicroseconds ? LatencyBucketLimit(bucket) : histogram.maxMicroseconds;
+		}
+	}
+
+	return histogram.maxMicroseconds;
+}
+
+void RecordLatency(LatencyHistogram& histogram, long long microseconds)
+{
+	histogram.buckets[FindLatencyBucket(microseconds)]++;
+	histogram.count++;
+	histogram.totalMicroseconds += microseconds;
+	histogram.maxMicroseconds = microseconds > histogram.maxMicroseconds ? microseconds : histogram.maxMicroseconds;
+}
+
+void InitLatencyTracer(LatencyTracer& tracer, bool enabled, const char* fileName)
+{
+	tracer.enabled = enabled;
+	tracer.showOverlay = false;
+	tracer.fileName = fileName;
+	tracer.numPending = 0;
+	memset(tracer.histograms, 0, sizeof(tracer.histograms));
+}
+
+void BeginTraceInput(LatencyTracer& tracer, const InputEvent& event, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo)
+{
+	tracer.event = event;
+
+	if (!tracer.enabled || event.key == ERR)
+	{
+		return;
+	}
+
+	if (game.currentState == GS_PLAY && (event.key == AK_LEFT || event.key == AK_RIGHT))
+	{
+		tracer.eventType = LIT_MOVE;
+	}
+	else if (game.currentState == GS_PLAY && event.key == ' ')
+	{
+		tracer.eventType = LIT_FIRE;
+	}
+	else
+	{
+		tracer.eventType = LIT_MENU;
+	}
+
+	SaveGameSnapshot(tracer.before, game, player, shields, numberOfShields, aliens, ufo);
+	tracer.beforeCursor = game.gameOverHPositionCursor;
+	memcpy(tracer.beforeName, game.playerName, sizeof(tracer.beforeName));
+}
+
+void EndTraceInput(LatencyTracer& tracer, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo)
+{
+	if (!tracer.enabled || tracer.event.key == ERR || tracer.numPending == LATENCY_MAX_PENDING)
+	{
+		return;
+	}
+
+	GameSnapshot after;
+	SaveGameSnapshot(after, game, player, shields, numberOfShields, aliens, ufo);
+
+	// the game over cursor and name are not in a snapshot, they are only ever drawn
+	if (memcmp(&after, &tracer.before, sizeof(after)) == 0 && game.gameOverHPositionCursor == tracer.beforeCursor &&
+		memcmp(game.playerName, tracer.beforeName, sizeof(tracer.beforeName)) == 0)
+	{
+		return; // nothing to show - a move into the wall, a second shot while the first is in flight
+	}
+
+	PendingLatency& pending = tracer.pending[tracer.numPending++];
+	pending.type = tracer.eventType;
+	pending.readMicroseconds = tracer.event.microseconds;
+}
+
+void TraceFlush(LatencyTracer& tracer)
+{
+	if (tracer.numPending == 0)
+	{
+		return;
+	}
+
+	long long now = InputClockMicroseconds();
+
+	for (int i = 0; i < tracer.numPending; i++)
+	{
+		RecordLatency(tracer.histograms[tracer.pending[i].type], now - tracer.pending[i].readMicroseconds);
+	}
+
+	tracer.numPending = 0;
+}
+
+void DrawLatencyOverlay(const LatencyTracer& tracer)
+{
+	char line[128];
+	int xPos = ScreenWidth() - 48;
+
+	DrawString(xPos, 1, "LATENCY     COUNT   P50 us   P99 us   MAX us");
+
+	for (int type = 0; type < NUM_LATENCY_INPUT_TYPES; type++)
+	{
+		const LatencyHistogram& histogram = tracer.histograms[type];
+
+		snprintf(line, sizeof(line), "%-8s %8u %8lld %8lld %8lld", LATENCY_INPUT_NAMES[type], histogram.count,
+			histogram.count > 0 ? FindLatencyPercentile(histogram, 50) : 0LL, histogram.count > 0 ? FindLatencyPercentile(histogram, 99) : 0LL,
+			histogram.maxMicroseconds);
+		DrawString(xPos, 2 + type, line);
+	}
+}
+
+void WriteLatencyHistograms(const LatencyTracer& tracer, FILE* out)
+{
+	fprintf(out, "kind count mean_us p50_us p99_us max_us\n");
+
+	for (int type = 0; type < NUM_LATENCY_INPUT_TYPES; type++)
+	{
+		const LatencyHistogram& histogram = tracer.histograms[type];
+
+		fprintf(out, "%s %u %lld %lld %lld %lld\n", LATENCY_INPUT_NAMES[type], histogram.count,
+			histogram.count > 0 ? histogram.totalMicroseconds / histogram.count : 0LL,
+			histogram.count > 0 ? FindLatencyPercentile(histogram, 50) : 0LL, histogram.count > 0 ? FindLatencyPercentile(histogram, 99) : 0LL,
+			histogram.maxMicroseconds);
+	}
+
+	fprintf(out, "\nunder_us move fire menu\n");
+
+	for (int bucket = 0; bucket < LATENCY_NUM_BUCKETS; bucket++)
+	{
+		if (bucket < LATENCY_NUM_BUCKETS - 1)
+		{
+			fprintf(out, "%lld", LatencyBucketLimit(bucket));
+		}
+		else
+		{
+			fprintf(out, "inf");
+		}
+
+		for (int type = 0; type < NUM_LATENCY_INPUT_TYPES; type++)
+		{
+			fprintf(out, " %u", tracer.histograms[type].buckets[bucket]);
+		}
+
+		fprintf(out, "\n");
+	}
+}
+
+void ShutDownLatencyTracer(LatencyTracer& tracer)
+{
+	if (!tracer.enabled || tracer.fileName == nullptr)
+	{
+		return;
+	}
+
+	FILE* file = fopen(tracer.fileName, "w");
+
+	if (file != nullptr)
+	{
+		WriteLatencyHistograms(tracer, file);
+		fclose(file);
+	}
+}
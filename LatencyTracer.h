@@ -0,0 +1,83 @@
+#pragma once
+#ifndef LATENCYTRACER_H_
+#define LATENCYTRACER_H_
+
+#include <cstdio>
+
+#include "GameSnapshot.h"
+#include "RawInput.h"
+
+/*
+Latency Tracer:
+
+How long a key takes to show on screen (TextInvaders --trace-latency [file]). Each key is stamped when it is read
+(InputEvent), the game is compared before and after HandleInput to tag the keys that changed something, and a tagged
+key's latency ends when RefreshScreen returns from flushing the next frame - the first one that can show the change.
+
+Latencies go in a histogram per kind of input, with power of two buckets from 128us up. 'l' shows them over the game
+while playing, and they are written to the file when the game quits:
+
+kind, count, mean, p50, p99 and max in microseconds, one line per kind
+then the bucket counts, one line per bucket: upper bound in microseconds, then a count per kind
+
+p50 and p99 are the upper bounds of the buckets they fall in, or the max if that is lower.
+*/
+
+enum LatencyInputType
+{
+	LIT_MOVE = 0, // left and right while playing
+	LIT_FIRE, // space while playing
+	LIT_MENU, // everything else - the intro, high score and game over screens, respawning
+	NUM_LATENCY_INPUT_TYPES
+};
+
+enum
+{
+	LATENCY_NUM_BUCKETS = 16,
+	LATENCY_FIRST_BUCKET_BITS = 7, // the first bucket is everything under 1 << LATENCY_FIRST_BUCKET_BITS microseconds
+	LATENCY_MAX_PENDING = 64, // tagged keys waiting for a flush - any more are not traced
+};
+
+struct LatencyHistogram
+{
+	unsigned int buckets[LATENCY_NUM_BUCKETS];
+	unsigned int count;
+	long long totalMicroseconds;
+	long long maxMicroseconds;
+};
+
+struct PendingLatency
+{
+	LatencyInputType type;
+	long long readMicroseconds;
+};
+
+struct LatencyTracer
+{
+	bool enabled;
+	bool showOverlay;
+	const char* fileName; // where the histograms are written on quit, nullptr for nowhere
+
+	InputEvent event; // the key being handled
+	LatencyInputType eventType;
+	GameSnapshot before; // the game before it was handled
+	int beforeCursor;
+	char beforeName[MAX_NUMBER_OF_CHARACTERS_IN_NAME + 1];
+
+	PendingLatency pending[LATENCY_MAX_PENDING];
+	int numPending;
+	LatencyHistogram histograms[NUM_LATENCY_INPUT_TYPES];
+};
+
+void InitLatencyTracer(LatencyTracer& tracer, bool enabled, const char* fileName);
+void BeginTraceInput(LatencyTracer& tracer, const InputEvent& event, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo); // just before HandleInput
+void EndTraceInput(LatencyTracer& tracer, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo); // just after - tags the key if the game changed
+void TraceFlush(LatencyTracer& tracer); // just after RefreshScreen - every tagged key is on screen now
+void DrawLatencyOverlay(const LatencyTracer& tracer); // before RefreshScreen, if showOverlay
+void WriteLatencyHistograms(const LatencyTracer& tracer, FILE* out);
+void ShutDownLatencyTracer(LatencyTracer& tracer); // writes the histograms to fileName
+
+void RecordLatency(LatencyHistogram& histogram, long long microseconds); // a histogram can also be filled without a tracer - the load generator's
+long long FindLatencyPercentile(const LatencyHistogram& histogram, int percent); // the upper bound of the bucket it falls in, or the max if that is lower
+
+#endif // LATENCYTRACER_H_
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef LEVELTABLES_H_
+#define LEVELTABLES_H_
+
+#include "TextInvaders.h"
+
+/*
+Level Tables:
+
+Everything about the swarm that depends only on the level, the line it has dropped to or how many aliens are left, worked
+out by the compiler for each GameConfig:
+
+swarmStepTicks[line][aliensLeft] - ticks between two swarm steps
+bombChanceDivisor[aliensLeft] - the swarm shoots when DrawGameRandom() % divisor == 1
+swarmStartLine[level], swarmStartRowsAboveBottom[level] - where a level's swarm starts
+
+The Make* functions below are the formulas - tune them there. They keep the float maths the game has always used, but
+it all runs at build time, so the game itself only ever indexes a table. LEVEL_TABLES<Config> is a constant expression,
+so an entry can be checked with a static_assert.
+*/
+
+template<class Config>
+struct LevelTables
+{
+	unsigned char swarmStepTicks[Config::NUM_ALIEN_LINES + 1][Config::NUM_ALIEN_ROWS * Config::NUM_ALIEN_COLUMNS + 1];
+	int bombChanceDivisor[Config::NUM_ALIEN_ROWS * Config::NUM_ALIEN_COLUMNS + 1];
+	int swarmStartLine[NUM_LEVELS + 1]; // levels start at 1
+	int swarmStartRowsAboveBottom[NUM_LEVELS + 1]; // rows between the top of the swarm and the bottom of the window
+};
+
+template<class Config>
+constexpr int MakeSwarmStepTicks(int line, int aliensLeft)
+{
+	return int(line * 2 + (5 * (float(aliensLeft) / float(Config::NUM_ALIEN_COLUMNS * Config::NUM_ALIEN_ROWS)))); // fewer aliens and lower lines - faster steps
+}
+
+template<class Config>
+constexpr int MakeBombChanceDivisor(int aliensLeft)
+{
+	return 70 - int(float(Config::NUM_ALIEN_ROWS * Config::NUM_ALIEN_COLUMNS) / float(aliensLeft + 1)); // fewer aliens - more bombs
+}
+
+template<class Config>
+constexpr int MakeSwarmStartLine(int level)
+{
+	return Config::NUM_ALIEN_LINES - (level - 1); // every level starts a line further down
+}
+
+template<class Config>
+constexpr int MakeSwarmStartRowsAboveBottom(int level)
+{
+	return Config::NUM_ALIEN_LINES + Config::NUM_ALIEN_ROWS * Config::ALIEN_SPRITE_HEIGHT + Config::ALIENS_Y_PADDING * (Config::NUM_ALIEN_ROWS - 1) + 3 - level; // room for every line it can drop, plus the player
+}
+
+template<class Config>
+constexpr LevelTables<Config> MakeLevelTables()
+{
+	static_assert(int(Config::NUM_ALIEN_LINES) >= int(NUM_LEVELS), "the last level has to start with lines left to drop");
+
+	LevelTables<Config> tables = {};
+
+	for (int line = 0; line <= Config::NUM_ALIEN_LINES; line++)
+	{
+		for (int aliensLeft = 0; aliensLeft <= Config::NUM_ALIEN_ROWS * Config::NUM_ALIEN_COLUMNS; aliensLeft++)
+		{
+			tables.swarmStepTicks[line][aliensLeft] = (unsigned char)MakeSwarmStepTicks<Config>(line, aliensLeft);
+		}
+	}
+
+	for (int aliensLeft = 0; aliensLeft <= Config::NUM_ALIEN_ROWS * Config::NUM_ALIEN_COLUMNS; aliensLeft++)
+	{
+		tables.bombChanceDivisor[aliensLeft] = MakeBombChanceDivisor<Config>(aliensLeft);
+	}
+
+	for (int level = 1; level <= NUM_LEVELS; level++)
+	{
+		tables.swarmStartLine[level] = MakeSwarmStartLine<Config>(level);
+		tables.swarmStartRowsAboveBottom[level] = MakeSwarmStartRowsAboveBottom<Config>(level);
+	}
+
+	return tables;
+}
+
+template<class Config>
+constexpr LevelTables<Config> LEVEL_TABLES = MakeLevelTables<Config>();
+
+static_assert(LEVEL_TABLES<ClassicConfig>.swarmStepTicks[ClassicConfig::NUM_ALIEN_LINES][NUM_ALIEN_ROWS * NUM_ALIEN_COLUMNS] == 27, "a full swarm on level 1 steps every 27 ticks");
+static_assert(LEVEL_TABLES<ClassicConfig>.bombChanceDivisor[0] == 15, "the last alien shoots on 1 in 15 ticks");
+
+#endif // LEVELTABLES_H_
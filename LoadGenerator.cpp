@@ -0,0 +1,423 @@
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "LoadGenerator.h"
+#include "GameServer.h"
+#include "FrameDelta.h"
+#include "RawInput.h"
+#include "CursesUtils.h"
+
+#ifndef _WIN32
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL | MSG_DONTWAIT; // a server going away should not kill the generator with SIGPIPE
+#else
+static const int SEND_FLAGS = MSG_DONTWAIT;
+#endif
+
+static bool ScreenShows(const FrameReceiver& receiver, const char* text)
+{
+	const char* textEnd = text + strlen(text);
+	return std::search(receiver.cells.begin(), receiver.cells.end(), text, textEnd) != receiver.cells.end();
+}
+
+static LoadBotScreen FindBotScreen(const FrameReceiver& receiver)
+{
+	if (ScreenShows(receiver, "WELCOME TO TEXT INVADERS!"))
+	{
+		return LBS_INTRO;
+	}
+	else if (ScreenShows(receiver, "Please Enter your name"))
+	{
+		return LBS_NAME_ENTRY;
+	}
+	else if (ScreenShows(receiver, "High Scores"))
+	{
+		return LBS_HIGH_SCORES;
+	}
+
+	return LBS_PLAY;
+}
+
+static int FindPlayerX(const FrameReceiver& receiver) // -1 if it is not on the screen
+{
+	const char* sprite = PLAYER_SPRITE[0];
+	std::vector<char>::const_iterator found = std::search(receiver.cells.begin(), receiver.cells.end(), sprite, sprite + strlen(sprite));
+
+	return found != receiver.cells.end() ? (int)((found - receiver.cells.begin()) % receiver.width) : -1;
+}
+
+static long long RandomKeyInterval()
+{
+	return (LOAD_MIN_KEY_INTERVAL + rand() % (LOAD_MAX_KEY_INTERVAL - LOAD_MIN_KEY_INTERVAL + 1)) * 1000LL;
+}
+
+static int ChooseBotKey(LoadSession& session)
+{
+	const int PLAY_KEYS[] = { AK_LEFT, AK_RIGHT, ' ' };
+	const int NAME_KEYS[] = { AK_UP, AK_DOWN, AK_RIGHT };
+
+	int key;
+
+	switch (session.screen)
+	{
+	case LBS_PLAY:
+		key = PLAY_KEYS[rand() % 3];
+		if (key != ' ' && session.keySentTime != 0 && session.keyDirection != 0)
+		{
+			return session.keyDirection < 0 ? AK_LEFT : AK_RIGHT; // going back could undo the timed move before it is drawn
+		}
+		return key;
+	case LBS_NAME_ENTRY:
+		if (session.nameKeysLeft > 0)
+		{
+			session.nameKeysLeft--;
+			return NAME_KEYS[rand() % 3];
+		}
+		return ' ';
+	default:
+		return ' '; // on to the next screen
+	}
+}
+
+static bool StartTimingKey(LoadSession& session, int key) // false for a key whose frame cannot be told apart
+{
+	session.keyScreen = session.screen;
+	session.keyPlayerX = session.playerX;
+	session.keyDirection = 0;
+
+	if (session.screen != LBS_PLAY)
+	{
+		return key == ' ';
+	}
+
+	if (!session.playerMoving)
+	{
+		return false;
+	}
+
+	if (key == AK_LEFT && session.playerX > 0)
+	{
+		session.keyDirection = -1;
+	}
+	else if (key == AK_RIGHT && session.playerX + PLAYER_SPRITE_WIDTH < session.receiver.width)
+	{
+		session.keyDirection = 1;
+	}
+
+	return session.keyDirection != 0;
+}
+
+static void RecordKeyLatency(LoadSession& session, LoadStepResult& result, long long now)
+{
+	long long latency = now - session.keySentTime;
+
+	RecordLatency(result.latency, latency);
+	session.starved = session.starved || latency > LOAD_STARVED_INTERVAL * 1000LL;
+	session.keySentTime = 0;
+}
+
+static void TimeKey(LoadSession& session, LoadStepResult& result, LoadBotScreen screen, int playerX, long long now)
+{
+	if (session.keyDirection == 0)
+	{
+		if (screen != session.keyScreen)
+		{
+			RecordKeyLatency(session, result, now);
+		}
+	}
+	else if (playerX < 0)
+	{
+		session.keySentTime = 0; // hit, or the game ended, before the move could show - there is nothing to time
+	}
+	else if ((playerX - session.keyPlayerX) * session.keyDirection > 0)
+	{
+		RecordKeyLatency(session, result, now);
+	}
+}
+
+static bool ConnectLoadSession(LoadSession& session, const char* path, int epollHandle)
+{
+	session.socket = ConnectToGame(path);
+
+	if (session.socket < 0)
+	{
+		return false;
+	}
+
+	std::string hello;
+	WriteUInt16(hello, LOAD_SCREEN_WIDTH | SERVER_HELLO_BOT);
+	WriteUInt16(hello, LOAD_SCREEN_HEIGHT);
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = &session;
+
+	if (send(session.socket, hello.data(), hello.size(), SEND_FLAGS) != (ssize_t)hello.size() ||
+		epoll_ctl(epollHandle, EPOLL_CTL_ADD, session.socket, &event) != 0)
+	{
+		close(session.socket);
+		session.socket = -1;
+		return false;
+	}
+
+	InitFrameReceiver(session.receiver);
+	session.screen = LBS_INTRO;
+	session.nameKeysLeft = 0;
+	session.playerX = -1;
+	session.playerMoving = false;
+	session.nextKeyTime = InputClockMicroseconds() + RandomKeyInterval();
+	session.keySentTime = 0;
+	session.starved = false;
+	session.numBytes = 0;
+
+	return true;
+}
+
+static void ReadLoadSession(LoadSession& session, LoadStepResult& result)
+{
+	char buffer[16 * 1024];
+
+	for (;;)
+	{
+		ssize_t numRead = recv(session.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			close(session.socket); // closed by the server, and out of the epoll set with it
+			session.socket = -1;
+			result.numClosed++;
+			return;
+		}
+
+		if (numRead < 0)
+		{
+			return;
+		}
+
+		session.numBytes += numRead;
+
+		if (!ReceiveFrameMessages(session.receiver, buffer, numRead))
+		{
+			continue;
+		}
+
+		LoadBotScreen screen = FindBotScreen(session.receiver);
+		int playerX = screen == LBS_PLAY ? FindPlayerX(session.receiver) : -1;
+
+		session.playerMoving = playerX >= 0 && session.playerX >= 0 && (session.playerMoving || playerX != session.playerX);
+
+		if (session.keySentTime != 0)
+		{
+			TimeKey(session, result, screen, playerX, InputClockMicroseconds());
+		}
+
+		session.playerX = playerX;
+
+		if (screen == LBS_PLAY && session.screen == LBS_INTRO)
+		{
+			result.numGamesStarted++;
+		}
+		else if (screen == LBS_NAME_ENTRY && session.screen != LBS_NAME_ENTRY)
+		{
+			result.numGamesFinished++;
+			session.nameKeysLeft = LOAD_NAME_KEYS;
+		}
+
+		session.screen = screen;
+	}
+}
+
+static void PressBotKey(LoadSession& session, long long now)
+{
+	char bytes[RAW_INPUT_MAX_KEY_BYTES];
+	int key = ChooseBotKey(session);
+	int numBytes = EncodeInputKey(key, bytes);
+
+	if (send(session.socket, bytes, numBytes, SEND_FLAGS) == numBytes && session.keySentTime == 0 && StartTimingKey(session, key))
+	{
+		session.keySentTime = now; // the latency is to the first frame that shows it, a later key does not restart it
+	}
+
+	session.nextKeyTime = now + RandomKeyInterval();
+}
+
+static void RunLoadStep(const char* path, int numPlayers, int seconds, LoadStepResult& result)
+{
+	memset(&result, 0, sizeof(result));
+	result.numPlayers = numPlayers;
+
+	int epollHandle = epoll_create1(0);
+
+	if (epollHandle < 0)
+	{
+		return;
+	}
+
+	std::vector<LoadSession> sessions(numPlayers); // never resized, epoll holds pointers into it
+
+	std::vector<bool> connected(numPlayers);
+
+	for (int i = 0; i < numPlayers; i++)
+	{
+		connected[i] = ConnectLoadSession(sessions[i], path, epollHandle);
+	}
+
+	const int MAX_EVENTS = 256;
+	epoll_event events[MAX_EVENTS];
+
+	long long startTime = InputClockMicroseconds();
+	long long endTime = startTime + seconds * 1000000LL;
+	long long now = startTime;
+
+	while (now < endTime)
+	{
+		int numEvents = epoll_wait(epollHandle, events, MAX_EVENTS, 5);
+
+		for (int i = 0; i < numEvents; i++)
+		{
+			LoadSession& session = *(LoadSession*)events[i].data.ptr;
+
+			if (session.socket >= 0)
+			{
+				ReadLoadSession(session, result);
+			}
+		}
+
+		now = InputClockMicroseconds();
+
+		for (int i = 0; i < numPlayers; i++)
+		{
+			if (sessions[i].socket >= 0 && now >= sessions[i].nextKeyTime)
+			{
+				PressBotKey(sessions[i], now);
+			}
+		}
+	}
+
+	double elapsedSeconds = (now - startTime) / 1000000.0;
+	double totalFramesPerSecond = 0.0;
+	unsigned long long totalBytes = 0;
+
+	for (int i = 0; i < numPlayers; i++)
+	{
+		LoadSession& session = sessions[i];
+
+		if (!connected[i])
+		{
+			continue;
+		}
+
+		if (session.keySentTime != 0 && now - session.keySentTime > LOAD_STARVED_INTERVAL * 1000LL)
+		{
+			RecordKeyLatency(session, result, now); // still waiting - leaving it out would hide the worst of it
+		}
+
+		double framesPerSecond = session.receiver.numFrames / elapsedSeconds; // a closed session's frames count over the whole step
+
+		if (result.numConnected == 0 || framesPerSecond < result.minFramesPerSecond)
+		{
+			result.minFramesPerSecond = framesPerSecond;
+		}
+
+		totalFramesPerSecond += framesPerSecond;
+		totalBytes += session.numBytes;
+		result.numConnected++;
+		result.numStarved += session.starved ? 1 : 0;
+
+		if (session.socket >= 0)
+		{
+			close(session.socket);
+		}
+	}
+
+	if (result.numConnected > 0)
+	{
+		result.meanFramesPerSecond = totalFramesPerSecond / result.numConnected;
+		result.kilobytesPerSecond = totalBytes / 1024.0 / elapsedSeconds / result.numConnected;
+	}
+
+	close(epollHandle);
+}
+
+static void PrintLoadStepResult(const LoadStepResult& result, const LoadStepResult& first)
+{
+	printf("%7d %9d %7d %7d %9.1f %9.1f %9.2f %8.1f %8.1f %8.1f %7u %7u %6.0f%%\n", result.numPlayers, result.numConnected,
+		result.numClosed, result.numStarved, result.meanFramesPerSecond, result.minFramesPerSecond, result.kilobytesPerSecond,
+		result.latency.count > 0 ? FindLatencyPercentile(result.latency, 50) / 1000.0 : 0.0,
+		result.latency.count > 0 ? FindLatencyPercentile(result.latency, 99) / 1000.0 : 0.0,
+		result.latency.maxMicroseconds / 1000.0, result.numGamesStarted, result.numGamesFinished,
+		first.meanFramesPerSecond > 0.0 ? 100.0 * result.meanFramesPerSecond / first.meanFramesPerSecond : 0.0);
+	fflush(stdout);
+}
+
+int RunLoadTest(const char* path, const char* playerCounts, int seconds)
+{
+	int steps[LOAD_MAX_STEPS];
+	int numSteps = 0;
+
+	for (const char* count = playerCounts; count != nullptr && *count != '\0' && numSteps < LOAD_MAX_STEPS; )
+	{
+		steps[numSteps] = atoi(count);
+
+		if (steps[numSteps] <= 0)
+		{
+			fprintf(stderr, "Bad number of players in %s\n", playerCounts);
+			return 1;
+		}
+
+		numSteps++;
+		count = strchr(count, ',');
+		count = count != nullptr ? count + 1 : nullptr;
+	}
+
+	seconds = seconds > 0 ? seconds : LOAD_DEFAULT_SECONDS;
+
+	printf("Load test on %s, %i seconds a step\n", path, seconds);
+	printf("%7s %9s %7s %7s %9s %9s %9s %8s %8s %8s %7s %7s %7s\n", "players", "connected", "closed", "starved", "frames/s", "min f/s", "KB/s",
+		"p50 ms", "p99 ms", "max ms", "started", "ended", "f/s vs");
+
+	LoadStepResult first;
+	memset(&first, 0, sizeof(first));
+
+	for (int step = 0; step < numSteps; step++)
+	{
+		LoadStepResult result;
+		RunLoadStep(path, steps[step], seconds, result);
+
+		if (step == 0)
+		{
+			first = result;
+		}
+
+		PrintLoadStepResult(result, first);
+	}
+
+	return 0;
+}
+
+#else
+
+int RunLoadTest(const char*, const char*, int)
+{
+	fprintf(stderr, "The load generator is not supported on this platform\n");
+	return 1;
+}
+
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef LOADGENERATOR_H_
+#define LOADGENERATOR_H_
+
+#include "SpectatorBroadcast.h"
+#include "LatencyTracer.h"
+
+/*
+Load Generator:
+
+Capacity planning for the game server (GameServer.h) without real players: TextInvaders --load-test [path]
+--load-players 50,100,200,400 --load-seconds 10 plays that many bot sessions on a running server for each count in turn
+and reports how well it kept up - sessions connected, closed and starved (a key not shown after LOAD_STARVED_INTERVAL),
+frames and KB a second per session, key to frame latency (p50, p99, max) and games played.
+
+A bot reads its screen as it arrives (FrameReceiver) and presses a key every LOAD_MIN_KEY_INTERVAL to
+LOAD_MAX_KEY_INTERVAL milliseconds: space past the intro and high scores, a few letters for a name, and left, right and
+fire while playing. Only keys whose effect can be seen are timed - a screen going, or the player moving its way. Bots
+set SERVER_HELLO_BOT, so a load test leaves a live server's high scores alone. The server only sends changed frames, so
+frames/s is below FPS even when nothing is dropped. Not available on Windows builds.
+*/
+
+enum
+{
+	LOAD_MAX_STEPS = 16, // numbers of players in one run
+	LOAD_DEFAULT_SECONDS = 10,
+	LOAD_MIN_KEY_INTERVAL = 80, // milliseconds
+	LOAD_MAX_KEY_INTERVAL = 250,
+	LOAD_SCREEN_WIDTH = 80, // the terminal size every bot asks for
+	LOAD_SCREEN_HEIGHT = 30,
+	LOAD_NAME_KEYS = 6, // arrows pressed on the name entry screen before space
+	LOAD_STARVED_INTERVAL = 1000, // milliseconds
+};
+
+enum LoadBotScreen
+{
+	LBS_INTRO = 0,
+	LBS_PLAY,
+	LBS_NAME_ENTRY,
+	LBS_HIGH_SCORES
+};
+
+struct LoadSession
+{
+	int socket; // -1 once the server has closed it
+	FrameReceiver receiver;
+	LoadBotScreen screen; // worked out from the last frame
+	int nameKeysLeft;
+	int playerX; // the player's column in the last frame, -1 when it is not on the screen
+	bool playerMoving; // seen moving since it last came on the screen, so a move key shows straight away
+	long long nextKeyTime; // microseconds, InputClockMicroseconds' clock
+	long long keySentTime; // the key being timed, 0 if there is none
+	LoadBotScreen keyScreen; // the screen it was pressed on
+	int keyPlayerX;
+	int keyDirection; // -1 left, 1 right, 0 for a key that leaves the screen
+	bool starved;
+	unsigned long long numBytes;
+};
+
+struct LoadStepResult
+{
+	int numPlayers;
+	int numConnected;
+	int numClosed;
+	int numStarved;
+	double meanFramesPerSecond;
+	double minFramesPerSecond;
+	double kilobytesPerSecond;
+	LatencyHistogram latency;
+	unsigned int numGamesStarted;
+	unsigned int numGamesFinished;
+};
+
+int RunLoadTest(const char* path, const char* playerCounts, int seconds); // playerCounts is a comma separated list
+
+#endif // LOADGENERATOR_H_
@@ -0,0 +1,725 @@
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "Netplay.h"
+#include "GameServer.h"
+#include "SpectatorBroadcast.h"
+#include "StateHash.h"
+#include "FrameDelta.h"
+#include "CursesUtils.h"
+
+#ifndef _WIN32
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL; // the other player leaving should not kill this one with SIGPIPE
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+static const int NETPLAY_MESSAGE_SIZES[] = { 0, 5, 9, 7, 13 }; // by NetplayMessageType, the type byte included
+
+/* Messages */
+
+static void QueueMessage(Netplay& netplay, const std::string& message)
+{
+	long long delay = netplay.delayMilliseconds * 1000LL;
+
+	if (netplay.jitterMilliseconds > 0)
+	{
+		netplay.delayRandom = netplay.delayRandom * 1103515245u + 12345u;
+		delay += ((long long)((netplay.delayRandom >> 16) % (2 * netplay.jitterMilliseconds + 1)) - netplay.jitterMilliseconds) * 1000;
+	}
+
+	DelayedMessage delayed;
+	delayed.sendTime = InputClockMicroseconds() + (delay > 0 ? delay : 0);
+	delayed.bytes = message;
+
+	if (!netplay.outgoing.empty() && delayed.sendTime < netplay.outgoing.back().sendTime)
+	{
+		delayed.sendTime = netplay.outgoing.back().sendTime; // a stream never overtakes itself
+	}
+
+	netplay.outgoing.push_back(delayed);
+}
+
+static bool SendAll(int socketHandle, const char* bytes, size_t numBytes)
+{
+	while (numBytes > 0)
+	{
+		ssize_t numSent = send(socketHandle, bytes, numBytes, SEND_FLAGS);
+
+		if (numSent < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numSent <= 0)
+		{
+			return false;
+		}
+
+		bytes += numSent;
+		numBytes -= numSent;
+	}
+
+	return true;
+}
+
+static void FlushMessages(Netplay& netplay)
+{
+	long long now = InputClockMicroseconds();
+
+	while (!netplay.outgoing.empty() && netplay.outgoing.front().sendTime <= now)
+	{
+		const std::string& bytes = netplay.outgoing.front().bytes;
+
+		if (!netplay.remoteGone && !SendAll(netplay.socket, bytes.data(), bytes.size()))
+		{
+			netplay.remoteGone = true;
+		}
+
+		netplay.outgoing.pop_front();
+	}
+}
+
+static bool ReceiveExactly(int socketHandle, unsigned char* bytes, size_t numBytes) // for the handshake, which waits for it
+{
+	while (numBytes > 0)
+	{
+		pollfd pollInfo;
+		pollInfo.fd = socketHandle;
+		pollInfo.events = POLLIN;
+		pollInfo.revents = 0;
+
+		if (poll(&pollInfo, 1, 10000) <= 0)
+		{
+			return false;
+		}
+
+		ssize_t numRead = recv(socketHandle, bytes, numBytes, 0);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numRead <= 0)
+		{
+			return false;
+		}
+
+		bytes += numRead;
+		numBytes -= numRead;
+	}
+
+	return true;
+}
+
+/* Ticks */
+
+static NetplayInput& FindInput(Netplay& netplay, unsigned int tick) // the keys for a tick, cleared if the slot held an older one
+{
+	NetplayInput& input = netplay.inputs[tick % NETPLAY_INPUTS];
+
+	if (input.tick != tick)
+	{
+		input.tick = tick;
+		input.remoteKnown = false;
+
+		for (int side = 0; side < NETPLAY_SIDES; side++)
+		{
+			input.keys[side] = NETPLAY_NO_KEY; // also the prediction for a remote key that has not arrived
+		}
+	}
+
+	return input;
+}
+
+static void SaveVersusSnapshot(Netplay& netplay, unsigned int tick)
+{
+	VersusSnapshot& snapshot = netplay.snapshots[tick % NETPLAY_SNAPSHOTS];
+
+	for (int side = 0; side < NETPLAY_SIDES; side++)
+	{
+		GameWorld& game = netplay.games[side];
+		SaveGameSnapshot(snapshot.games[side], game.game, game.player, game.shields, NUM_SHIELDS, game.aliens, game.ufo);
+	}
+}
+
+static void LoadVersusSnapshot(Netplay& netplay, unsigned int tick)
+{
+	const VersusSnapshot& snapshot = netplay.snapshots[tick % NETPLAY_SNAPSHOTS];
+
+	for (int side = 0; side < NETPLAY_SIDES; side++)
+	{
+		GameWorld& game = netplay.games[side];
+		LoadGameSnapshot(snapshot.games[side], game.game, game.player, game.shields, NUM_SHIELDS, game.aliens, game.ufo);
+	}
+}
+
+static void PlayTick(Netplay& netplay, unsigned int tick) // the games are as they were before tick, and after it once this returns
+{
+	NetplayInput& input = FindInput(netplay, tick);
+
+	for (int side = 0; side < NETPLAY_SIDES; side++)
+	{
+		GameWorld& game = netplay.games[side];
+
+		if (game.game.currentState == GS_GAME_OVER)
+		{
+			continue; // out of lives, it waits for the other one
+		}
+
+		if (input.keys[side] != NETPLAY_NO_KEY)
+		{
+			InputEvent event;
+			event.key = input.keys[side];
+			event.microseconds = 0;
+			HandleServerInput(event, game, netplay.table);
+		}
+
+		UpdateServerGame(game);
+	}
+
+	SaveVersusSnapshot(netplay, tick + 1);
+}
+
+static void RollBack(Netplay& netplay)
+{
+	if (netplay.rollbackTo >= netplay.tick)
+	{
+		return;
+	}
+
+	long long startTime = InputClockMicroseconds();
+	unsigned int numTicks = netplay.tick - netplay.rollbackTo;
+
+	LoadVersusSnapshot(netplay, netplay.rollbackTo);
+
+	for (unsigned int tick = netplay.rollbackTo; tick < netplay.tick; tick++)
+	{
+		PlayTick(netplay, tick);
+	}
+
+	long long microseconds = InputClockMicroseconds() - startTime;
+
+	netplay.numRollbacks++;
+	netplay.numResimulatedTicks += numTicks;
+	netplay.resimulationMicroseconds += microseconds;
+
+	if (numTicks > netplay.deepestRollback || (numTicks == netplay.deepestRollback && microseconds > netplay.deepestRollbackMicroseconds))
+	{
+		netplay.deepestRollback = numTicks;
+		netplay.deepestRollbackMicroseconds = microseconds;
+	}
+
+	netplay.rollbackTo = netplay.tick;
+}
+
+static uint64_t HashVersusSnapshot(const VersusSnapshot& snapshot)
+{
+	return HashGameState(snapshot.games[0]) * 31 + HashGameState(snapshot.games[1]);
+}
+
+static void CompareHashes(Netplay& netplay, unsigned int tick)
+{
+	std::map<unsigned int, uint64_t>::iterator local = netplay.localHashes.find(tick);
+	std::map<unsigned int, uint64_t>::iterator remote = netplay.remoteHashes.find(tick);
+
+	if (local == netplay.localHashes.end() || remote == netplay.remoteHashes.end())
+	{
+		return; // still waiting for one of them
+	}
+
+	if (local->second != remote->second && !netplay.desynced)
+	{
+		netplay.desynced = true;
+		netplay.desyncTick = tick;
+	}
+
+	netplay.localHashes.erase(local);
+	netplay.remoteHashes.erase(remote);
+}
+
+static void SendHashes(Netplay& netplay) // for the ticks that are final - every key before them is known and played
+{
+	unsigned int finalTick = netplay.remoteConfirmed < netplay.tick ? netplay.remoteConfirmed : netplay.tick;
+
+	while (netplay.nextHashTick <= finalTick)
+	{
+		unsigned int tick = netplay.nextHashTick;
+		netplay.nextHashTick += FPS;
+
+		if (netplay.tick - tick >= NETPLAY_SNAPSHOTS)
+		{
+			continue; // its snapshot is gone - cannot happen while ticks wait for remote keys
+		}
+
+		uint64_t hash = HashVersusSnapshot(netplay.snapshots[tick % NETPLAY_SNAPSHOTS]);
+		netplay.localHashes[tick] = hash;
+
+		std::string message;
+		message.push_back((char)NMT_HASH);
+		WriteUInt32(message, tick);
+		WriteUInt32(message, (unsigned int)hash);
+		WriteUInt32(message, (unsigned int)(hash >> 32));
+		QueueMessage(netplay, message);
+
+		CompareHashes(netplay, tick);
+	}
+}
+
+static void AdvanceNetplay(Netplay& netplay)
+{
+	RollBack(netplay);
+
+	if (netplay.matchOver)
+	{
+		return;
+	}
+
+	if (netplay.tick - netplay.remoteConfirmed >= (unsigned int)netplay.maxRollback)
+	{
+		netplay.numStalls++; // too far ahead to roll back - wait for the other side
+		return;
+	}
+
+	int key = NETPLAY_NO_KEY;
+
+	if (netplay.numQueuedKeys > 0)
+	{
+		key = netplay.queuedKeys[0];
+		netplay.numQueuedKeys--;
+		memmove(netplay.queuedKeys, netplay.queuedKeys + 1, netplay.numQueuedKeys * sizeof(int));
+	}
+
+	FindInput(netplay, netplay.tick).keys[netplay.side] = key;
+
+	std::string message;
+	message.push_back((char)NMT_INPUT);
+	WriteUInt32(message, netplay.tick);
+	WriteUInt16(message, key);
+	QueueMessage(netplay, message);
+
+	PlayTick(netplay, netplay.tick);
+	netplay.tick++;
+	netplay.rollbackTo = netplay.tick;
+
+	SendHashes(netplay);
+
+	if (netplay.games[0].game.currentState == GS_GAME_OVER && netplay.games[1].game.currentState == GS_GAME_OVER &&
+		netplay.remoteConfirmed >= netplay.tick)
+	{
+		netplay.matchOver = true; // and final - no remote key can change it now
+	}
+}
+
+static void HandleRemoteInput(Netplay& netplay, unsigned int tick, int key)
+{
+	if (tick + NETPLAY_INPUTS / 2 <= netplay.tick || tick >= netplay.tick + NETPLAY_INPUTS / 2)
+	{
+		return; // outside every window it could be in
+	}
+
+	NetplayInput& input = FindInput(netplay, tick);
+	input.keys[1 - netplay.side] = key;
+	input.remoteKnown = true;
+
+	if (tick < netplay.tick && key != NETPLAY_NO_KEY && tick < netplay.rollbackTo)
+	{
+		netplay.rollbackTo = tick; // played predicting no key - play it again from there
+	}
+
+	for (;;)
+	{
+		const NetplayInput& confirmed = netplay.inputs[netplay.remoteConfirmed % NETPLAY_INPUTS];
+
+		if (confirmed.tick != netplay.remoteConfirmed || !confirmed.remoteKnown)
+		{
+			break;
+		}
+
+		netplay.remoteConfirmed++;
+	}
+}
+
+static void ReceiveMessages(Netplay& netplay)
+{
+	char buffer[4 * 1024];
+
+	for (;;)
+	{
+		ssize_t numRead = recv(netplay.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			netplay.remoteGone = true;
+			break;
+		}
+
+		if (numRead < 0)
+		{
+			break;
+		}
+
+		netplay.received.append(buffer, numRead);
+	}
+
+	size_t offset = 0;
+
+	while (offset < netplay.received.size())
+	{
+		const unsigned char* message = (const unsigned char*)netplay.received.data() + offset;
+		int type = message[0];
+
+		if (type != NMT_INPUT && type != NMT_HASH)
+		{
+			netplay.remoteGone = true; // not a game this understands
+			break;
+		}
+
+		if (netplay.received.size() - offset < (size_t)NETPLAY_MESSAGE_SIZES[type])
+		{
+			break; // wait for the rest of it
+		}
+
+		unsigned int tick = ReadUInt32(message + 1);
+
+		if (type == NMT_INPUT)
+		{
+			HandleRemoteInput(netplay, tick, (int)ReadUInt16(message + 5));
+		}
+		else
+		{
+			netplay.remoteHashes[tick] = (uint64_t)ReadUInt32(message + 5) | ((uint64_t)ReadUInt32(message + 9) << 32);
+			CompareHashes(netplay, tick);
+		}
+
+		offset += NETPLAY_MESSAGE_SIZES[type];
+	}
+
+	netplay.received.erase(0, offset);
+}
+
+/* Drawing */
+
+static void DrawNetplay(Netplay& netplay)
+{
+	GameWorld& local = netplay.games[netplay.side];
+	const GameWorld& remote = netplay.games[1 - netplay.side];
+	int width = local.game.windowSize.width;
+	int height = local.game.windowSize.height;
+	char line[128];
+
+	ClearScreen();
+
+	if (local.game.currentState != GS_GAME_OVER)
+	{
+		DrawServerGame(local, netplay.table);
+	}
+	else if (!netplay.matchOver)
+	{
+		const char* waiting = netplay.remoteGone ? "GAME OVER! The other player has left" : "GAME OVER! Waiting for the other player";
+		DrawString(width / 2 - (int)strlen(waiting) / 2, height / 3, waiting);
+	}
+	else
+	{
+		const char* result = local.player.score > remote.player.score ? "YOU WIN!" : (local.player.score < remote.player.score ? "YOU LOSE!" : "IT'S A DRAW!");
+		DrawString(width / 2 - (int)strlen(result) / 2, height / 3, result);
+
+		snprintf(line, sizeof(line), "You: %i  Them: %i", local.player.score, remote.player.score);
+		DrawString(width / 2 - (int)strlen(line) / 2, height / 3 + 2, line);
+
+		const char* quit = "Press (q) to quit";
+		DrawString(width / 2 - (int)strlen(quit) / 2, height / 3 + 4, quit);
+	}
+
+	if (netplay.remoteGone)
+	{
+		snprintf(line, sizeof(line), "THEM: %i, LEFT", remote.player.score);
+	}
+	else
+	{
+		snprintf(line, sizeof(line), "THEM: %i, LIVES: %i", remote.player.score, remote.player.lives);
+	}
+	DrawString(width - (int)strlen(line) - 1, 0, line);
+
+	if (netplay.desynced)
+	{
+		snprintf(line, sizeof(line), "DESYNC AT TICK %u", netplay.desyncTick);
+		DrawString(width - (int)strlen(line) - 1, 1, line);
+	}
+
+	RefreshScreen();
+}
+
+/* Running */
+
+static bool ConnectPlayers(Netplay& netplay, const char* path, bool host, RawInput& keyboard) // the handshake - false if it did not happen
+{
+	int width = ScreenWidth();
+	int height = ScreenHeight();
+	unsigned char bytes[16];
+
+	if (!host)
+	{
+		netplay.socket = ConnectToGame(path);
+
+		if (netplay.socket < 0)
+		{
+			return false;
+		}
+
+		std::string hello;
+		hello.push_back((char)NMT_HELLO);
+		WriteUInt16(hello, width);
+		WriteUInt16(hello, height);
+
+		if (!SendAll(netplay.socket, hello.data(), hello.size()) || !ReceiveExactly(netplay.socket, bytes, NETPLAY_MESSAGE_SIZES[NMT_START]) || bytes[0] != NMT_START)
+		{
+			return false;
+		}
+
+		netplay.seed = ReadUInt32(bytes + 1);
+		netplay.games[0].game.windowSize.width = (int)ReadUInt16(bytes + 5);
+		netplay.games[0].game.windowSize.height = (int)ReadUInt16(bytes + 7);
+		return true;
+	}
+
+	int listenSocket = ListenOnGameSocket(path);
+
+	if (listenSocket < 0)
+	{
+		return false;
+	}
+
+	std::string waiting = std::string("Waiting for the other player on ") + path + " - (q) to give up";
+	ClearScreen();
+	DrawString(width / 2 - (int)waiting.size() / 2, height / 3, waiting);
+	RefreshScreen();
+
+	while (netplay.socket < 0)
+	{
+		if (ReadInputEvent(keyboard).key == 'q')
+		{
+			break;
+		}
+
+		pollfd pollInfo;
+		pollInfo.fd = listenSocket;
+		pollInfo.events = POLLIN;
+		pollInfo.revents = 0;
+
+		if (poll(&pollInfo, 1, 100) > 0)
+		{
+			netplay.socket = accept(listenSocket, nullptr, nullptr);
+		}
+	}
+
+	close(listenSocket);
+	unlink(path);
+
+	if (netplay.socket < 0 || !ReceiveExactly(netplay.socket, bytes, NETPLAY_MESSAGE_SIZES[NMT_HELLO]) || bytes[0] != NMT_HELLO)
+	{
+		return false;
+	}
+
+	int guestWidth = (int)ReadUInt16(bytes + 1);
+	int guestHeight = (int)ReadUInt16(bytes + 3);
+	netplay.seed = (unsigned int)rand();
+	netplay.games[0].game.windowSize.width = width < guestWidth ? width : guestWidth; // both games have to be laid out the same
+	netplay.games[0].game.windowSize.height = height < guestHeight ? height : guestHeight;
+
+	std::string start;
+	start.push_back((char)NMT_START);
+	WriteUInt32(start, netplay.seed);
+	WriteUInt16(start, netplay.games[0].game.windowSize.width);
+	WriteUInt16(start, netplay.games[0].game.windowSize.height);
+
+	return SendAll(netplay.socket, start.data(), start.size());
+}
+
+static void StartVersus(Netplay& netplay)
+{
+	int width = netplay.games[0].game.windowSize.width;
+	int height = netplay.games[0].game.windowSize.height;
+
+	for (int side = 0; side < NETPLAY_SIDES; side++)
+	{
+		StartServerGame(netplay.games[side], width, height, netplay.seed); // the same screen and the same luck for both
+		netplay.games[side].game.currentState = GS_PLAY;
+	}
+
+	netplay.table.fileName = nullptr;
+	netplay.table.service = nullptr;
+	netplay.tick = 0;
+	netplay.remoteConfirmed = 0;
+	netplay.rollbackTo = 0;
+	netplay.numQueuedKeys = 0;
+	netplay.nextHashTick = FPS;
+	netplay.desynced = false;
+	netplay.desyncTick = 0;
+	netplay.matchOver = false;
+
+	for (int i = 0; i < NETPLAY_INPUTS; i++)
+	{
+		netplay.inputs[i].tick = i + 1; // not the tick it would hold, so FindInput clears it
+		FindInput(netplay, i);
+	}
+
+	SaveVersusSnapshot(netplay, 0);
+}
+
+int RunNetplay(const char* path, bool host, int maxRollback, int delayMilliseconds, int jitterMilliseconds, bool rawInput)
+{
+	Netplay* netplayMemory = new Netplay(); // a few hundred KB of snapshots, too much for the stack
+	Netplay& netplay = *netplayMemory;
+
+	netplay.socket = -1;
+	netplay.side = host ? 0 : 1;
+	netplay.maxRollback = maxRollback < 1 ? 1 : (maxRollback > NETPLAY_MAX_ROLLBACK ? NETPLAY_MAX_ROLLBACK : maxRollback);
+	netplay.delayMilliseconds = delayMilliseconds;
+	netplay.jitterMilliseconds = jitterMilliseconds;
+	netplay.delayRandom = (unsigned int)rand();
+	netplay.remoteGone = false;
+	netplay.numRollbacks = 0;
+	netplay.numResimulatedTicks = 0;
+	netplay.deepestRollback = 0;
+	netplay.deepestRollbackMicroseconds = 0;
+	netplay.resimulationMicroseconds = 0;
+	netplay.numStalls = 0;
+
+	InitializeCurses(true);
+
+	RawInput keyboard;
+	InitRawInput(keyboard, rawInput);
+
+	if (!ConnectPlayers(netplay, path, host, keyboard))
+	{
+		ShutDownRawInput(keyboard);
+		ShutDownCurses();
+
+		if (netplay.socket >= 0)
+		{
+			close(netplay.socket);
+		}
+		delete netplayMemory;
+
+		fprintf(stderr, "No versus game was started\n");
+		return 1;
+	}
+
+	StartVersus(netplay);
+
+	const long long tickMicroseconds = 1000000 / FPS;
+	long long nextTick = InputClockMicroseconds() + tickMicroseconds;
+	bool quit = false;
+
+	while (!quit)
+	{
+		InputEvent event;
+
+		while ((event = ReadInputEvent(keyboard)).key != ERR)
+		{
+			if (event.key == 'q')
+			{
+				quit = true;
+			}
+			else if (netplay.numQueuedKeys < NETPLAY_MAX_QUEUED_KEYS)
+			{
+				netplay.queuedKeys[netplay.numQueuedKeys++] = event.key;
+			}
+		}
+
+		ReceiveMessages(netplay);
+
+		long long now = InputClockMicroseconds();
+		bool ticked = false;
+
+		for (int lagTicks = 0; now >= nextTick && lagTicks < NETPLAY_MAX_ROLLBACK; lagTicks++)
+		{
+			AdvanceNetplay(netplay);
+			nextTick += tickMicroseconds;
+			ticked = true;
+		}
+
+		if (now >= nextTick)
+		{
+			nextTick = now + tickMicroseconds; // too far behind to catch up
+		}
+
+		FlushMessages(netplay);
+
+		if (ticked)
+		{
+			DrawNetplay(netplay);
+		}
+
+		// sleep until the next tick, the next delayed message or something arrives
+		long long wakeTime = nextTick;
+
+		if (!netplay.outgoing.empty() && netplay.outgoing.front().sendTime < wakeTime)
+		{
+			wakeTime = netplay.outgoing.front().sendTime;
+		}
+
+		now = InputClockMicroseconds();
+		int timeout = wakeTime > now ? (int)((wakeTime - now + 999) / 1000) : 0;
+
+		pollfd pollInfo[2];
+		pollInfo[0].fd = netplay.socket;
+		pollInfo[0].events = netplay.remoteGone ? 0 : POLLIN;
+		pollInfo[0].revents = 0;
+		pollInfo[1].fd = STDIN_FILENO;
+		pollInfo[1].events = POLLIN;
+		pollInfo[1].revents = 0;
+
+		poll(pollInfo, keyboard.active ? 2 : 1, keyboard.active ? timeout : (timeout < 1000 / 60 ? timeout : 1000 / 60));
+	}
+
+	ShutDownRawInput(keyboard);
+	ShutDownCurses();
+	close(netplay.socket);
+
+	printf("Played %u ticks, waited %u for the other player\n", netplay.tick, netplay.numStalls);
+	printf("%u rollbacks played %u ticks again", netplay.numRollbacks, netplay.numResimulatedTicks);
+	if (netplay.numResimulatedTicks > 0)
+	{
+		printf(", %.1f us a tick - %lld us for %i ticks, of a %lld us frame", (double)netplay.resimulationMicroseconds / netplay.numResimulatedTicks,
+			netplay.resimulationMicroseconds * NETPLAY_DEFAULT_ROLLBACK / netplay.numResimulatedTicks, (int)NETPLAY_DEFAULT_ROLLBACK, tickMicroseconds);
+	}
+	printf("\nDeepest rollback %u ticks in %lld us\n", netplay.deepestRollback, netplay.deepestRollbackMicroseconds);
+
+	if (netplay.desynced)
+	{
+		printf("The games went out of sync at tick %u\n", netplay.desyncTick);
+	}
+
+	delete netplayMemory;
+
+	return 0;
+}
+
+#else
+
+int RunNetplay(const char*, bool, int, int, int, bool)
+{
+	fprintf(stderr, "Netplay is not supported on this platform\n");
+	return 1;
+}
+
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+#ifndef NETPLAY_H_
+#define NETPLAY_H_
+
+#include <deque>
+#include <map>
+#include <string>
+
+#include "GameSnapshot.h"
+#include "RawInput.h"
+
+/*
+Netplay:
+
+Two players head to head from two terminals: TextInvaders --versus-host [path] waits on a Unix domain socket and
+TextInvaders --versus-join [path] connects to it. Both play the same screen from the same seed, each sees their own game
+with the other's score and lives in the corner, and once both have lost their last life the higher score wins.
+
+Every instance runs both games. A tick is a pure function of the two games and the two players' keys for it - each game
+draws from its own GameRandom, seeded from the seed and saved with the rest of it - so both instances play out the same
+ticks identically. Keys are sent every tick, a key or none, and the local one is used straight away:
+
+- a tick whose remote key has not arrived is played predicting no key
+- both games are saved (GameSnapshot) after every tick, NETPLAY_SNAPSHOTS of them
+- when a remote key arrives for a tick that was played without it, both games go back to that tick's snapshot and the
+  ticks since are played again with what is known now - a rollback
+- an instance more than --rollback ticks (at most NETPLAY_MAX_ROLLBACK) ahead of the last remote key it has waits for it
+  instead of running further ahead
+- every FPS ticks, once both keys for it are in, each instance sends a hash of both games (HashGameState) and compares it
+  with the other's, so a desync shows up on screen instead of as two different games
+
+Messages, little endian, each starting with a uint8 NetplayMessageType:
+
+NMT_HELLO - uint16 width, uint16 height: the guest's terminal
+NMT_START - uint32 seed, uint16 width, uint16 height: from the host, the smaller of the two terminals - both start ticking
+NMT_INPUT - uint32 tick, uint16 key: 0 for none
+NMT_HASH - uint32 tick, uint64 hash: both games as they were before that tick
+
+For testing over a local socket --net-delay ms and --net-jitter ms hold back everything an instance sends by that long,
+give or take the jitter, without reordering it. On quitting, how many rollbacks there were and how long the longest
+re-simulation took are printed next to the length of a frame. Not available on Windows builds.
+*/
+
+enum
+{
+	NETPLAY_SIDES = 2, // the host is side 0
+	NETPLAY_MAX_ROLLBACK = 16,
+	NETPLAY_DEFAULT_ROLLBACK = 8,
+	NETPLAY_SNAPSHOTS = NETPLAY_MAX_ROLLBACK + 2,
+	NETPLAY_INPUTS = 64, // ticks of keys kept - more than can be in flight either way
+	NETPLAY_MAX_QUEUED_KEYS = 8, // local keys waiting for their tick, a key a tick
+	NETPLAY_NO_KEY = 0,
+};
+
+enum NetplayMessageType
+{
+	NMT_HELLO = 1,
+	NMT_START,
+	NMT_INPUT,
+	NMT_HASH
+};
+
+struct NetplayInput
+{
+	unsigned int tick; // which tick the slot holds
+	int keys[NETPLAY_SIDES];
+	bool remoteKnown;
+};
+
+struct VersusSnapshot
+{
+	GameSnapshot games[NETPLAY_SIDES];
+};
+
+struct DelayedMessage
+{
+	long long sendTime; // microseconds, InputClockMicroseconds' clock
+	std::string bytes;
+};
+
+struct Netplay
+{
+	int socket;
+	int side;
+	unsigned int seed;
+	int maxRollback;
+
+	GameWorld games[NETPLAY_SIDES];
+	HighScoreTable table; // in memory only, and never reached - a versus game ends before its name entry
+	unsigned int tick; // the next tick to play - the games are as they were before it
+	unsigned int remoteConfirmed; // every remote key before this tick has arrived
+	unsigned int rollbackTo; // the earliest tick played with a wrong prediction, tick if there is none
+	NetplayInput inputs[NETPLAY_INPUTS];
+	VersusSnapshot snapshots[NETPLAY_SNAPSHOTS]; // by tick - snapshots[t % NETPLAY_SNAPSHOTS] is before tick t
+	int queuedKeys[NETPLAY_MAX_QUEUED_KEYS];
+	int numQueuedKeys;
+
+	unsigned int nextHashTick;
+	std::map<unsigned int, uint64_t> localHashes; // by tick, until the other side's arrives
+	std::map<unsigned int, uint64_t> remoteHashes;
+	bool desynced;
+	unsigned int desyncTick;
+
+	std::string received; // bytes of a message that has not all arrived
+	std::deque<DelayedMessage> outgoing;
+	int delayMilliseconds;
+	int jitterMilliseconds;
+	unsigned int delayRandom; // its own generator, never the games'
+	bool remoteGone;
+	bool matchOver;
+
+	unsigned int numRollbacks;
+	unsigned int numResimulatedTicks;
+	unsigned int deepestRollback;
+	long long deepestRollbackMicroseconds;
+	long long resimulationMicroseconds;
+	unsigned int numStalls; // ticks spent waiting for remote keys
+};
+
+int RunNetplay(const char* path, bool host, int maxRollback, int delayMilliseconds, int jitterMilliseconds, bool rawInput);
+
+#endif // NETPLAY_H_
@@ -0,0 +1,79 @@
+
+#include "ProjectilePool.h"
+
+void InitProjectilePool(ProjectilePool& pool, int capacity)
+{
+	pool.projectiles.clear();
+	pool.projectiles.reserve(capacity);
+	pool.slots.resize(capacity);
+
+	ClearProjectilePool(pool);
+}
+
+void ClearProjectilePool(ProjectilePool& pool)
+{
+	int capacity = (int)pool.slots.size();
+
+	pool.projectiles.clear();
+
+	for (int slot = 0; slot < capacity; slot++)
+	{
+		pool.slots[slot] = slot + 1 < capacity ? slot + 1 : (int)NOT_IN_PLAY;
+	}
+
+	pool.firstFreeSlot = capacity > 0 ? 0 : (int)NOT_IN_PLAY;
+}
+
+int SpawnProjectile(ProjectilePool& pool, const Position& position)
+{
+	int slot = pool.firstFreeSlot;
+
+	if (slot == NOT_IN_PLAY)
+	{
+		return NOT_IN_PLAY;
+	}
+
+	pool.firstFreeSlot = pool.slots[slot];
+	pool.slots[slot] = (int)pool.projectiles.size();
+
+	Projectile projectile;
+	projectile.position = position;
+	projectile.y = position.y * FIXED_POINT_ONE;
+	projectile.animation = 0;
+	projectile.slot = slot;
+	pool.projectiles.push_back(projectile); // never grows past the capacity reserved in InitProjectilePool
+
+	return slot;
+}
+
+void RemoveProjectile(ProjectilePool& pool, int index)
+{
+	int slot = pool.projectiles[index].slot;
+
+	pool.projectiles[index] = pool.projectiles.back();
+	pool.slots[pool.projectiles[index].slot] = index;
+	pool.projectiles.pop_back();
+
+	pool.slots[slot] = pool.firstFreeSlot;
+	pool.firstFreeSlot = slot;
+}
+
+Projectile* FindProjectile(ProjectilePool& pool, int slot)
+{
+	int index = pool.slots[slot];
+
+	// a free slot holds the next free slot instead, which is never the index of a projectile with this slot
+	if (index == NOT_IN_PLAY || index >= (int)pool.projectiles.size() || pool.projectiles[index].slot != slot)
+	{
+		return nullptr;
+	}
+
+	return &pool.projectiles[index];
+}
+
+int FixedPointToCell(int value)
+{
+	int shifted = value + FIXED_POINT_ONE / 2;
+	int cell = shifted / FIXED_POINT_ONE;
+	return (shifted % FIXED_POINT_ONE != 0 && shifted < 0) ? cell - 1 : cell; // towards minus infinity, a missile can go off the top
+}
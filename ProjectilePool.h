@@ -0,0 +1,53 @@
+#pragma once
+#ifndef PROJECTILEPOOL_H_
+#define PROJECTILEPOOL_H_
+
+#include <vector>
+
+#include "TextInvaders.h"
+
+/*
+Projectile Pool:
+
+Missiles and bombs for the stress game (StressSwarm.h), where there can be hundreds of them in flight (TextInvaders
+--bullet-hell).
+
+The projectiles in play are kept packed at the front of one array, so a tick walks them without skipping empty slots.
+Removing one moves the last projectile into its place. Each projectile also has a handle - its slot - that stays the same
+while it is in play however often it is moved; free slots are a linked list, so spawning and removing never search and
+never allocate once the pool is made.
+
+The classic game keeps its few bombs in the swarm's fixed slots: which slot a bomb is in decides the order they fall in,
+and that order is part of every snapshot, state hash and replay.
+*/
+
+enum
+{
+	FIXED_POINT_SHIFT = 8,
+	FIXED_POINT_ONE = 1 << FIXED_POINT_SHIFT, // one cell
+};
+
+struct Projectile
+{
+	Position position; // the cell it is in
+	int y; // fixed point height, position.y is this rounded
+	int animation;
+	int slot; // handle of this projectile
+};
+
+struct ProjectilePool
+{
+	std::vector<Projectile> projectiles; // the ones in play, in no particular order
+	std::vector<int> slots; // index in projectiles of each slot in use, or the next free slot - NOT_IN_PLAY ends the list
+	int firstFreeSlot;
+};
+
+void InitProjectilePool(ProjectilePool& pool, int capacity);
+void ClearProjectilePool(ProjectilePool& pool);
+int SpawnProjectile(ProjectilePool& pool, const Position& position); // returns the new projectile's slot, NOT_IN_PLAY if the pool is full
+void RemoveProjectile(ProjectilePool& pool, int index); // index in projectiles - the last projectile is moved there, so look at that index again
+Projectile* FindProjectile(ProjectilePool& pool, int slot); // nullptr once the projectile has been removed
+
+int FixedPointToCell(int value); // rounded to the nearest cell, halves round down the screen
+
+#endif // PROJECTILEPOOL_H_
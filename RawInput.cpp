@@ -0,0 +1,259 @@
+
+#include <ctime>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "RawInput.h"
+#include "CursesUtils.h"
+
+static void PushInputEvent(RawInput& input, int key, long long microseconds)
+{
+	if (input.numEvents == RAW_INPUT_MAX_EVENTS)
+	{
+		return; // the game has fallen far behind the keyboard
+	}
+
+	InputEvent& event = input.events[(input.firstEvent + input.numEvents) % RAW_INPUT_MAX_EVENTS];
+	event.key = key;
+	event.microseconds = microseconds;
+	input.numEvents++;
+}
+
+static void DecodeInputByte(RawInput& input, unsigned char byte, long long microseconds)
+{
+	const unsigned char ESCAPE = 0x1b;
+
+	switch (input.state)
+	{
+	case RIS_GROUND:
+		if (byte == ESCAPE)
+		{
+			input.state = RIS_ESCAPE;
+		}
+		else
+		{
+			PushInputEvent(input, byte, microseconds);
+		}
+		break;
+	case RIS_ESCAPE:
+		if (byte == '[' || byte == 'O')
+		{
+			input.state = RIS_SEQUENCE;
+		}
+		else
+		{
+			PushInputEvent(input, ESCAPE, microseconds);
+			input.state = RIS_GROUND;
+			DecodeInputByte(input, byte, microseconds); // could be another ESC
+		}
+		break;
+	case RIS_SEQUENCE:
+		if (byte >= 0x40 && byte <= 0x7e) // the final byte - parameters and intermediates come before it
+		{
+			switch (byte)
+			{
+			case 'A':
+				PushInputEvent(input, AK_UP, microseconds);
+				break;
+			case 'B':
+				PushInputEvent(input, AK_DOWN, microseconds);
+				break;
+			case 'C':
+				PushInputEvent(input, AK_RIGHT, microseconds);
+				break;
+			case 'D':
+				PushInputEvent(input, AK_LEFT, microseconds);
+				break;
+			}
+
+			input.state = RIS_GROUND;
+		}
+		break;
+	}
+}
+
+void DecodeInputBytes(RawInput& input, const unsigned char* bytes, int numBytes, long long microseconds)
+{
+	for (int i = 0; i < numBytes; i++)
+	{
+		DecodeInputByte(input, bytes[i], microseconds);
+	}
+}
+
+int EncodeInputKey(int key, char* bytes)
+{
+	const char ARROW_FINAL_BYTES[] = { 'A', 'B', 'C', 'D' };
+	const int ARROW_KEYS[] = { AK_UP, AK_DOWN, AK_RIGHT, AK_LEFT };
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (key == ARROW_KEYS[i])
+		{
+			bytes[0] = 0x1b;
+			bytes[1] = '[';
+			bytes[2] = ARROW_FINAL_BYTES[i];
+			return 3;
+		}
+	}
+
+	if (key < 0 || key > 0xff)
+	{
+		return 0;
+	}
+
+	bytes[0] = (char)key;
+	return 1;
+}
+
+bool TakeInputEvent(RawInput& input, InputEvent& event)
+{
+	if (input.numEvents == 0)
+	{
+		return false;
+	}
+
+	event = input.events[input.firstEvent];
+	input.firstEvent = (input.firstEvent + 1) % RAW_INPUT_MAX_EVENTS;
+	input.numEvents--;
+
+	return true;
+}
+
+#ifndef _WIN32
+
+long long InputClockMicroseconds()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+bool InitRawInput(RawInput& input, bool enable)
+{
+	input.active = false;
+	input.state = RIS_GROUND;
+	input.firstEvent = 0;
+	input.numEvents = 0;
+
+	if (!enable || !isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &input.savedSettings) != 0)
+	{
+		return false;
+	}
+
+	termios settings = input.savedSettings;
+	settings.c_lflag &= ~(ICANON | ECHO); // signals stay on, ^C still quits
+	settings.c_cc[VMIN] = 0; // read returns straight away, with whatever has arrived - stdin's own flags, which it shares
+	settings.c_cc[VTIME] = 0; // with the shell and stdout, are left alone
+
+	if (tcsetattr(STDIN_FILENO, TCSANOW, &settings) != 0)
+	{
+		return false;
+	}
+
+	input.active = true;
+	return true;
+}
+
+int ReadTerminalBytes(RawInput& input, unsigned char* bytes, int maxBytes)
+{
+	if (!input.active)
+	{
+		return 0;
+	}
+
+	for (;;)
+	{
+		ssize_t numRead = read(STDIN_FILENO, bytes, maxBytes);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		return numRead > 0 ? (int)numRead : 0; // 0 - nothing more has arrived
+	}
+}
+
+static void ReadRawInput(RawInput& input)
+{
+	unsigned char bytes[RAW_INPUT_READ_SIZE];
+	int numRead;
+
+	while ((numRead = ReadTerminalBytes(input, bytes, sizeof(bytes))) > 0)
+	{
+		DecodeInputBytes(input, bytes, numRead, InputClockMicroseconds());
+
+		if (numRead < (int)sizeof(bytes))
+		{
+			return;
+		}
+	}
+}
+
+void ShutDownRawInput(RawInput& input)
+{
+	if (input.active)
+	{
+		tcsetattr(STDIN_FILENO, TCSANOW, &input.savedSettings);
+		input.active = false;
+	}
+}
+
+#else
+
+long long InputClockMicroseconds()
+{
+	return (long long)clock() * 1000000 / CLOCKS_PER_SEC;
+}
+
+bool InitRawInput(RawInput& input, bool)
+{
+	input.active = false;
+	input.state = RIS_GROUND;
+	input.firstEvent = 0;
+	input.numEvents = 0;
+	return false;
+}
+
+int ReadTerminalBytes(RawInput&, unsigned char*, int)
+{
+	return 0;
+}
+
+static void ReadRawInput(RawInput&)
+{
+}
+
+void ShutDownRawInput(RawInput&)
+{
+}
+
+#endif
+
+InputEvent ReadInputEvent(RawInput& input)
+{
+	InputEvent event;
+
+	if (!input.active)
+	{
+		event.key = GetChar();
+		event.microseconds = InputClockMicroseconds();
+		return event;
+	}
+
+	if (input.numEvents == 0)
+	{
+		ReadRawInput(input);
+	}
+
+	if (!TakeInputEvent(input, event))
+	{
+		event.key = ERR;
+		event.microseconds = InputClockMicroseconds();
+	}
+
+	return event;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#ifndef RAWINPUT_H_
+#define RAWINPUT_H_
+
+#ifndef _WIN32
+#include <termios.h>
+#endif
+
+/*
+Raw Input:
+
+Reads the keyboard straight from the terminal instead of through curses. With keypad on, getch has to wait ESCDELAY
+after an escape byte before it knows whether an arrow key is coming, so every arrow press reached the game late. Here
+stdin is out of canonical mode with VMIN and VTIME at 0, so a read never waits and takes every byte that has arrived in
+one batch, and a small state machine turns them into keys:
+
+- ESC [ A..D and ESC O A..D become AK_UP, AK_DOWN, AK_RIGHT and AK_LEFT as soon as their last byte is in
+- any other ESC [ or ESC O sequence (function keys, modifiers) is read to its final byte and dropped
+- an ESC followed by anything else is handed on as ESC and then that byte, so a lone ESC waits for the next key instead
+  of a timeout - the game has no use for it
+- everything else is a key of its own
+
+Each key is an InputEvent stamped with the time its bytes were read. Curses still draws the screen, it is just never
+asked for a key. TextInvaders --curses-input goes back to GetChar, as do Windows builds and a stdin that is not a
+terminal.
+*/
+
+enum
+{
+	RAW_INPUT_READ_SIZE = 64, // bytes per read()
+	RAW_INPUT_MAX_EVENTS = 256, // keys decoded and not yet taken - any more from one batch are dropped
+	RAW_INPUT_MAX_KEY_BYTES = 3, // ESC [ A
+};
+
+enum RawInputState
+{
+	RIS_GROUND = 0,
+	RIS_ESCAPE, // after ESC
+	RIS_SEQUENCE // after ESC [ or ESC O, until the final byte
+};
+
+struct InputEvent
+{
+	int key; // a character or an ArrowKeys value, ERR if no key has arrived
+	long long microseconds; // when it was read, on InputClockMicroseconds' clock
+};
+
+struct RawInput
+{
+	bool active; // false - keys come from GetChar
+	RawInputState state;
+	InputEvent events[RAW_INPUT_MAX_EVENTS]; // a ring, oldest at firstEvent
+	int firstEvent;
+	int numEvents;
+#ifndef _WIN32
+	termios savedSettings; // the terminal as curses set it up
+#endif
+};
+
+bool InitRawInput(RawInput& input, bool enable); // after InitializeCurses - returns false if keys will come from GetChar instead
+InputEvent ReadInputEvent(RawInput& input); // the oldest key not yet taken, reading the terminal if there is none
+void ShutDownRawInput(RawInput& input); // before ShutDownCurses
+long long InputClockMicroseconds(); // a monotonic clock
+
+void DecodeInputBytes(RawInput& input, const unsigned char* bytes, int numBytes, long long microseconds); // keys that came from somewhere else - a game server's player sockets
+int EncodeInputKey(int key, char* bytes); // the other way - the bytes a terminal sends for a key, at most RAW_INPUT_MAX_KEY_BYTES of them, 0 for a key it has none for
+bool TakeInputEvent(RawInput& input, InputEvent& event); // the oldest decoded key without reading the terminal, false if there is none
+int ReadTerminalBytes(RawInput& input, unsigned char* bytes, int maxBytes); // what has arrived on stdin, undecoded - 0 if nothing has or input is not active
+
+#endif // RAWINPUT_H_
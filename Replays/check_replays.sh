@@ -0,0 +1,44 @@
+#!/bin/sh
+# Replays every reference game here with --hash-log and compares the log, tick by tick, with the one it is expected to
+# match (TextInvaders --compare-hash-logs). A change that should not change how the game plays has to pass this.
+#
+# usage: Replays/check_replays.sh [path to TextInvaders] [update]
+#
+# update writes the expected logs from this build instead, for a change that is meant to change the game or the
+# snapshot layout. The logs hold the raw GameSnapshot bytes, so they only compare with builds of the same layout - the
+# ones here are from a 64 bit Linux build (g++ -std=c++14 -O2 *.cpp -lncurses).
+
+game=${1:-./TextInvaders}
+dir=$(dirname "$0")
+work=${TMPDIR:-/tmp}/check_replays.$$
+status=0
+
+mkdir -p "$work" || exit 2
+
+while read name variant tickRate
+do
+	if ! "$game" --replay "$dir/$name.tii" --variant "$variant" --tick-rate "$tickRate" --hash-log "$work/$name.thl" > /dev/null
+	then
+		echo "$name: could not replay $dir/$name.tii"
+		status=1
+		continue
+	fi
+
+	if [ "$2" = update ]
+	then
+		gzip -9 -n -c "$work/$name.thl" > "$dir/$name.thl.gz"
+		echo "$name: updated"
+		continue
+	fi
+
+	gzip -d -c "$dir/$name.thl.gz" > "$work/$name.expected.thl"
+	printf '%s: ' "$name"
+	"$game" --compare-hash-logs "$work/$name.expected.thl" "$work/$name.thl" || status=1
+done <<GAMES
+classic classic 20
+classic240 classic 240
+wide wide 20
+GAMES
+
+rm -rf "$work"
+exit $status
@@ -0,0 +1,66 @@
+
+#include "RewindBuffer.h"
+#include "FrameDelta.h"
+
+template<class Config>
+void ClearRewindBuffer(RewindBufferT<Config>& buffer)
+{
+	buffer.hasLatest = false;
+	buffer.deltas.clear();
+	buffer.numDeltaBytes = 0;
+}
+
+template<class Config>
+void RecordRewindTick(RewindBufferT<Config>& buffer, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo)
+{
+	SaveGameSnapshot(buffer.current, game, player, shields, numberOfShields, aliens, ufo);
+
+	if (buffer.hasLatest)
+	{
+		std::string delta;
+		EncodeFrameDelta((const char*)&buffer.current, (const char*)&buffer.latest, sizeof(GameSnapshotT<Config>), delta); // takes the new tick back to the old one
+
+		buffer.numDeltaBytes += delta.size();
+		buffer.deltas.push_back(delta);
+
+		while (buffer.deltas.size() > REWIND_MAX_TICKS || buffer.numDeltaBytes > REWIND_MAX_BYTES)
+		{
+			buffer.numDeltaBytes -= buffer.deltas.front().size();
+			buffer.deltas.pop_front();
+		}
+	}
+
+	buffer.latest = buffer.current;
+	buffer.hasLatest = true;
+}
+
+template<class Config>
+bool Rewind(RewindBufferT<Config>& buffer, int numTicks, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens, AlienUFO& ufo)
+{
+	if (!buffer.hasLatest || buffer.deltas.empty())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < numTicks && !buffer.deltas.empty(); i++)
+	{
+		const std::string& delta = buffer.deltas.back();
+
+		ApplyFrameDelta((const unsigned char*)delta.data(), delta.size(), (char*)&buffer.latest, sizeof(GameSnapshotT<Config>));
+
+		buffer.numDeltaBytes -= delta.size();
+		buffer.deltas.pop_back();
+	}
+
+	LoadGameSnapshot(buffer.latest, game, player, shields, numberOfShields, aliens, ufo);
+	return true;
+}
+
+/* The configs in GAME_VARIANTS */
+
+template void ClearRewindBuffer(RewindBufferT<ClassicConfig>&);
+template void RecordRewindTick(RewindBufferT<ClassicConfig>&, const Game&, const Player&, const Shield[], int, const AlienSwarmT<ClassicConfig>&, const AlienUFO&);
+template bool Rewind(RewindBufferT<ClassicConfig>&, int, Game&, Player&, Shield[], int, AlienSwarmT<ClassicConfig>&, AlienUFO&);
+template void ClearRewindBuffer(RewindBufferT<WideConfig>&);
+template void RecordRewindTick(RewindBufferT<WideConfig>&, const Game&, const Player&, const Shield[], int, const AlienSwarmT<WideConfig>&, const AlienUFO&);
+template bool Rewind(RewindBufferT<WideConfig>&, int, Game&, Player&, Shield[], int, AlienSwarmT<WideConfig>&, AlienUFO&);
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef REWINDBUFFER_H_
+#define REWINDBUFFER_H_
+
+#include <deque>
+#include <string>
+
+#include "GameSnapshot.h"
+
+/*
+Rewind Buffer:
+
+Practice mode (TextInvaders --practice) keeps the last REWIND_MAX_TICKS ticks of play so the player can press 'r' to go
+back REWIND_STEP_TICKS at a time - including right after being hit, to see what went wrong.
+
+Only the newest snapshot is kept whole. Every older tick is a backward delta (FrameDelta runs over the snapshot bytes)
+that turns the snapshot after it into the one before it. Most ticks change a handful of bytes, so 600 ticks are a few
+tens of KB. Rewinding applies the deltas newest first, and dropping the oldest tick is just dropping its delta.
+*/
+
+enum
+{
+	REWIND_MAX_TICKS = 30 * FPS,
+	REWIND_MAX_BYTES = 1024 * 1024,
+	REWIND_STEP_TICKS = FPS, // one second per press
+};
+
+template<class Config>
+struct RewindBufferT
+{
+	GameSnapshotT<Config> latest;
+	GameSnapshotT<Config> current;
+	bool hasLatest;
+	std::deque<std::string> deltas; // oldest first
+	size_t numDeltaBytes;
+};
+
+typedef RewindBufferT<ClassicConfig> RewindBuffer;
+
+template<class Config>
+void ClearRewindBuffer(RewindBufferT<Config>& buffer);
+template<class Config>
+void RecordRewindTick(RewindBufferT<Config>& buffer, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo);
+template<class Config>
+bool Rewind(RewindBufferT<Config>& buffer, int numTicks, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens, AlienUFO& ufo); // returns false if there is nothing to rewind to
+
+#endif // REWINDBUFFER_H_
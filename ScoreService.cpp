@@ -0,0 +1,1091 @@
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "ScoreService.h"
+#include "SpectatorBroadcast.h"
+#include "FrameDelta.h"
+#include "RawInput.h"
+
+#ifndef _WIN32
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL | MSG_DONTWAIT; // either end going away should not kill the other with SIGPIPE
+#else
+static const int SEND_FLAGS = MSG_DONTWAIT;
+#endif
+
+static const int SCORE_ENTRY_HEADER_SIZE = 5; // uint32 score, uint8 name length
+static const int SCORE_SUBMIT_HEADER_SIZE = 3;
+static const int SCORE_TOP_HEADER_SIZE = 6;
+
+static volatile sig_atomic_t stopService = 0;
+
+static void StopService(int)
+{
+	stopService = 1;
+}
+
+static bool SetNonBlocking(int socket)
+{
+	int flags = fcntl(socket, F_GETFL, 0);
+	return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void WriteScoreEntry(std::string& message, int score, const std::string& name)
+{
+	size_t nameLength = name.size() < SCORE_MAX_NAME_LENGTH ? name.size() : (size_t)SCORE_MAX_NAME_LENGTH;
+
+	WriteUInt32(message, (unsigned int)score);
+	message.push_back((char)nameLength);
+	message.append(name, 0, nameLength);
+}
+
+static int FindMessageLength(const unsigned char* bytes, size_t numBytes, size_t headerSize, size_t numEntries) // 0 until it has all arrived
+{
+	size_t length = headerSize;
+
+	for (size_t i = 0; i < numEntries; i++)
+	{
+		if (numBytes < length + SCORE_ENTRY_HEADER_SIZE)
+		{
+			return 0;
+		}
+
+		length += SCORE_ENTRY_HEADER_SIZE + bytes[length + 4];
+	}
+
+	return numBytes >= length ? (int)length : 0;
+}
+
+/* The service */
+
+static bool InsertTopScore(std::vector<Score>& top, int score, const std::string& name) // false if it is not good enough
+{
+	if (top.size() >= MAX_HIGH_SCORES && score <= top.back().score)
+	{
+		return false;
+	}
+
+	Score entry;
+	entry.score = score;
+	entry.name = name;
+
+	std::vector<Score>::iterator position = std::upper_bound(top.begin(), top.end(), entry,
+		[](const Score& score1, const Score& score2) { return score1.score > score2.score; }); // after the equal scores already in
+
+	top.insert(position, entry);
+
+	if (top.size() > MAX_HIGH_SCORES)
+	{
+		top.pop_back();
+	}
+
+	return true;
+}
+
+static bool IsLoggableName(const std::string& name) // one word of printable characters, so the log reads back
+{
+	if (name.empty() || name.size() > SCORE_MAX_NAME_LENGTH)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < name.size(); i++)
+	{
+		if (!isgraph((unsigned char)name[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void LogScore(ScoreService& service, int score, const std::string& name)
+{
+	if (!IsLoggableName(name))
+	{
+		service.numRejected++;
+		return;
+	}
+
+	char scoreText[16];
+	snprintf(scoreText, sizeof(scoreText), " %d\n", score);
+
+	service.pendingLog += name;
+	service.pendingLog += scoreText;
+	service.numScores++;
+
+	service.topChanged = InsertTopScore(service.top, score, name) || service.topChanged;
+}
+
+static bool ReadScoreFile(ScoreService& service, const char* fileName, bool relog) // relog to copy what it reads into the log
+{
+	FILE* file = fopen(fileName, "r");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	char name[SCORE_MAX_NAME_LENGTH + 1];
+	int score;
+
+	while (fscanf(file, "%32s %d", name, &score) == 2)
+	{
+		if (relog)
+		{
+			LogScore(service, score, name);
+		}
+		else
+		{
+			service.numScores++;
+			InsertTopScore(service.top, score, name);
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+static int TakeInHighScoreFile(ScoreService& service) // the scores in the file that would be in the table but are not - saved while there was no service
+{
+	FILE* file = fopen(FILE_NAME, "r");
+
+	if (file == nullptr)
+	{
+		return 0;
+	}
+
+	std::vector<Score> unmatched = service.top;
+	char name[SCORE_MAX_NAME_LENGTH + 1];
+	int score;
+	int numTakenIn = 0;
+
+	while (fscanf(file, "%32s %d", name, &score) == 2)
+	{
+		std::vector<Score>::iterator match = unmatched.begin();
+
+		while (match != unmatched.end() && (match->score != score || match->name != name))
+		{
+			++match;
+		}
+
+		if (match != unmatched.end())
+		{
+			unmatched.erase(match); // already logged
+		}
+		else if (service.top.size() < MAX_HIGH_SCORES || score > service.top.back().score)
+		{
+			LogScore(service, score, name);
+			numTakenIn++;
+		}
+	}
+
+	fclose(file);
+	return numTakenIn;
+}
+
+static void SaveTopScores(ScoreService& service) // what an instance that finds no service reads
+{
+	std::string fileName = std::string(FILE_NAME) + ".tmp";
+	FILE* file = fopen(fileName.c_str(), "w");
+
+	if (file == nullptr)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < service.top.size(); i++)
+	{
+		fprintf(file, "%s %d\n", service.top[i].name.c_str(), service.top[i].score);
+	}
+
+	if (fclose(file) == 0 && rename(fileName.c_str(), FILE_NAME) == 0) // never half a table
+	{
+		service.topChanged = false;
+	}
+}
+
+static void WriteLog(ScoreService& service)
+{
+	size_t offset = 0;
+
+	while (offset < service.pendingLog.size())
+	{
+		ssize_t numWritten = write(service.logFile, service.pendingLog.data() + offset, service.pendingLog.size() - offset);
+
+		if (numWritten < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numWritten <= 0)
+		{
+			fprintf(stderr, "Could not write the score log, %u bytes of scores are lost\n", (unsigned int)(service.pendingLog.size() - offset));
+			break;
+		}
+
+		offset += numWritten;
+	}
+
+	service.unsynced = service.unsynced || offset > 0;
+	service.pendingLog.clear();
+}
+
+static void SyncLog(ScoreService& service, long long now)
+{
+	if (service.unsynced && now - service.lastSyncTime >= SCORE_SYNC_INTERVAL * 1000LL)
+	{
+		fsync(service.logFile);
+		service.unsynced = false;
+		service.lastSyncTime = now;
+		service.numSyncs++;
+
+		if (service.topChanged)
+		{
+			SaveTopScores(service);
+		}
+	}
+}
+
+static void BuildTopMessage(const ScoreService& service, std::string& message)
+{
+	message.push_back((char)SSM_TOP);
+	WriteUInt32(message, service.numScores);
+	message.push_back((char)service.top.size());
+
+	for (size_t i = 0; i < service.top.size(); i++)
+	{
+		WriteScoreEntry(message, service.top[i].score, service.top[i].name);
+	}
+}
+
+static void WatchForWrites(ScoreService& service, ScoreConnection& connection, bool watch)
+{
+	if (connection.waitingToWrite == watch)
+	{
+		return;
+	}
+
+	epoll_event event;
+	event.events = (uint32_t)EPOLLIN | (watch ? (uint32_t)EPOLLOUT : 0u);
+	event.data.ptr = &connection;
+	epoll_ctl(service.epollHandle, EPOLL_CTL_MOD, connection.socket, &event);
+	connection.waitingToWrite = watch;
+}
+
+static bool FlushConnection(ScoreService& service, ScoreConnection& connection) // false if it has gone
+{
+	while (connection.sentBytes < connection.outgoing.size())
+	{
+		ssize_t numSent = send(connection.socket, connection.outgoing.data() + connection.sentBytes, connection.outgoing.size() - connection.sentBytes, SEND_FLAGS);
+
+		if (numSent < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			WatchForWrites(service, connection, true);
+			return true;
+		}
+
+		if (numSent <= 0)
+		{
+			return false;
+		}
+
+		connection.sentBytes += numSent;
+	}
+
+	connection.outgoing.clear();
+	connection.sentBytes = 0;
+
+	if (connection.wantsTop)
+	{
+		connection.wantsTop = false;
+		BuildTopMessage(service, connection.outgoing);
+		return FlushConnection(service, connection);
+	}
+
+	WatchForWrites(service, connection, false);
+
+	return true;
+}
+
+static bool HandleScoreMessages(ScoreService& service, ScoreConnection& connection) // false if the instance sent something it should not have
+{
+	size_t offset = 0;
+
+	while (offset < connection.received.size())
+	{
+		const unsigned char* message = (const unsigned char*)connection.received.data() + offset;
+		size_t numBytes = connection.received.size() - offset;
+
+		if (message[0] == SSM_GET_TOP)
+		{
+			if (connection.outgoing.size() - connection.sentBytes < SCORE_MAX_REPLY_BYTES)
+			{
+				BuildTopMessage(service, connection.outgoing);
+			}
+			else
+			{
+				connection.wantsTop = true; // sent once the replies before it have gone, with the table as it is then
+			}
+
+			offset++;
+			continue;
+		}
+
+		if (message[0] != SSM_SUBMIT)
+		{
+			return false;
+		}
+
+		if (numBytes < SCORE_SUBMIT_HEADER_SIZE)
+		{
+			break;
+		}
+
+		int numEntries = (int)ReadUInt16(message + 1);
+		int length = FindMessageLength(message, numBytes, SCORE_SUBMIT_HEADER_SIZE, numEntries);
+
+		if (length == 0)
+		{
+			break; // wait for the rest of it
+		}
+
+		const unsigned char* entry = message + SCORE_SUBMIT_HEADER_SIZE;
+
+		for (int i = 0; i < numEntries; i++)
+		{
+			int score = (int)ReadUInt32(entry);
+			int nameLength = entry[4];
+			LogScore(service, score, std::string((const char*)entry + SCORE_ENTRY_HEADER_SIZE, nameLength));
+			entry += SCORE_ENTRY_HEADER_SIZE + nameLength;
+		}
+
+		service.numSubmitted += numEntries;
+		service.numBatches++;
+		offset += length;
+	}
+
+	connection.received.erase(0, offset);
+
+	return true;
+}
+
+static bool ReadConnection(ScoreService& service, ScoreConnection& connection) // false if it has gone
+{
+	char buffer[64 * 1024];
+
+	for (;;)
+	{
+		ssize_t numRead = recv(connection.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			return false; // and a message it was part way through sending is dropped - it sends it again whole
+		}
+
+		if (numRead < 0)
+		{
+			return true;
+		}
+
+		connection.received.append(buffer, numRead);
+
+		if (!HandleScoreMessages(service, connection))
+		{
+			return false;
+		}
+	}
+}
+
+static void CloseConnection(ScoreService& service, ScoreConnection* connection)
+{
+	close(connection->socket); // which takes it out of the epoll set
+	service.connections.erase(std::find(service.connections.begin(), service.connections.end(), connection));
+	delete connection;
+}
+
+static void AcceptConnections(ScoreService& service)
+{
+	for (;;)
+	{
+		int socket = accept(service.listenSocket, nullptr, nullptr);
+
+		if (socket < 0)
+		{
+			return;
+		}
+
+		if (service.connections.size() >= SCORE_MAX_CONNECTIONS || !SetNonBlocking(socket))
+		{
+			close(socket);
+			continue;
+		}
+
+		ScoreConnection* connection = new ScoreConnection();
+		connection->socket = socket;
+		connection->sentBytes = 0;
+		connection->waitingToWrite = false;
+		connection->wantsTop = false;
+
+		epoll_event event;
+		event.events = EPOLLIN;
+		event.data.ptr = connection;
+
+		if (epoll_ctl(service.epollHandle, EPOLL_CTL_ADD, socket, &event) != 0)
+		{
+			close(socket);
+			delete connection;
+			continue;
+		}
+
+		service.connections.push_back(connection);
+	}
+}
+
+int RunScoreService(const char* path, const char* logFileName)
+{
+	ScoreService service;
+	service.lastSyncTime = 0;
+	service.unsynced = false;
+	service.topChanged = false;
+	service.numScores = 0;
+	service.numSubmitted = 0;
+	service.numBatches = 0;
+	service.numRejected = 0;
+	service.numSyncs = 0;
+
+	service.listenSocket = ListenOnGameSocket(path); // first, so a second service on the path leaves the log alone
+	service.epollHandle = epoll_create1(0);
+	service.logFile = -1;
+
+	epoll_event listenEvent;
+	listenEvent.events = EPOLLIN;
+	listenEvent.data.ptr = nullptr;
+
+	bool listening = service.listenSocket >= 0 && service.epollHandle >= 0 && epoll_ctl(service.epollHandle, EPOLL_CTL_ADD, service.listenSocket, &listenEvent) == 0;
+
+	int numTakenIn = 0;
+
+	if (listening)
+	{
+		if (!ReadScoreFile(service, logFileName, false))
+		{
+			ReadScoreFile(service, FILE_NAME, true); // the scores from before there was a service
+		}
+		else
+		{
+			numTakenIn = TakeInHighScoreFile(service);
+		}
+
+		service.logFile = open(logFileName, O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+		if (service.logFile < 0)
+		{
+			fprintf(stderr, "Could not open the score log %s\n", logFileName);
+		}
+	}
+
+	if (!listening || service.logFile < 0)
+	{
+		if (service.listenSocket >= 0)
+		{
+			close(service.listenSocket);
+			unlink(path);
+		}
+		if (service.epollHandle >= 0)
+		{
+			close(service.epollHandle);
+		}
+		return 1;
+	}
+
+	WriteLog(service);
+
+	signal(SIGINT, StopService);
+	signal(SIGTERM, StopService);
+	signal(SIGPIPE, SIG_IGN);
+
+	printf("Score service on %s, %u scores in %s\n", path, service.numScores, logFileName);
+
+	if (numTakenIn > 0)
+	{
+		printf("Took in %i scores saved in %s while there was no service\n", numTakenIn, FILE_NAME);
+	}
+	fflush(stdout);
+
+	const int MAX_EVENTS = 256;
+	epoll_event events[MAX_EVENTS];
+
+	while (!stopService)
+	{
+		long long now = InputClockMicroseconds();
+		long long syncTime = service.lastSyncTime + SCORE_SYNC_INTERVAL * 1000LL;
+		int timeout = !service.unsynced ? -1 : (syncTime > now ? (int)((syncTime - now + 999) / 1000) : 0);
+
+		int numEvents = epoll_wait(service.epollHandle, events, MAX_EVENTS, timeout);
+
+		for (int i = 0; i < numEvents; i++)
+		{
+			ScoreConnection* connection = (ScoreConnection*)events[i].data.ptr;
+
+			if (connection == nullptr)
+			{
+				AcceptConnections(service);
+				continue;
+			}
+
+			bool open = true;
+
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			{
+				open = ReadConnection(service, *connection);
+			}
+
+			if (open && connection->sentBytes < connection->outgoing.size())
+			{
+				open = FlushConnection(service, *connection);
+			}
+
+			if (!open)
+			{
+				CloseConnection(service, connection);
+			}
+		}
+
+		WriteLog(service); // everything this pass took in, in one write
+		SyncLog(service, InputClockMicroseconds());
+	}
+
+	WriteLog(service);
+	fsync(service.logFile);
+
+	if (service.topChanged)
+	{
+		SaveTopScores(service);
+	}
+
+	printf("Score service: logged %u scores in %u batches, %u rejected, %u fsyncs - %u in the log\n", service.numSubmitted - service.numRejected,
+		service.numBatches, service.numRejected, service.numSyncs, service.numScores);
+
+	while (!service.connections.empty())
+	{
+		CloseConnection(service, service.connections.back());
+	}
+
+	close(service.epollHandle);
+	close(service.listenSocket);
+	close(service.logFile);
+	unlink(path);
+
+	return 0;
+}
+
+int StartScoreService(const char* path, const char* logFileName)
+{
+	std::vector<Score> top;
+	unsigned int numScoresInLog = 0;
+
+	if (FetchTopScores(path, top, numScoresInLog))
+	{
+		return 0; // one is running already
+	}
+
+	fflush(stdout);
+	pid_t process = fork();
+
+	if (process == 0)
+	{
+		setpgid(0, 0); // a ^C at the terminal stops the instance, which stops this once the last scores are in
+
+		int result = RunScoreService(path, logFileName);
+		fflush(stdout);
+		_exit(result);
+	}
+
+	if (process < 0)
+	{
+		return -1;
+	}
+
+	long long endTime = InputClockMicroseconds() + SCORE_START_TIMEOUT * 1000LL;
+
+	while (!FetchTopScores(path, top, numScoresInLog))
+	{
+		if (InputClockMicroseconds() >= endTime || waitpid(process, nullptr, WNOHANG) == process)
+		{
+			StopScoreService((int)process);
+			return -1;
+		}
+
+		usleep(10000);
+	}
+
+	return (int)process;
+}
+
+void StopScoreService(int process)
+{
+	if (process > 0)
+	{
+		kill(process, SIGTERM);
+		waitpid(process, nullptr, 0);
+	}
+}
+
+/* An instance's side */
+
+static int ReadTopMessage(const std::string& received, std::vector<Score>& top, unsigned int& numScoresInLog) // its length, 0 until it has all arrived, -1 if it is not an SSM_TOP
+{
+	const unsigned char* bytes = (const unsigned char*)received.data();
+
+	if (received.empty())
+	{
+		return 0;
+	}
+
+	if (bytes[0] != SSM_TOP)
+	{
+		return -1;
+	}
+
+	if (received.size() < SCORE_TOP_HEADER_SIZE)
+	{
+		return 0;
+	}
+
+	int numEntries = bytes[5];
+	int length = FindMessageLength(bytes, received.size(), SCORE_TOP_HEADER_SIZE, numEntries);
+
+	if (length == 0)
+	{
+		return 0;
+	}
+
+	numScoresInLog = ReadUInt32(bytes + 1);
+	top.resize(numEntries);
+
+	const unsigned char* entry = bytes + SCORE_TOP_HEADER_SIZE;
+
+	for (int i = 0; i < numEntries; i++)
+	{
+		top[i].score = (int)ReadUInt32(entry);
+		top[i].name.assign((const char*)entry + SCORE_ENTRY_HEADER_SIZE, entry[4]);
+		entry += SCORE_ENTRY_HEADER_SIZE + entry[4];
+	}
+
+	return length;
+}
+
+static void DisconnectScoreClient(ScoreClient& client)
+{
+	close(client.socket);
+	client.socket = -1;
+	client.sentBytes = 0; // the service drops a message it only got part of, so it goes again whole
+	client.received.clear();
+}
+
+static void CloseBatch(ScoreClient& client)
+{
+	client.batch[1] = (char)(client.batchSize & 0xff);
+	client.batch[2] = (char)(client.batchSize >> 8);
+
+	client.queuedBytes += client.batch.size();
+	client.queued.push_back(std::string());
+	client.queued.back().swap(client.batch);
+	client.batchSize = 0;
+	client.wantsTop = true;
+}
+
+void InitScoreClient(ScoreClient& client, const char* path)
+{
+	client.path = path;
+	client.socket = -1;
+	client.nextConnectTime = 0;
+	client.batch.clear();
+	client.batchSize = 0;
+	client.queued.clear();
+	client.queuedBytes = 0;
+	client.sentBytes = 0;
+	client.wantsTop = false;
+	client.received.clear();
+	client.numSubmitted = 0;
+	client.numDropped = 0;
+	client.numScoresInLog = 0;
+}
+
+bool FetchTopScores(const char* path, std::vector<Score>& top, unsigned int& numScoresInLog)
+{
+	int socketHandle = ConnectToSocket(path);
+
+	if (socketHandle < 0)
+	{
+		return false;
+	}
+
+	char request = (char)SSM_GET_TOP;
+	std::string received;
+	int length = 0;
+	long long endTime = InputClockMicroseconds() + SCORE_FETCH_TIMEOUT * 1000LL;
+
+	if (send(socketHandle, &request, 1, SEND_FLAGS) == 1)
+	{
+		while (length == 0)
+		{
+			long long now = InputClockMicroseconds();
+
+			pollfd pollInfo;
+			pollInfo.fd = socketHandle;
+			pollInfo.events = POLLIN;
+			pollInfo.revents = 0;
+
+			if (now >= endTime || poll(&pollInfo, 1, (int)((endTime - now + 999) / 1000)) <= 0)
+			{
+				break;
+			}
+
+			char buffer[4 * 1024];
+			ssize_t numRead = recv(socketHandle, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+			if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+			{
+				break;
+			}
+
+			if (numRead > 0)
+			{
+				received.append(buffer, numRead);
+				length = ReadTopMessage(received, top, numScoresInLog);
+			}
+		}
+	}
+
+	close(socketHandle);
+
+	return length > 0;
+}
+
+void SubmitScore(ScoreClient& client, int score, const std::string& name)
+{
+	if (client.queuedBytes + client.batch.size() >= SCORE_MAX_QUEUED_BYTES)
+	{
+		client.numDropped++; // the service is not keeping up or is not there - the game does not wait for it
+		return;
+	}
+
+	if (client.batch.empty())
+	{
+		client.batch.push_back((char)SSM_SUBMIT);
+		WriteUInt16(client.batch, 0); // filled in by CloseBatch
+	}
+
+	WriteScoreEntry(client.batch, score, name);
+	client.batchSize++;
+	client.numSubmitted++;
+
+	if (client.batchSize == SCORE_MAX_BATCH)
+	{
+		CloseBatch(client);
+	}
+}
+
+bool UpdateScoreClient(ScoreClient& client, std::vector<Score>& top)
+{
+	if (!client.batch.empty())
+	{
+		CloseBatch(client);
+	}
+
+	if (client.wantsTop)
+	{
+		client.queued.push_back(std::string(1, (char)SSM_GET_TOP)); // the table with this instance's new scores in it
+		client.queuedBytes++;
+		client.wantsTop = false;
+	}
+
+	if (client.socket < 0)
+	{
+		long long now = InputClockMicroseconds();
+
+		if (client.queued.empty() || now < client.nextConnectTime)
+		{
+			return false;
+		}
+
+		client.nextConnectTime = now + SCORE_RECONNECT_INTERVAL * 1000LL;
+		client.socket = ConnectToSocket(client.path);
+
+		if (client.socket < 0)
+		{
+			return false;
+		}
+
+		if (!SetNonBlocking(client.socket))
+		{
+			DisconnectScoreClient(client);
+			return false;
+		}
+	}
+
+	while (!client.queued.empty())
+	{
+		const std::string& message = client.queued.front();
+		ssize_t numSent = send(client.socket, message.data() + client.sentBytes, message.size() - client.sentBytes, SEND_FLAGS);
+
+		if (numSent < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			break; // the rest goes on a later update
+		}
+
+		if (numSent <= 0)
+		{
+			DisconnectScoreClient(client);
+			return false;
+		}
+
+		client.sentBytes += numSent;
+
+		if (client.sentBytes == message.size())
+		{
+			client.queuedBytes -= message.size();
+			client.queued.pop_front();
+			client.sentBytes = 0;
+		}
+	}
+
+	bool changed = false;
+	char buffer[4 * 1024];
+
+	for (;;)
+	{
+		ssize_t numRead = recv(client.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+		if (numRead < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			DisconnectScoreClient(client);
+			return changed;
+		}
+
+		if (numRead < 0)
+		{
+			break;
+		}
+
+		client.received.append(buffer, numRead);
+
+		for (;;)
+		{
+			int length = ReadTopMessage(client.received, top, client.numScoresInLog);
+
+			if (length < 0)
+			{
+				DisconnectScoreClient(client);
+				return changed;
+			}
+
+			if (length == 0)
+			{
+				break;
+			}
+
+			client.received.erase(0, length);
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+void ShutDownScoreClient(ScoreClient& client)
+{
+	std::vector<Score> top;
+	long long endTime = InputClockMicroseconds() + SCORE_FETCH_TIMEOUT * 1000LL;
+
+	UpdateScoreClient(client, top);
+
+	while (client.socket >= 0 && !client.queued.empty() && InputClockMicroseconds() < endTime)
+	{
+		pollfd pollInfo;
+		pollInfo.fd = client.socket;
+		pollInfo.events = POLLOUT;
+		pollInfo.revents = 0;
+		poll(&pollInfo, 1, 10);
+
+		UpdateScoreClient(client, top);
+	}
+
+	if (client.socket >= 0)
+	{
+		close(client.socket);
+		client.socket = -1;
+	}
+}
+
+int RunScoreBenchmark(const char* path)
+{
+	std::vector<Score> top;
+	unsigned int numScoresAtStart = 0;
+
+	if (!FetchTopScores(path, top, numScoresAtStart))
+	{
+		fprintf(stderr, "No score service at %s\n", path);
+		return 1;
+	}
+
+	ScoreClient client;
+	InitScoreClient(client, path);
+
+	char name[4] = { 'A', 'A', 'A', '\0' };
+	long long startTime = InputClockMicroseconds();
+
+	while (client.numSubmitted + client.numDropped < SCORE_BENCHMARK_SCORES)
+	{
+		while (client.queuedBytes < SCORE_MAX_QUEUED_BYTES / 2 && client.numSubmitted < SCORE_BENCHMARK_SCORES)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				name[i] = (char)('A' + rand() % MAX_ALPHABET_CHARACTERS);
+			}
+
+			SubmitScore(client, rand() % 100000, name);
+		}
+
+		UpdateScoreClient(client, top);
+
+		if (client.socket < 0)
+		{
+			fprintf(stderr, "The score service went away\n");
+			return 1;
+		}
+
+		if (client.queuedBytes >= SCORE_MAX_QUEUED_BYTES / 2)
+		{
+			pollfd pollInfo;
+			pollInfo.fd = client.socket;
+			pollInfo.events = POLLOUT;
+			pollInfo.revents = 0;
+			poll(&pollInfo, 1, 10);
+		}
+	}
+
+	long long submittedTime = InputClockMicroseconds();
+
+	// done once the service's count has them all - its replies come after the batches before them
+	while (client.socket >= 0 && client.numScoresInLog < numScoresAtStart + client.numSubmitted && InputClockMicroseconds() - submittedTime < 10000000)
+	{
+		pollfd pollInfo;
+		pollInfo.fd = client.socket;
+		pollInfo.events = client.queued.empty() ? POLLIN : POLLIN | POLLOUT;
+		pollInfo.revents = 0;
+		poll(&pollInfo, 1, 10);
+
+		UpdateScoreClient(client, top);
+	}
+
+	double seconds = (InputClockMicroseconds() - startTime) / 1000000.0;
+
+	printf("Submitted %u scores in batches of up to %i, %u dropped\n", client.numSubmitted, (int)SCORE_MAX_BATCH, client.numDropped);
+	printf("The service took them in %.3f s, %.0f scores a second - %u in its log, the best %i\n", seconds, client.numSubmitted / seconds,
+		client.numScoresInLog, top.empty() ? 0 : top[0].score);
+
+	ShutDownScoreClient(client);
+
+	return 0;
+}
+
+#else
+
+int RunScoreService(const char*, const char*)
+{
+	fprintf(stderr, "The score service is not supported on this platform\n");
+	return 1;
+}
+
+int RunScoreBenchmark(const char*)
+{
+	fprintf(stderr, "The score service is not supported on this platform\n");
+	return 1;
+}
+
+int StartScoreService(const char*, const char*)
+{
+	return 0; // nothing here could use one
+}
+
+void StopScoreService(int)
+{
+}
+
+void InitScoreClient(ScoreClient& client, const char* path)
+{
+	client.path = path;
+	client.socket = -1;
+}
+
+bool FetchTopScores(const char*, std::vector<Score>&, unsigned int&)
+{
+	return false;
+}
+
+void SubmitScore(ScoreClient&, int, const std::string&)
+{
+}
+
+bool UpdateScoreClient(ScoreClient&, std::vector<Score>&)
+{
+	return false;
+}
+
+void ShutDownScoreClient(ScoreClient&)
+{
+}
+
+#endif
+
+std::string DefaultScoreServicePath()
+{
+	const char* runtimeDirectory = getenv("XDG_RUNTIME_DIR");
+
+	if (runtimeDirectory == nullptr || runtimeDirectory[0] == '\0')
+	{
+		return std::string();
+	}
+
+	return std::string(runtimeDirectory) + "/TextInvadersScores.sock";
+}
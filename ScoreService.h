@@ -0,0 +1,119 @@
+#pragma once
+#ifndef SCORESERVICE_H_
+#define SCORESERVICE_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "TextInvaders.h"
+
+/*
+Score Service:
+
+One high score table for every instance on the machine, instead of each one rewriting TextInvadersHighScoresTable.txt
+and the last to write winning. TextInvaders --score-service [path] serves it on a Unix domain socket, by default
+$XDG_RUNTIME_DIR/TextInvadersScores.sock (/tmp/TextInvadersScores.sock without one). Game servers always send their
+scores there, starting a service if none is running. A game does if the service answers when it starts - by default
+only with $XDG_RUNTIME_DIR set, so no other user can listen in, or on any path with --submit-scores [path] - and saves
+the file otherwise. The service keeps the file up to date and takes in scores saved to it while it was not running.
+
+Every score goes in an append-only log (--score-log file, TextInvadersScoreLog.txt by default), one "name score" line
+each, read back on starting. Lookups are answered from the top MAX_HIGH_SCORES in memory, and each pass of the epoll
+loop appends its scores with one write, fsynced at most every SCORE_SYNC_INTERVAL milliseconds.
+
+Messages, little endian, each starting with a uint8 ScoreMessageType:
+
+SSM_SUBMIT - uint16 count, then count of: uint32 score, uint8 name length, the name - from an instance
+SSM_GET_TOP - from an instance, asks for an SSM_TOP
+SSM_TOP - uint32 scores in the log, uint8 count, then count of: uint32 score, uint8 name length, the name - the reply
+
+An instance never waits to submit: scores are batched and sent on a non-blocking socket once a frame, and queued while
+the service is away. TextInvaders --benchmark-scores [path] reports how many scores a second a running service takes.
+Not available on Windows builds.
+*/
+
+enum
+{
+	SCORE_MAX_NAME_LENGTH = 32,
+	SCORE_MAX_BATCH = 1024, // scores per SSM_SUBMIT
+	SCORE_MAX_QUEUED_BYTES = 1024 * 1024, // on an instance, waiting for the service
+	SCORE_MAX_REPLY_BYTES = 64 * 1024, // on the service, waiting for an instance
+	SCORE_SYNC_INTERVAL = 100, // milliseconds
+	SCORE_RECONNECT_INTERVAL = 1000, // milliseconds
+	SCORE_FETCH_TIMEOUT = 200, // milliseconds to wait for the table when an instance starts
+	SCORE_START_TIMEOUT = 1000, // milliseconds for a service started by StartScoreService to answer
+	SCORE_MAX_CONNECTIONS = 1024,
+	SCORE_BENCHMARK_SCORES = 1000000,
+};
+
+enum ScoreMessageType
+{
+	SSM_SUBMIT = 1,
+	SSM_GET_TOP,
+	SSM_TOP
+};
+
+struct ScoreClient // an instance's connection to the service
+{
+	const char* path;
+	int socket; // -1 while not connected
+	long long nextConnectTime; // microseconds, InputClockMicroseconds' clock
+
+	std::string batch; // the SSM_SUBMIT being filled, empty if there is none
+	int batchSize;
+	std::deque<std::string> queued; // messages waiting for the socket
+	size_t queuedBytes;
+	size_t sentBytes; // of the first queued message
+	bool wantsTop;
+
+	std::string received; // bytes of a reply that has not all arrived
+	unsigned int numSubmitted;
+	unsigned int numDropped;
+	unsigned int numScoresInLog; // from the last SSM_TOP
+};
+
+struct ScoreConnection // an instance, on the service's side
+{
+	int socket;
+	std::string received;
+	std::string outgoing;
+	size_t sentBytes;
+	bool waitingToWrite; // registered for EPOLLOUT
+	bool wantsTop; // asked for an SSM_TOP while outgoing was full
+};
+
+struct ScoreService
+{
+	int listenSocket;
+	int epollHandle;
+	int logFile;
+	std::string pendingLog; // lines not yet written
+	long long lastSyncTime;
+	bool unsynced; // written since the last fsync
+	bool topChanged; // since the high score file was last saved
+
+	std::vector<Score> top; // sorted, at most MAX_HIGH_SCORES
+	unsigned int numScores; // in the log
+	std::vector<ScoreConnection*> connections;
+
+	unsigned int numSubmitted; // since it started
+	unsigned int numBatches;
+	unsigned int numRejected; // names it could not log
+	unsigned int numSyncs;
+};
+
+int RunScoreService(const char* path, const char* logFileName); // serves until SIGINT or SIGTERM
+int RunScoreBenchmark(const char* path);
+int StartScoreService(const char* path, const char* logFileName); // runs one in a process of its own if none answers on path - its process id, 0 if one was running already, -1 if it could not start
+void StopScoreService(int process); // one StartScoreService started, waiting for it to save what it has
+std::string DefaultScoreServicePath(); // in $XDG_RUNTIME_DIR, which only its user can reach - empty when there is none
+
+// An instance's side - LoadHighScores, AddHighScore and UpdateHighScores go through these when a table has a service
+void InitScoreClient(ScoreClient& client, const char* path);
+bool FetchTopScores(const char* path, std::vector<Score>& top, unsigned int& numScoresInLog); // on a connection of its own, waiting up to SCORE_FETCH_TIMEOUT - false if there was no answer
+void SubmitScore(ScoreClient& client, int score, const std::string& name); // never waits
+bool UpdateScoreClient(ScoreClient& client, std::vector<Score>& top); // sends what is due and takes in replies - true if top changed
+void ShutDownScoreClient(ScoreClient& client); // waits up to SCORE_FETCH_TIMEOUT for the last batches to go
+
+#endif // SCORESERVICE_H_
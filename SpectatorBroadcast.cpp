@@ -0,0 +1,514 @@
+
+#include <cstring>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "SpectatorBroadcast.h"
+#include "FrameDelta.h"
+#include "CursesUtils.h"
+
+#ifndef _WIN32
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL; // a spectator closing their terminal should not kill the game with SIGPIPE
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+/* Message helpers */
+
+void BuildFrameMessage(std::string& message, SpectatorMessageType type, int width, int height, unsigned int frameNumber, const char* previous, const char* cells)
+{
+	message.clear();
+	message.push_back((char)type);
+	WriteUInt16(message, width);
+	WriteUInt16(message, height);
+	WriteUInt32(message, frameNumber);
+	WriteUInt32(message, 0); // payload length, patched below
+
+	EncodeFrameDelta(previous, cells, width * height, message);
+
+	PatchUInt32(message, 9, (unsigned int)(message.size() - SPECTATOR_MESSAGE_HEADER_SIZE));
+}
+
+static void BuildMessage(std::string& message, SpectatorMessageType type, const SpectatorBroadcast& broadcast, const char* previous)
+{
+	BuildFrameMessage(message, type, broadcast.width, broadcast.height, broadcast.frameNumber, previous, broadcast.cells.data());
+}
+
+static bool SetNonBlocking(int socket)
+{
+	int flags = fcntl(socket, F_GETFL, 0);
+	return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool RemoveStaleSocket(const char* path, const sockaddr_un& address) // unlinks a socket left behind by a game that did not shut down cleanly, returns false if something still listens on it
+{
+	struct stat info;
+
+	if (lstat(path, &info) != 0 || !S_ISSOCK(info.st_mode))
+	{
+		return true; // anything else at the path is left alone, and bind fails on it
+	}
+
+	int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (probe < 0 || !SetNonBlocking(probe))
+	{
+		if (probe >= 0)
+		{
+			close(probe);
+		}
+		return false;
+	}
+
+	bool stale = connect(probe, (const sockaddr*)&address, sizeof(address)) != 0 && errno == ECONNREFUSED; // a full backlog gives EAGAIN, which is just as alive
+	close(probe);
+
+	if (!stale)
+	{
+		return false;
+	}
+
+	unlink(path);
+	return true;
+}
+
+/* Server */
+
+static bool FlushSpectator(Spectator& spectator) // returns false if the spectator has gone away
+{
+	while (spectator.sentBytes < spectator.outgoing.size())
+	{
+		ssize_t numSent = send(spectator.socket, spectator.outgoing.data() + spectator.sentBytes, spectator.outgoing.size() - spectator.sentBytes, SEND_FLAGS);
+
+		if (numSent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+
+		spectator.sentBytes += numSent;
+	}
+
+	spectator.outgoing.clear();
+	spectator.sentBytes = 0;
+	return true;
+}
+
+static void AcceptSpectators(SpectatorBroadcast& broadcast)
+{
+	int socket;
+
+	while ((socket = accept(broadcast.listenSocket, nullptr, nullptr)) >= 0)
+	{
+		if (broadcast.spectators.size() >= SPECTATOR_MAX_CONNECTIONS || !SetNonBlocking(socket))
+		{
+			close(socket);
+			continue;
+		}
+
+		Spectator spectator;
+		spectator.socket = socket;
+		spectator.sentBytes = 0;
+		spectator.needsKeyframe = true;
+
+		broadcast.spectators.push_back(spectator);
+	}
+}
+
+bool InitSpectatorBroadcast(SpectatorBroadcast& broadcast, const char* path, int width, int height)
+{
+	broadcast.path = path;
+	broadcast.width = width;
+	broadcast.height = height;
+	broadcast.frameNumber = 0;
+	broadcast.cells.assign(width * height, ' ');
+	broadcast.previousCells.assign(width * height, ' ');
+	broadcast.blankCells.assign(width * height, ' ');
+	broadcast.spectators.clear();
+
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (broadcast.path.size() >= sizeof(address.sun_path))
+	{
+		broadcast.listenSocket = -1;
+		return false;
+	}
+
+	strcpy(address.sun_path, path);
+
+	broadcast.listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (broadcast.listenSocket < 0)
+	{
+		return false;
+	}
+
+	if (!RemoveStaleSocket(path, address)) // another game is broadcasting there, so this one goes without
+	{
+		close(broadcast.listenSocket);
+		broadcast.listenSocket = -1;
+		return false;
+	}
+
+	if (bind(broadcast.listenSocket, (sockaddr*)&address, sizeof(address)) != 0 ||
+		listen(broadcast.listenSocket, SPECTATOR_MAX_CONNECTIONS) != 0 ||
+		!SetNonBlocking(broadcast.listenSocket))
+	{
+		close(broadcast.listenSocket);
+		broadcast.listenSocket = -1;
+		return false;
+	}
+
+	return true;
+}
+
+void BroadcastFrame(SpectatorBroadcast& broadcast)
+{
+	if (broadcast.listenSocket < 0)
+	{
+		return;
+	}
+
+	AcceptSpectators(broadcast);
+
+	if (broadcast.spectators.empty())
+	{
+		return;
+	}
+
+	broadcast.frameNumber++;
+	ReadScreen(broadcast.cells.data(), broadcast.width, broadcast.height);
+
+	bool keyframeBuilt = false;
+	bool deltaBuilt = false;
+
+	for (size_t i = 0; i < broadcast.spectators.size(); )
+	{
+		Spectator& spectator = broadcast.spectators[i];
+
+		bool connected = FlushSpectator(spectator);
+
+		if (connected && spectator.outgoing.empty())
+		{
+			if (spectator.needsKeyframe)
+			{
+				if (!keyframeBuilt)
+				{
+					BuildMessage(broadcast.keyframe, SMT_KEYFRAME, broadcast, broadcast.blankCells.data());
+					keyframeBuilt = true;
+				}
+
+				spectator.outgoing = broadcast.keyframe;
+				spectator.needsKeyframe = false;
+			}
+			else
+			{
+				if (!deltaBuilt)
+				{
+					BuildMessage(broadcast.delta, SMT_DELTA, broadcast, broadcast.previousCells.data());
+					deltaBuilt = true;
+				}
+
+				if (broadcast.delta.size() > SPECTATOR_MESSAGE_HEADER_SIZE) // nothing changed, nothing to send
+				{
+					spectator.outgoing = broadcast.delta;
+				}
+			}
+
+			connected = FlushSpectator(spectator);
+		}
+		else if (connected)
+		{
+			spectator.needsKeyframe = true; // still behind - this frame is skipped and it catches up on a keyframe
+		}
+
+		if (!connected)
+		{
+			close(spectator.socket);
+			broadcast.spectators[i] = broadcast.spectators.back();
+			broadcast.spectators.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	broadcast.previousCells.swap(broadcast.cells);
+}
+
+void ShutDownSpectatorBroadcast(SpectatorBroadcast& broadcast)
+{
+	for (size_t i = 0; i < broadcast.spectators.size(); i++)
+	{
+		close(broadcast.spectators[i].socket);
+	}
+	broadcast.spectators.clear();
+
+	if (broadcast.listenSocket >= 0)
+	{
+		close(broadcast.listenSocket);
+		unlink(broadcast.path.c_str());
+		broadcast.listenSocket = -1;
+	}
+}
+
+/* Client */
+
+bool ReceiveFrameMessages(FrameReceiver& receiver, const char* bytes, size_t numBytes)
+{
+	receiver.received.append(bytes, numBytes);
+
+	bool redraw = false;
+	size_t offset = 0;
+
+	while (receiver.received.size() - offset >= SPECTATOR_MESSAGE_HEADER_SIZE)
+	{
+		const unsigned char* message = (const unsigned char*)receiver.received.data() + offset;
+		unsigned int payloadLength = ReadUInt32(message + 9);
+
+		if (receiver.received.size() - offset < SPECTATOR_MESSAGE_HEADER_SIZE + payloadLength)
+		{
+			break; // wait for the rest of it
+		}
+
+		int type = message[0];
+		int messageWidth = ReadUInt16(message + 1);
+		int messageHeight = ReadUInt16(message + 3);
+
+		if (type == SMT_KEYFRAME)
+		{
+			receiver.width = messageWidth;
+			receiver.height = messageHeight;
+			receiver.cells.assign(receiver.width * receiver.height, ' ');
+			receiver.haveKeyframe = true;
+		}
+
+		if (receiver.haveKeyframe && messageWidth == receiver.width && messageHeight == receiver.height)
+		{
+			if (ApplyFrameDelta(message + SPECTATOR_MESSAGE_HEADER_SIZE, payloadLength, receiver.cells.data(), receiver.width * receiver.height))
+			{
+				receiver.numFrames++;
+				redraw = true;
+			}
+			else
+			{
+				receiver.haveKeyframe = false; // corrupt - ignore everything until the game sends a keyframe
+			}
+		}
+
+		offset += SPECTATOR_MESSAGE_HEADER_SIZE + payloadLength;
+	}
+
+	receiver.received.erase(0, offset);
+
+	return redraw;
+}
+
+int ConnectToSocket(const char* path)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+
+	strcpy(address.sun_path, path);
+
+	int socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socketHandle < 0 || connect(socketHandle, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		if (socketHandle >= 0)
+		{
+			close(socketHandle);
+		}
+		return -1;
+	}
+
+	return socketHandle;
+}
+
+int ConnectToGame(const char* path)
+{
+	int socketHandle = ConnectToSocket(path);
+
+	if (socketHandle < 0)
+	{
+		fprintf(stderr, "Could not connect to a game at %s\n", path);
+	}
+
+	return socketHandle;
+}
+
+int ListenOnGameSocket(const char* path)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		fprintf(stderr, "Socket path is too long: %s\n", path);
+		return -1;
+	}
+
+	strcpy(address.sun_path, path);
+
+	int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (listenSocket < 0)
+	{
+		fprintf(stderr, "Could not open a socket\n");
+		return -1;
+	}
+
+	if (!RemoveStaleSocket(path, address))
+	{
+		fprintf(stderr, "Something is already running on %s\n", path);
+		close(listenSocket);
+		return -1;
+	}
+
+	if (bind(listenSocket, (sockaddr*)&address, sizeof(address)) != 0 ||
+		listen(listenSocket, SOMAXCONN) != 0 ||
+		!SetNonBlocking(listenSocket))
+	{
+		fprintf(stderr, "Could not listen on %s\n", path);
+		close(listenSocket);
+		return -1;
+	}
+
+	return listenSocket;
+}
+
+int RunSpectator(const char* path)
+{
+	int socketHandle = ConnectToGame(path);
+
+	if (socketHandle < 0)
+	{
+		return 1;
+	}
+
+	InitializeCurses(true);
+
+	FrameReceiver receiver;
+	InitFrameReceiver(receiver);
+	bool quit = false;
+
+	while (!quit)
+	{
+		if (GetChar() == 'q')
+		{
+			break;
+		}
+
+		pollfd pollInfo;
+		pollInfo.fd = socketHandle;
+		pollInfo.events = POLLIN;
+		pollInfo.revents = 0;
+
+		if (poll(&pollInfo, 1, 1000 / 60) <= 0)
+		{
+			continue;
+		}
+
+		char buffer[16 * 1024];
+		ssize_t numRead = recv(socketHandle, buffer, sizeof(buffer), 0);
+
+		if (numRead <= 0)
+		{
+			quit = numRead == 0 || (errno != EINTR && errno != EAGAIN);
+			continue;
+		}
+
+		if (ReceiveFrameMessages(receiver, buffer, numRead))
+		{
+			ClearScreen();
+			DrawCells(receiver.cells.data(), receiver.width, receiver.height);
+			RefreshScreen();
+		}
+	}
+
+	ShutDownCurses();
+	close(socketHandle);
+
+	return 0;
+}
+
+#else
+
+bool InitSpectatorBroadcast(SpectatorBroadcast& broadcast, const char*, int, int)
+{
+	broadcast.listenSocket = -1;
+	return false;
+}
+
+void BroadcastFrame(SpectatorBroadcast&)
+{
+}
+
+void ShutDownSpectatorBroadcast(SpectatorBroadcast&)
+{
+}
+
+void BuildFrameMessage(std::string& message, SpectatorMessageType, int, int, unsigned int, const char*, const char*)
+{
+	message.clear();
+}
+
+bool ReceiveFrameMessages(FrameReceiver&, const char*, size_t)
+{
+	return false;
+}
+
+int ConnectToSocket(const char*)
+{
+	return -1;
+}
+
+int ConnectToGame(const char*)
+{
+	return -1;
+}
+
+int ListenOnGameSocket(const char*)
+{
+	return -1;
+}
+
+int RunSpectator(const char*)
+{
+	fprintf(stderr, "Spectating is not supported on this platform\n");
+	return 1;
+}
+
+#endif
+
+void InitFrameReceiver(FrameReceiver& receiver)
+{
+	receiver.received.clear();
+	receiver.cells.clear();
+	receiver.width = 0;
+	receiver.height = 0;
+	receiver.haveKeyframe = false;
+	receiver.numFrames = 0;
+}
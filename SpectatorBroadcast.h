@@ -0,0 +1,87 @@
+#pragma once
+#ifndef SPECTATORBROADCAST_H_
+#define SPECTATORBROADCAST_H_
+
+#include <string>
+#include <vector>
+
+/*
+Spectator Broadcast:
+
+Lets people on the same machine watch a game live from their own terminal (TextInvaders --spectate [path]). The game
+listens on a Unix domain socket and, after each frame is drawn, sends every spectator a message:
+
+uint8 type - SMT_KEYFRAME or SMT_DELTA
+uint16 width, uint16 height
+uint32 frameNumber
+uint32 payloadLength
+payload - FrameDelta runs, against a blank grid for keyframes or against the previous frame for deltas
+
+(all little endian). A spectator gets a keyframe when it joins. Sockets are non-blocking: a spectator that still has
+unsent bytes from an earlier frame is skipped until it drains, and then it gets a fresh keyframe instead of the deltas
+it missed. The game loop never waits on a viewer.
+
+Not available on Windows builds.
+*/
+
+enum
+{
+	SPECTATOR_MAX_CONNECTIONS = 16,
+	SPECTATOR_MESSAGE_HEADER_SIZE = 13,
+};
+
+enum SpectatorMessageType
+{
+	SMT_KEYFRAME = 1,
+	SMT_DELTA
+};
+
+struct Spectator
+{
+	int socket;
+	std::string outgoing; // bytes of the last message not yet accepted by the socket
+	size_t sentBytes;
+	bool needsKeyframe;
+};
+
+struct SpectatorBroadcast
+{
+	int listenSocket;
+	std::string path;
+	int width;
+	int height;
+	unsigned int frameNumber;
+	std::vector<char> cells;
+	std::vector<char> previousCells;
+	std::vector<char> blankCells;
+	std::vector<Spectator> spectators;
+	std::string keyframe;
+	std::string delta;
+};
+
+struct FrameReceiver // the viewing end - what has been received so far and the screen it adds up to
+{
+	std::string received; // bytes of a message that has not all arrived
+	std::vector<char> cells;
+	int width;
+	int height;
+	bool haveKeyframe;
+	unsigned int numFrames; // messages applied
+};
+
+bool InitSpectatorBroadcast(SpectatorBroadcast& broadcast, const char* path, int width, int height); // returns false if the socket could not be opened
+void BroadcastFrame(SpectatorBroadcast& broadcast); // call once the frame is drawn
+void ShutDownSpectatorBroadcast(SpectatorBroadcast& broadcast);
+
+int RunSpectator(const char* path); // connects to a game and shows it until 'q' is pressed or the game ends
+
+// Shared with the game server (GameServer.h), which sends its players the same messages, netplay (Netplay.h) and the
+// score service (ScoreService.h)
+void BuildFrameMessage(std::string& message, SpectatorMessageType type, int width, int height, unsigned int frameNumber, const char* previous, const char* cells);
+void InitFrameReceiver(FrameReceiver& receiver);
+bool ReceiveFrameMessages(FrameReceiver& receiver, const char* bytes, size_t numBytes); // returns true if the screen changed
+int ConnectToSocket(const char* path); // a connected socket, or -1 without printing anything
+int ConnectToGame(const char* path); // a connected socket, or -1 after printing why not
+int ListenOnGameSocket(const char* path); // a non-blocking listening socket, or -1 after printing why not - unlink the path when done with it
+
+#endif // SPECTATORBROADCAST_H_
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef SPRITEMASKS_H_
+#define SPRITEMASKS_H_
+
+#include "TextInvaders.h"
+
+/*
+Sprite Masks:
+
+Which cells of every frame of every sprite are solid, worked out by the compiler from the sprites in TextInvaders.h:
+bit x of rows[y] is set where the frame's character at x on line y is not a space. A hit on a sprite is then a shift and
+an AND - (mask.rows[y] >> x) & 1 - so a missile goes through the gaps in " >< " or " =A= " the same as it looks like it
+does, instead of hitting the box around the sprite.
+
+SPRITE_MASKS is a constant expression, like LEVEL_TABLES, so a mask can be checked with a static_assert. Change a sprite
+and its mask follows.
+*/
+
+enum
+{
+	SPRITE_MASK_MAX_WIDTH = 8, // a row is one byte of bits
+	SPRITE_MASK_MAX_HEIGHT = SHIELD_SPRITE_HEIGHT, // the tallest sprite
+};
+
+static_assert(int(PLAYER_SPRITE_WIDTH) <= int(SPRITE_MASK_MAX_WIDTH) && int(SHIELD_SPRITE_WIDTH) <= int(SPRITE_MASK_MAX_WIDTH) &&
+	int(ALIEN_SPRITE_WIDTH) <= int(SPRITE_MASK_MAX_WIDTH) && int(ALIEN_UFO_SPRITE_WIDTH) <= int(SPRITE_MASK_MAX_WIDTH), "a sprite mask row is one byte of bits");
+
+struct SpriteMask
+{
+	unsigned char rows[SPRITE_MASK_MAX_HEIGHT];
+};
+
+struct SpriteMasks
+{
+	SpriteMask player;
+	SpriteMask playerExplosion[2];
+	SpriteMask shield;
+	SpriteMask alien30[2]; // by AlienSwarm animation
+	SpriteMask alien20[2];
+	SpriteMask alien10[2];
+	SpriteMask alienExplosion;
+	SpriteMask alienUFO;
+};
+
+constexpr SpriteMask MakeSpriteMask(const char* const sprite[], int height, int frame)
+{
+	SpriteMask mask = {};
+
+	for (int row = 0; row < height; row++)
+	{
+		const char* line = sprite[frame * height + row];
+
+		for (int col = 0; line[col] != '\0'; col++)
+		{
+			if (line[col] != ' ')
+			{
+				mask.rows[row] |= (unsigned char)(1u << col);
+			}
+		}
+	}
+
+	return mask;
+}
+
+constexpr SpriteMasks MakeSpriteMasks()
+{
+	SpriteMasks masks = {};
+
+	masks.player = MakeSpriteMask(PLAYER_SPRITE, PLAYER_SPRITE_HEIGHT, 0);
+	masks.shield = MakeSpriteMask(SHIELD_SPRITE, SHIELD_SPRITE_HEIGHT, 0);
+	masks.alienExplosion = MakeSpriteMask(ALIEN_EXPLOSION, ALIEN_SPRITE_HEIGHT, 0);
+	masks.alienUFO = MakeSpriteMask(ALIEN_UFO_SPRITE, ALIEN_UFO_SPRITE_HEIGHT, 0);
+
+	for (int frame = 0; frame < 2; frame++)
+	{
+		masks.playerExplosion[frame] = MakeSpriteMask(PLAYER_EXPLOSION_SPRITE, PLAYER_SPRITE_HEIGHT, frame);
+		masks.alien30[frame] = MakeSpriteMask(ALIEN30_SPRITE, ALIEN_SPRITE_HEIGHT, frame);
+		masks.alien20[frame] = MakeSpriteMask(ALIEN20_SPRITE, ALIEN_SPRITE_HEIGHT, frame);
+		masks.alien10[frame] = MakeSpriteMask(ALIEN10_SPRITE, ALIEN_SPRITE_HEIGHT, frame);
+	}
+
+	return masks;
+}
+
+constexpr SpriteMasks SPRITE_MASKS = MakeSpriteMasks();
+
+static_assert(SPRITE_MASKS.player.rows[0] == 0x0e && SPRITE_MASKS.player.rows[1] == 0x1f, "\" =A= \" over \"=====\"");
+static_assert(SPRITE_MASKS.alien20[0].rows[0] == 0x06, "\" >< \" is only solid in the middle");
+
+#endif // SPRITEMASKS_H_
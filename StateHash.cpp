@@ -0,0 +1,336 @@
+
+#include <cstring>
+#include <string>
+
+#include "StateHash.h"
+#include "FrameDelta.h"
+
+static const char STATE_HASH_LOG_MAGIC[] = "TIHL";
+
+template<class Config>
+uint64_t HashGameState(const GameSnapshotT<Config>& snapshot)
+{
+	return HashStateBytes(&snapshot, sizeof(snapshot));
+}
+
+uint64_t HashStateBytes(const void* state, size_t size)
+{
+	const unsigned char* data = (const unsigned char*)state;
+	const size_t numWords = size / sizeof(uint64_t);
+
+	uint64_t hash = 0x84222325CBF29CE4ULL ^ size;
+
+	for (size_t i = 0; i < numWords; i++) // a word at a time - the snapshot is zero padded so every byte is defined
+	{
+		uint64_t word;
+		memcpy(&word, data + i * sizeof(uint64_t), sizeof(uint64_t));
+
+		hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+		hash ^= hash >> 29;
+	}
+
+	for (size_t i = numWords * sizeof(uint64_t); i < size; i++)
+	{
+		hash = (hash ^ data[i]) * 0x100000001B3ULL;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+/* Logging */
+
+template<class Config>
+bool StartStateHashLog(StateHashLogT<Config>& log, const char* fileName, const char* variant)
+{
+	log.tick = 0;
+	log.file = fopen(fileName, "wb");
+
+	if (log.file == nullptr)
+	{
+		return false;
+	}
+
+	std::string header(STATE_HASH_LOG_MAGIC, 4);
+	WriteUInt32(header, STATE_HASH_LOG_VERSION);
+	WriteUInt32(header, sizeof(GameSnapshotT<Config>));
+
+	std::string variantName(variant, strnlen(variant, STATE_HASH_LOG_VARIANT_SIZE - 1));
+	variantName.resize(STATE_HASH_LOG_VARIANT_SIZE, '\0');
+	header += variantName;
+
+	fwrite(header.data(), 1, header.size(), log.file);
+	return true;
+}
+
+template<class Config>
+uint64_t LogStateHash(StateHashLogT<Config>& log, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo)
+{
+	SaveGameSnapshot(log.snapshot, game, player, shields, numberOfShields, aliens, ufo);
+	uint64_t hash = HashGameState(log.snapshot);
+
+	if (log.file != nullptr)
+	{
+		fwrite(&log.tick, sizeof(log.tick), 1, log.file);
+		fwrite(&hash, sizeof(hash), 1, log.file);
+		fwrite(&log.snapshot, sizeof(log.snapshot), 1, log.file);
+	}
+
+	log.tick++;
+	return hash;
+}
+
+template<class Config>
+void StopStateHashLog(StateHashLogT<Config>& log)
+{
+	if (log.file != nullptr)
+	{
+		fclose(log.file);
+		log.file = nullptr;
+	}
+}
+
+/* Comparing */
+
+static void CompareField(FILE* out, const char* name, long a, long b)
+{
+	if (a != b)
+	{
+		fprintf(out, "  %-32s %ld vs %ld\n", name, a, b);
+	}
+}
+
+static void ComparePosition(FILE* out, const char* name, const Position& a, const Position& b)
+{
+	std::string fieldName = name;
+	CompareField(out, (fieldName + ".x").c_str(), a.x, b.x);
+	CompareField(out, (fieldName + ".y").c_str(), a.y, b.y);
+}
+
+template<class Config>
+void PrintSnapshotDifferences(FILE* out, const GameSnapshotT<Config>& a, const GameSnapshotT<Config>& b)
+{
+	char name[64];
+
+	CompareField(out, "game.currentState", a.currentState, b.currentState);
+	CompareField(out, "game.level", a.level, b.level);
+	CompareField(out, "game.gameTimer", (long)a.gameTimer, (long)b.gameTimer);
+	CompareField(out, "game.timers.now", (long)a.timers.now, (long)b.timers.now);
+	CompareField(out, "game.subTick", a.subTick, b.subTick);
+	for (int i = 0; i < MAX_NUMBER_OF_TIMERS; i++)
+	{
+		if (a.timers.timers[i].type != TIMER_FREE || b.timers.timers[i].type != TIMER_FREE)
+		{
+			snprintf(name, sizeof(name), "game.timers.timers[%d].type", i);
+			CompareField(out, name, a.timers.timers[i].type, b.timers.timers[i].type);
+			snprintf(name, sizeof(name), "game.timers.timers[%d].due", i);
+			CompareField(out, name, (long)a.timers.timers[i].due, (long)b.timers.timers[i].due);
+			snprintf(name, sizeof(name), "game.timers.timers[%d].data", i);
+			CompareField(out, name, a.timers.timers[i].data, b.timers.timers[i].data);
+		}
+	}
+
+	ComparePosition(out, "player.position", a.player.position, b.player.position);
+	ComparePosition(out, "player.missile", a.player.missile, b.player.missile);
+	CompareField(out, "player.missileY", a.player.missileY, b.player.missileY);
+	CompareField(out, "player.spriteSize.width", a.player.spriteSize.width, b.player.spriteSize.width);
+	CompareField(out, "player.spriteSize.height", a.player.spriteSize.height, b.player.spriteSize.height);
+	CompareField(out, "player.animation", a.player.animation, b.player.animation);
+	CompareField(out, "player.lives", a.player.lives, b.player.lives);
+	CompareField(out, "player.score", a.player.score, b.player.score);
+
+	ComparePosition(out, "aliens.position", a.aliens.position, b.aliens.position);
+	for (int row = 0; row < Config::NUM_ALIEN_ROWS; row++)
+	{
+		for (int col = 0; col < Config::NUM_ALIEN_COLUMNS; col++)
+		{
+			snprintf(name, sizeof(name), "aliens.aliens[%d][%d]", row, col);
+			CompareField(out, name, a.aliens.aliens[row][col], b.aliens.aliens[row][col]);
+		}
+	}
+	for (int i = 0; i < Config::MAX_NUMBER_OF_ALIEN_BOMBS; i++)
+	{
+		snprintf(name, sizeof(name), "aliens.bombs[%d].position", i);
+		ComparePosition(out, name, a.aliens.bombs[i].position, b.aliens.bombs[i].position);
+		snprintf(name, sizeof(name), "aliens.bombs[%d].y", i);
+		CompareField(out, name, a.aliens.bombs[i].y, b.aliens.bombs[i].y);
+		snprintf(name, sizeof(name), "aliens.bombs[%d].animation", i);
+		CompareField(out, name, a.aliens.bombs[i].animation, b.aliens.bombs[i].animation);
+	}
+	CompareField(out, "aliens.spriteSize.width", a.aliens.spriteSize.width, b.aliens.spriteSize.width);
+	CompareField(out, "aliens.spriteSize.height", a.aliens.spriteSize.height, b.aliens.spriteSize.height);
+	CompareField(out, "aliens.animation", a.aliens.animation, b.aliens.animation);
+	CompareField(out, "aliens.direction", a.aliens.direction, b.aliens.direction);
+	CompareField(out, "aliens.numberOfBombsInPlay", a.aliens.numberOfBombsInPlay, b.aliens.numberOfBombsInPlay);
+	CompareField(out, "aliens.movementTime", a.aliens.movementTime, b.aliens.movementTime);
+	CompareField(out, "aliens.stepDue", a.aliens.stepDue, b.aliens.stepDue);
+	CompareField(out, "aliens.stepped", a.aliens.stepped, b.aliens.stepped);
+	CompareField(out, "aliens.numAliensLeft", a.aliens.numAliensLeft, b.aliens.numAliensLeft);
+	CompareField(out, "aliens.line", a.aliens.line, b.aliens.line);
+
+	ComparePosition(out, "ufo.position", a.ufo.position, b.ufo.position);
+	CompareField(out, "ufo.x", a.ufo.x, b.ufo.x);
+	CompareField(out, "ufo.size.width", a.ufo.size.width, b.ufo.size.width);
+	CompareField(out, "ufo.size.height", a.ufo.size.height, b.ufo.size.height);
+	CompareField(out, "ufo.points", a.ufo.points, b.ufo.points);
+
+	for (int i = 0; i < Config::NUM_SHIELDS; i++)
+	{
+		snprintf(name, sizeof(name), "shields[%d].position", i);
+		ComparePosition(out, name, a.shields[i].position, b.shields[i].position);
+
+		for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+		{
+			for (int col = 0; col < SHIELD_SPRITE_WIDTH; col++)
+			{
+				snprintf(name, sizeof(name), "shields[%d].rows[%d] bit %d", i, row, col);
+				CompareField(out, name, (a.shields[i].rows[row] >> col) & 1, (b.shields[i].rows[row] >> col) & 1);
+			}
+		}
+	}
+}
+
+static bool ReadStateHashLogHeader(FILE* file, unsigned int& snapshotSize, std::string& variant)
+{
+	unsigned char header[STATE_HASH_LOG_HEADER_SIZE];
+
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, STATE_HASH_LOG_MAGIC, 4) != 0 ||
+		ReadUInt32(header + 4) != STATE_HASH_LOG_VERSION)
+	{
+		return false;
+	}
+
+	snapshotSize = ReadUInt32(header + 8);
+	variant.assign((const char*)header + 12, strnlen((const char*)header + 12, STATE_HASH_LOG_VARIANT_SIZE));
+	return true;
+}
+
+bool ReadStateHashLogVariant(const char* fileName, std::string& variant)
+{
+	FILE* file = fopen(fileName, "rb");
+	unsigned int snapshotSize;
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	bool isLog = ReadStateHashLogHeader(file, snapshotSize, variant);
+	fclose(file);
+
+	return isLog;
+}
+
+template<class Config>
+static FILE* OpenStateHashLog(const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	unsigned int snapshotSize;
+	std::string variant;
+
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not open %s\n", fileName);
+		return nullptr;
+	}
+
+	if (!ReadStateHashLogHeader(file, snapshotSize, variant) || snapshotSize != sizeof(GameSnapshotT<Config>))
+	{
+		fprintf(stderr, "%s is not a state hash log from a build with this layout\n", fileName);
+		fclose(file);
+		return nullptr;
+	}
+
+	return file;
+}
+
+template<class Config>
+static bool ReadStateHashRecord(FILE* file, unsigned int& tick, uint64_t& hash, GameSnapshotT<Config>& snapshot)
+{
+	return fread(&tick, sizeof(tick), 1, file) == 1 && fread(&hash, sizeof(hash), 1, file) == 1 && fread(&snapshot, sizeof(snapshot), 1, file) == 1;
+}
+
+template<class Config>
+int CompareStateHashLogs(const char* fileNameA, const char* fileNameB)
+{
+	FILE* fileA = OpenStateHashLog<Config>(fileNameA);
+	FILE* fileB = OpenStateHashLog<Config>(fileNameB);
+
+	if (fileA == nullptr || fileB == nullptr)
+	{
+		if (fileA != nullptr)
+		{
+			fclose(fileA);
+		}
+		if (fileB != nullptr)
+		{
+			fclose(fileB);
+		}
+		return 2;
+	}
+
+	GameSnapshotT<Config> snapshotA;
+	GameSnapshotT<Config> snapshotB;
+	unsigned int tickA, tickB;
+	uint64_t hashA, hashB;
+	unsigned int numTicks = 0;
+	int result = 0;
+
+	while (true)
+	{
+		bool haveA = ReadStateHashRecord(fileA, tickA, hashA, snapshotA);
+		bool haveB = ReadStateHashRecord(fileB, tickB, hashB, snapshotB);
+
+		if (!haveA || !haveB)
+		{
+			if (haveA != haveB)
+			{
+				printf("Runs match for %u ticks, then %s ends\n", numTicks, haveA ? fileNameB : fileNameA);
+				result = 1;
+			}
+			else
+			{
+				printf("Runs match for all %u ticks\n", numTicks);
+			}
+			break;
+		}
+
+		if (hashA != hashB)
+		{
+			printf("Runs diverge at tick %u (%016llx vs %016llx):\n", tickA, (unsigned long long)hashA, (unsigned long long)hashB);
+			PrintSnapshotDifferences(stdout, snapshotA, snapshotB);
+
+			if (memcmp(&snapshotA, &snapshotB, sizeof(snapshotA)) == 0)
+			{
+				printf("  (states are identical - the two builds hash differently)\n");
+			}
+			result = 1;
+			break;
+		}
+
+		numTicks++;
+	}
+
+	fclose(fileA);
+	fclose(fileB);
+
+	return result;
+}
+
+/* The configs in GAME_VARIANTS */
+
+template uint64_t HashGameState(const GameSnapshotT<ClassicConfig>&);
+template bool StartStateHashLog(StateHashLogT<ClassicConfig>&, const char*, const char*);
+template uint64_t LogStateHash(StateHashLogT<ClassicConfig>&, const Game&, const Player&, const Shield[], int, const AlienSwarmT<ClassicConfig>&, const AlienUFO&);
+template void StopStateHashLog(StateHashLogT<ClassicConfig>&);
+template int CompareStateHashLogs<ClassicConfig>(const char*, const char*);
+template void PrintSnapshotDifferences(FILE*, const GameSnapshotT<ClassicConfig>&, const GameSnapshotT<ClassicConfig>&);
+template uint64_t HashGameState(const GameSnapshotT<WideConfig>&);
+template bool StartStateHashLog(StateHashLogT<WideConfig>&, const char*, const char*);
+template uint64_t LogStateHash(StateHashLogT<WideConfig>&, const Game&, const Player&, const Shield[], int, const AlienSwarmT<WideConfig>&, const AlienUFO&);
+template void StopStateHashLog(StateHashLogT<WideConfig>&);
+template int CompareStateHashLogs<WideConfig>(const char*, const char*);
+template void PrintSnapshotDifferences(FILE*, const GameSnapshotT<WideConfig>&, const GameSnapshotT<WideConfig>&);
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef STATEHASH_H_
+#define STATEHASH_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "GameSnapshot.h"
+
+/*
+State Hash:
+
+A 64 bit hash of the whole simulation state (a GameSnapshot) for every tick, to prove an optimized build plays out
+exactly like the reference one. --hash-log file writes one record per tick:
+
+uint32 tick, uint64 hash, the GameSnapshot bytes
+
+after a header of "TIHL", uint32 version, uint32 sizeof(GameSnapshot), the --variant name (zero padded to
+STATE_HASH_LOG_VARIANT_SIZE bytes). Run the same input replay through two builds with --hash-log, then TextInvaders
+--compare-hash-logs a b reports the first tick where the hashes differ and lists every field that differs on that tick.
+Both logs have to come from builds with the same struct layout, and from the same variant - the snapshot is the one for
+its config (GameSnapshotT<Config>).
+*/
+
+enum
+{
+	STATE_HASH_LOG_VERSION = 3, // 2 - the tick rate's fixed point positions and sub tick, 3 - the variant
+	STATE_HASH_LOG_VARIANT_SIZE = 16,
+	STATE_HASH_LOG_HEADER_SIZE = 12 + STATE_HASH_LOG_VARIANT_SIZE,
+};
+
+template<class Config>
+struct StateHashLogT
+{
+	FILE* file;
+	unsigned int tick;
+	GameSnapshotT<Config> snapshot;
+};
+
+typedef StateHashLogT<ClassicConfig> StateHashLog;
+
+template<class Config>
+uint64_t HashGameState(const GameSnapshotT<Config>& snapshot);
+uint64_t HashStateBytes(const void* state, size_t size); // any zero padded state
+
+template<class Config>
+bool StartStateHashLog(StateHashLogT<Config>& log, const char* fileName, const char* variant); // returns false if the file could not be created
+template<class Config>
+uint64_t LogStateHash(StateHashLogT<Config>& log, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo); // call once per tick, returns the hash
+template<class Config>
+void StopStateHashLog(StateHashLogT<Config>& log);
+
+bool ReadStateHashLogVariant(const char* fileName, std::string& variant); // returns false if it is not a state hash log of this version
+template<class Config>
+int CompareStateHashLogs(const char* fileNameA, const char* fileNameB); // prints the first divergence, returns 0 if the runs match
+template<class Config>
+void PrintSnapshotDifferences(FILE* out, const GameSnapshotT<Config>& a, const GameSnapshotT<Config>& b);
+
+#endif // STATEHASH_H_
@@ -0,0 +1,349 @@
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "StressSwarm.h"
+#include "CursesUtils.h"
+#include "SpriteMasks.h"
+#include "RawInput.h"
+
+static int FloorDiv(int numerator, int denominator) // rounds towards minus infinity, the viewport can be left of or above the swarm
+{
+	int quotient = numerator / denominator;
+	return (numerator % denominator != 0 && (numerator < 0) != (denominator < 0)) ? quotient - 1 : quotient;
+}
+
+static int CeilDiv(int numerator, int denominator)
+{
+	return -FloorDiv(-numerator, denominator);
+}
+
+static int CellWidth(const StressSwarm& aliens)
+{
+	return aliens.spriteSize.width + StressConfig::ALIENS_X_PADDING;
+}
+
+static int CellHeight(const StressSwarm& aliens)
+{
+	return aliens.spriteSize.height + StressConfig::ALIENS_Y_PADDING;
+}
+
+/* Swarm */
+
+static void InitStressSwarm(StressSwarm& aliens, int numRows, int numColumns, int maxBombs, int bombChanceDivisor)
+{
+	aliens.numRows = numRows;
+	aliens.numColumns = numColumns;
+	aliens.bombChanceDivisor = bombChanceDivisor;
+	aliens.spriteSize.width = ALIEN_SPRITE_WIDTH;
+	aliens.spriteSize.height = ALIEN_SPRITE_HEIGHT;
+	aliens.animation = 0;
+	aliens.direction = 1;
+	aliens.stepDue = 0;
+	aliens.stepped = 0;
+	aliens.numAliensLeft = numRows * numColumns;
+
+	aliens.aliens.assign(numRows, std::vector<AlienState>(numColumns, AS_ALIVE));
+	aliens.lowestAliveRow.assign(numColumns, numRows - 1);
+	aliens.occupiedInColumn.assign(numColumns, numRows);
+	aliens.occupiedInRow.assign(numRows, numColumns);
+	aliens.leftColumn = 0;
+	aliens.rightColumn = numColumns - 1;
+	aliens.bottomRow = numRows - 1;
+
+	aliens.explosions.clear();
+	InitProjectilePool(aliens.bombs, maxBombs);
+}
+
+/* Game */
+
+static void UpdateViewport(StressGame& game)
+{
+	const Size& fieldSize = game.game.windowSize;
+	int maxViewportX = std::max(0, fieldSize.width - game.viewportSize.width);
+	int maxLookUp = std::max(0, fieldSize.height - game.viewportSize.height);
+
+	game.viewport.x = std::min(std::max(game.player.position.x + game.player.spriteSize.width / 2 - game.viewportSize.width / 2, 0), maxViewportX);
+	game.lookUp = std::min(std::max(game.lookUp, 0), maxLookUp);
+	game.viewport.y = maxLookUp - game.lookUp;
+}
+
+void InitStressGame(StressGame& game, int numRows, int numColumns, int screenWidth, int screenHeight, bool bulletHell, int tickRate, unsigned int seed)
+{
+	StressSwarm& aliens = game.aliens;
+	InitStressSwarm(aliens, numRows, numColumns, bulletHell ? BULLET_HELL_MAX_NUMBER_OF_BOMBS : STRESS_MAX_NUMBER_OF_BOMBS,
+		bulletHell ? BULLET_HELL_BOMB_CHANCE_DIVISOR : STRESS_BOMB_CHANCE_DIVISOR);
+
+	int swarmTop = 2 * ALIEN_UFO_SPRITE_HEIGHT + 1; // under the UFO, which flies its own height down (ResetUFO)
+	int swarmWidth = numColumns * CellWidth(aliens) - StressConfig::ALIENS_X_PADDING;
+	int swarmHeight = numRows * CellHeight(aliens) - StressConfig::ALIENS_Y_PADDING;
+
+	game.bulletHell = bulletHell;
+	game.viewportSize.width = screenWidth;
+	game.viewportSize.height = screenHeight - 1; // the top line is the status line
+
+	Size fieldSize;
+	fieldSize.width = std::max(swarmWidth + 2 * STRESS_FIELD_MARGIN, game.viewportSize.width);
+	fieldSize.height = std::max(swarmTop + swarmHeight + STRESS_DROP_ROOM + PLAYER_SPRITE_HEIGHT + 1, game.viewportSize.height);
+
+	aliens.position.x = (fieldSize.width - swarmWidth) / 2;
+	aliens.position.y = swarmTop;
+	aliens.line = fieldSize.height - PLAYER_SPRITE_HEIGHT - (swarmTop + swarmHeight); // until its bottom row is level with the top of the player, as in the classic game
+
+	game.shields.clear();
+
+	for (int x = STRESS_SHIELD_SPACING / 2; x + SHIELD_SPRITE_WIDTH <= fieldSize.width; x += STRESS_SHIELD_SPACING)
+	{
+		Shield shield;
+		shield.position.x = x;
+		shield.position.y = fieldSize.height - PLAYER_SPRITE_HEIGHT - 1 - SHIELD_SPRITE_HEIGHT - 2; // where ResetShields puts them
+
+		for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+		{
+			shield.rows[row] = SPRITE_MASKS.shield.rows[row];
+		}
+
+		game.shields.push_back(shield);
+	}
+
+	StartStressGame(game, fieldSize, tickRate, seed);
+	InitProjectilePool(game.missiles, bulletHell ? BULLET_HELL_MAX_NUMBER_OF_MISSILES : STRESS_MAX_NUMBER_OF_MISSILES);
+
+	game.lookUp = 0;
+	game.aliensDrawn = 0;
+	game.updateMicroseconds = 0;
+	game.drawMicroseconds = 0;
+
+	UpdateViewport(game);
+}
+
+void ProcessStressInput(int input, StressGame& game)
+{
+	Player& player = game.player;
+
+	switch (input)
+	{
+	case AK_LEFT:
+	case AK_RIGHT:
+		if (game.game.currentState == GS_PLAY)
+		{
+			MovePlayer(game.game, player, input == AK_LEFT ? -PLAYER_MOVEMENT_AMOUNT : PLAYER_MOVEMENT_AMOUNT);
+		}
+		break;
+	case ' ':
+		if (game.game.currentState == GS_PLAY)
+		{
+			int numMissiles = game.bulletHell ? BULLET_HELL_MISSILE_SPREAD : 1;
+
+			for (int i = 0; i < numMissiles; i++)
+			{
+				Position missile;
+				missile.x = player.position.x + player.spriteSize.width / 2 + i - numMissiles / 2;
+				missile.y = player.position.y - 1; // one row above the player
+				SpawnProjectile(game.missiles, missile); // nothing happens once they are all in flight
+			}
+		}
+		break;
+	case AK_UP:
+		game.lookUp += STRESS_LOOK_AMOUNT;
+		break;
+	case AK_DOWN:
+		game.lookUp -= STRESS_LOOK_AMOUNT;
+		break;
+	}
+
+	UpdateViewport(game);
+}
+
+/* Drawing */
+
+static bool IsInViewport(const StressGame& game, int xPos, int yPos, int width, int height)
+{
+	return xPos >= game.viewport.x && xPos + width <= game.viewport.x + game.viewportSize.width &&
+		yPos >= game.viewport.y && yPos + height <= game.viewport.y + game.viewportSize.height;
+}
+
+static void DrawStressSwarm(StressGame& game)
+{
+	const StressSwarm& aliens = game.aliens;
+	int cellWidth = CellWidth(aliens);
+	int cellHeight = CellHeight(aliens);
+
+	// only the aliens whose whole sprite is inside the viewport - and inside the part of the swarm that is left
+	int firstColumn = std::max(aliens.leftColumn, CeilDiv(game.viewport.x - aliens.position.x, cellWidth));
+	int lastColumn = std::min(aliens.rightColumn, FloorDiv(game.viewport.x + game.viewportSize.width - aliens.spriteSize.width - aliens.position.x, cellWidth));
+	int firstRow = std::max(0, CeilDiv(game.viewport.y - aliens.position.y, cellHeight));
+	int lastRow = std::min(aliens.bottomRow, FloorDiv(game.viewport.y + game.viewportSize.height - aliens.spriteSize.height - aliens.position.y, cellHeight));
+
+	game.aliensDrawn = 0;
+
+	for (int row = firstRow; row <= lastRow; row++)
+	{
+		int points = AlienRowPoints(row, aliens.numRows);
+		const char* const* sprite = points == 30 ? ALIEN30_SPRITE : (points == 20 ? ALIEN20_SPRITE : ALIEN10_SPRITE);
+		const std::vector<AlienState>& rowAliens = aliens.aliens[row];
+		int yPos = aliens.position.y + row * cellHeight - game.viewport.y + 1;
+
+		for (int col = firstColumn; col <= lastColumn; col++)
+		{
+			int xPos = aliens.position.x + col * cellWidth - game.viewport.x;
+
+			if (rowAliens[col] == AS_ALIVE)
+			{
+				DrawSprite(xPos, yPos, sprite, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
+				game.aliensDrawn++;
+			}
+			else if (rowAliens[col] == AS_EXPLODING)
+			{
+				DrawSprite(xPos, yPos, ALIEN_EXPLOSION, aliens.spriteSize.height);
+				game.aliensDrawn++;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < aliens.bombs.projectiles.size(); i++)
+	{
+		const Projectile& bomb = aliens.bombs.projectiles[i];
+
+		if (IsInViewport(game, bomb.position.x, bomb.position.y, 1, 1))
+		{
+			DrawCharacter(bomb.position.x - game.viewport.x, bomb.position.y - game.viewport.y + 1, ALIEN_BOMB_SPRITE[bomb.animation]);
+		}
+	}
+}
+
+static void DrawStressShields(const StressGame& game)
+{
+	for (size_t i = 0; i < game.shields.size(); i++)
+	{
+		const Shield& shield = game.shields[i];
+
+		if (!IsInViewport(game, shield.position.x, shield.position.y, SHIELD_SPRITE_WIDTH, SHIELD_SPRITE_HEIGHT))
+		{
+			continue;
+		}
+
+		for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+		{
+			for (int col = 0; col < SHIELD_SPRITE_WIDTH; col++)
+			{
+				if (shield.rows[row] & (1u << col))
+				{
+					DrawCharacter(shield.position.x + col - game.viewport.x, shield.position.y + row - game.viewport.y + 1, SHIELD_SPRITE[row][col]);
+				}
+			}
+		}
+	}
+}
+
+void DrawStressGame(StressGame& game)
+{
+	const Player& player = game.player;
+	const AlienUFO& ufo = game.ufo;
+
+	DrawStressSwarm(game);
+	DrawStressShields(game);
+
+	if (ufo.position.x != NOT_IN_PLAY && IsInViewport(game, ufo.position.x, ufo.position.y, ufo.size.width, ufo.size.height))
+	{
+		DrawSprite(ufo.position.x - game.viewport.x, ufo.position.y - game.viewport.y + 1, ALIEN_UFO_SPRITE, ufo.size.height);
+	}
+
+	if (IsInViewport(game, player.position.x, player.position.y, player.spriteSize.width, player.spriteSize.height))
+	{
+		DrawSprite(player.position.x - game.viewport.x, player.position.y - game.viewport.y + 1, PLAYER_SPRITE, player.spriteSize.height);
+	}
+
+	for (size_t i = 0; i < game.missiles.projectiles.size(); i++)
+	{
+		const Projectile& missile = game.missiles.projectiles[i];
+
+		if (IsInViewport(game, missile.position.x, missile.position.y, 1, 1))
+		{
+			DrawCharacter(missile.position.x - game.viewport.x, missile.position.y - game.viewport.y + 1, PLAYER_MISSILE_SPRITE);
+		}
+	}
+
+	char status[256];
+	snprintf(status, sizeof(status), "SCORE: %i, LIVES: %i, ALIENS: %i/%i, MISSILES: %i, BOMBS: %i, DRAWN: %i, UPDATE: %ius, DRAW: %ius",
+		player.score, player.lives, game.aliens.numAliensLeft, game.aliens.numRows * game.aliens.numColumns, (int)game.missiles.projectiles.size(),
+		(int)game.aliens.bombs.projectiles.size(), game.aliensDrawn, game.updateMicroseconds, game.drawMicroseconds);
+	DrawString(0, 0, status);
+
+	if (game.game.currentState != GS_PLAY)
+	{
+		const char* message = game.aliens.numAliensLeft == 0 ? "The swarm is gone! Press q to quit" : "The swarm got through! Press q to quit";
+		DrawString((game.viewportSize.width - (int)strlen(message)) / 2, game.viewportSize.height / 2, message);
+	}
+}
+
+/* Stress mode */
+
+int RunStressSwarm(const char* dimensions, bool bulletHell, int tickRate, bool rawInput, unsigned int seed)
+{
+	int numRows = STRESS_DEFAULT_ROWS;
+	int numColumns = STRESS_DEFAULT_COLUMNS;
+
+	if (dimensions != nullptr && (sscanf(dimensions, "%ix%i", &numRows, &numColumns) != 2 ||
+		numRows < 1 || numRows > STRESS_MAX_ROWS || numColumns < 1 || numColumns > STRESS_MAX_COLUMNS))
+	{
+		fprintf(stderr, "The stress swarm is rowsxcolumns, up to %ix%i: %s\n", (int)STRESS_MAX_ROWS, (int)STRESS_MAX_COLUMNS, dimensions);
+		return 1;
+	}
+
+	InitializeCurses(true);
+
+	RawInput keyboard;
+	InitRawInput(keyboard, rawInput);
+
+	StressGame game;
+	InitStressGame(game, numRows, numColumns, ScreenWidth(), ScreenHeight(), bulletHell, tickRate, seed);
+
+	bool quit = false;
+	int ticksUntilFrame = 0;
+	clock_t lastTime = clock();
+
+	while (!quit)
+	{
+		int input = ReadInputEvent(keyboard).key;
+
+		if (input == 'q')
+		{
+			quit = true;
+			continue;
+		}
+
+		ProcessStressInput(input, game);
+
+		clock_t dt;
+
+		if (IsTickDue(game.game, lastTime, dt))
+		{
+			clock_t currentTime = clock();
+			UpdateStressGame(game);
+
+			clock_t drawTime = clock();
+			game.updateMicroseconds = (int)((drawTime - currentTime) * 1000000 / CLOCKS_PER_SEC);
+
+			if (--ticksUntilFrame > 0)
+			{
+				continue;
+			}
+
+			ticksUntilFrame = TicksPerFrame(game.game);
+
+			ClearScreen();
+			DrawStressGame(game);
+			game.drawMicroseconds = (int)((clock() - drawTime) * 1000000 / CLOCKS_PER_SEC); // shown on the next frame
+			RefreshScreen();
+		}
+	}
+
+	ShutDownRawInput(keyboard);
+	ShutDownCurses();
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#ifndef STRESSSWARM_H_
+#define STRESSSWARM_H_
+
+#include <vector>
+
+#include "TextInvaders.h"
+#include "ProjectilePool.h"
+
+/*
+Stress Swarm:
+
+A swarm sized when the game starts instead of when it is compiled (TextInvaders --stress [rowsxcolumns], 50x200 by
+default), on a field much bigger than the terminal. The terminal is a viewport onto the field that follows the player
+sideways, and the up and down arrows look further up the field. Only the aliens inside the viewport are drawn.
+
+The swarm is the engine's AlienSwarmT for StressConfig, and the game's own templates step it, shoot and move its bombs,
+erode the shields under it and hit test it, at the game's tick rate. Only its storage differs: its sizes are in the swarm,
+its bombs are a ProjectilePool and its explosions a list - far more than the timer wheel holds.
+
+TextInvaders --bullet-hell [rowsxcolumns] is the same game with hundreds of projectiles in flight: every shot is a spread
+of missiles and the swarm has far more bombs. There are no levels, no waits between lives and no high scores.
+*/
+
+enum
+{
+	STRESS_DEFAULT_ROWS = 50,
+	STRESS_DEFAULT_COLUMNS = 200,
+	STRESS_MAX_ROWS = 1000,
+	STRESS_MAX_COLUMNS = 1000,
+	STRESS_MAX_NUMBER_OF_MISSILES = 1,
+	STRESS_MAX_NUMBER_OF_BOMBS = 64,
+	STRESS_BOMB_CHANCE_DIVISOR = 70, // the swarm shoots when DrawGameRandom() % divisor == 1 - as often as a full classic swarm
+	BULLET_HELL_MAX_NUMBER_OF_MISSILES = 256,
+	BULLET_HELL_MAX_NUMBER_OF_BOMBS = 1024,
+	BULLET_HELL_MISSILE_SPREAD = 3, // missiles per shot, a column apart
+	BULLET_HELL_BOMB_CHANCE_DIVISOR = 2,
+	STRESS_FIELD_MARGIN = 40, // columns of open field either side of the swarm when it starts
+	STRESS_DROP_ROOM = 20, // lines the swarm can drop before it reaches the player
+	STRESS_LOOK_AMOUNT = 4, // lines the view moves up or down per press
+	STRESS_SHIELD_SPACING = 24, // columns from one shield to the next
+};
+
+struct StressConfig
+{
+	enum
+	{
+		ALIENS_X_PADDING = 1,
+		ALIENS_Y_PADDING = 1,
+	};
+};
+
+struct StressExplosion
+{
+	int row;
+	int column;
+	int ticksLeft; // classic ticks
+};
+
+template<>
+struct AlienSwarmT<StressConfig>
+{
+	Position position; // top left of the first alien, on the field
+	std::vector<std::vector<AlienState> > aliens; // [row][column]
+	ProjectilePool bombs;
+	Size spriteSize;
+	int animation;
+	int direction; // > 0 - for going right, < 0 - for going left
+	int movementTime; // ticks between steps
+	int stepDue; // set by the TIMER_SWARM_STEP timer
+	int stepped; // set when the swarm steps sideways, so it shoots no bombs that classic tick
+	int numAliensLeft;
+	int line; // lines left to drop - once it's 0 the swarm has reached the player
+
+	std::vector<int> lowestAliveRow; // bottom most AS_ALIVE alien of each column - NOT_IN_PLAY once the column has none
+	std::vector<int> occupiedInColumn; // aliens that are not AS_DEAD yet in each column
+	std::vector<int> occupiedInRow; // same for each row
+	int leftColumn; // first column with an alien that is not AS_DEAD - numColumns if there are none
+	int rightColumn; // last column with an alien that is not AS_DEAD - -1 if there are none
+	int bottomRow; // last row with an alien that is not AS_DEAD - -1 if there are none
+
+	int numRows;
+	int numColumns;
+	int bombChanceDivisor;
+	std::vector<StressExplosion> explosions;
+};
+
+typedef AlienSwarmT<StressConfig> StressSwarm;
+
+struct StressGame
+{
+	Game game; // its windowSize is the whole field
+	Size viewportSize;
+	Position viewport; // top left of the part of the field on screen
+	int lookUp; // lines the player has moved the view up from the bottom of the field
+	bool bulletHell;
+	Player player; // the missiles are in missiles, not player.missile
+	ProjectilePool missiles;
+	StressSwarm aliens;
+	std::vector<Shield> shields;
+	AlienUFO ufo;
+
+	int aliensDrawn; // last frame, after culling
+	int updateMicroseconds; // last tick
+	int drawMicroseconds; // last frame
+};
+
+void InitStressGame(StressGame& game, int numRows, int numColumns, int screenWidth, int screenHeight, bool bulletHell, int tickRate, unsigned int seed);
+void ProcessStressInput(int input, StressGame& game);
+void DrawStressGame(StressGame& game);
+
+int RunStressSwarm(const char* dimensions, bool bulletHell, int tickRate, bool rawInput, unsigned int seed); // rowsxcolumns, nullptr for the defaults
+
+/* The game side, in TextInvaders.cpp with the rest of the game loop */
+
+void StartStressGame(StressGame& game, const Size& fieldSize, int tickRate, unsigned int seed); // once the swarm is made - the game, the player, the UFO and the swarm's first step
+void UpdateStressGame(StressGame& game); // one tick
+void MovePlayer(const Game& game, Player& player, int dx);
+bool IsTickDue(const Game& game, clock_t& lastTime, clock_t& dt);
+int TicksPerFrame(const Game& game);
+int AlienRowPoints(int row, int numRows); // 30, 20 or 10
+
+#endif // STRESSSWARM_H_
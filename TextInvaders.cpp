@@ -1,1217 +1,2700 @@
-// TextInvaders.cpp : This file contains the 'main' function. Program execution begins and ends there.
-//
-
-#include <iostream>
-#include <string>
-#include <ctime>
-#include <cmath>
-#include <cstring>
-#include <cstdlib>
-#include <algorithm> // for sorting
-#include <fstream> // for files
-
-#include "CursesUtils.h"
-#include "TextInvaders.h"
-
-
-using namespace std;
-
-/* Initialize game and player */
-
-void InitGame(Game& game);
-void InitPlayer(const Game& game, Player& player);
-void ResetPlayer(const Game& game, Player& player);
-void ResetMissile(Player& player);
-
-/* Game Loop Functions */
-
-int HandleInput(Game& game, Player& player, AlienSwarm& aliens, Shield shields[], int numberOfShields, HighScoreTable& table);
-void UpdateGame(clock_t dt, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarm& aliens, AlienUFO& ufo);
-void DrawGame(const Game& game, const Player& player, Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo, const HighScoreTable& table);
-void MovePlayer(const Game& game, Player& player, int dx);
-void PlayerShoot(Player& player);
-void DrawPlayer(const Player& player, const char* sprite[]);
-void UpdateMissile(Player& player);
-void DrawShileds(const Shield shields[], int numberOfShields);
-
-/* Shield Initializations */
-
-void InitShields(const Game& game, Shield shields[], int numberOfShields);
-void CleanUpShields(Shield shields[], int numberOfShields);
-
-/* Collision functions */
-
-int IsCollision(const Position& projectile, const Shield shields[], int numberOfShields, Position& shieldCollisionPoint); // returns the shield index of which shield got hit, return NOT_IN_PLAY if nothing was hit, returns shield collision point
-void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollisionPoint);
-
-/* Aliens Initialize and Draw functions */
-
-void InitAliens(const Game& game, AlienSwarm& aliens);
-void DrawAliens(const AlienSwarm& aliens);
-
-/* Alien Collisions */
-
-bool IsCollision(const Player& player, const AlienSwarm& aliens, Position& alienCollisionPositionInArray);
-int ResolveAlienCollision(AlienSwarm& aliens, const Position& hitPositionInAliensArray);
-bool UpdateAliens(Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields);
-
-/* Alien Movement */
-
-void ResetMovementTime(AlienSwarm& aliens);
-void FindEmptyRowsAndColumns(const AlienSwarm& aliens, int& emptyColsLeft, int& emptyColsRight, int& emptyRowsBottom);
-
-/* Aliens vs Shields functions */
-
-void DestoryShields(const AlienSwarm& aliens, Shield shields[], int numberOfShields);
-void CollideShieldsWithAlien(Shield shields[], int numberOfShields, int xPos, int yPos, const Size& size);
-bool ShouldShootBomb(const AlienSwarm& aliens);
-void ShootBomb(AlienSwarm& aliens, int columnToShoot);
-bool UpdateBombs(const Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields);
-
-/* Aliens vs Player */
-
-bool IsCollision(const Position& projectile, const Position& spritePosition, const Size& spriteSize);
-
-/* Resetting the game */
-
-void ResetGame(Game& game, Player& player, AlienSwarm& aliens, Shield shields[], int numberOfShields);
-void ResetShields(const Game& game, Shield shields[], int numberOfShields);
-
-/* Game States */
-
-void DrawGameOverScreen(const Game& game);
-void DrawIntroScreen(const Game& game);
-
-/* UFO functions */
-
-void ResetUFO(const Game& game, AlienUFO& ufo);
-void PutUFOInPlay(const Game& game, AlienUFO& ufo);
-void UpdateUFO(const Game& game, AlienUFO& ufo);
-void DrawUFO(const AlienUFO& ufo);
-
-/* Game Over Cursors */
-
-void ResetGameOverPositionCursors(Game& game);
-bool ScoreCompare(const Score& score1, const Score score2);
-
-/* HighScore table */
-
-void AddHighScore(HighScoreTable& table, int score, const string& name);
-void DrawHighScoreTable(const Game& game, const HighScoreTable& table);
-
-/* Read and Save Scores */
-
-void SaveHighScores(const HighScoreTable& table);
-void LoadHighScores(HighScoreTable& table);
-
-int main()
-{
-    srand(time(NULL));
-
-    Game game;
-    Player player;
-    Shield shields[NUM_SHIELDS];
-    AlienSwarm aliens;
-    AlienUFO ufo;
-    HighScoreTable table;
-
-    InitializeCurses(true);
-
-    InitGame(game);
-    game.level = 1;
-    InitPlayer(game, player);
-    InitShields(game, shields, NUM_SHIELDS);
-    InitAliens(game, aliens);
-    ResetUFO(game, ufo);
-
-    LoadHighScores(table);
-
-    bool quit = false;
-    int input;
-
-    clock_t lastTime = clock(); // starts the game clock
-
-    while (!quit)
-    {
-        input = HandleInput(game, player, aliens, shields, NUM_SHIELDS, table);
-
-        if (input != 'q')
-        {
-
-            clock_t currentTime = clock(); // create current clock ticks
-            clock_t dt = currentTime - lastTime; // set dt to current clock ticks minus last clock ticks
-
-            /* Manages the speed of the game */
-
-            if (dt > CLOCKS_PER_SEC / FPS) // check if dt is more than the clock ticks per second over our frames per second
-            {
-                lastTime = currentTime;
-
-                UpdateGame(dt, game, player, shields, NUM_SHIELDS, aliens, ufo);
-                ClearScreen();
-                DrawGame(game, player, shields, NUM_SHIELDS, aliens, ufo, table);
-                RefreshScreen();
-            }
-        }
-        else
-        {
-            quit = true;
-        }
-
-    }
-    
-    CleanUpShields(shields, NUM_SHIELDS);
-    ShutDownCurses();
-
-    return 0;
-}
-
-/* Initialize game and player functions */
-
-void InitGame(Game& game)
-{
-    game.windowSize.width = ScreenWidth();
-    game.windowSize.height = ScreenHeight();
-    game.currentState = GS_INTRO; // For now - TODO: change to GS_INTRO at the end
-    game.waitTimer = 0;
-    game.gameTimer = 0;
-
-    ResetGameOverPositionCursors(game);
-    
-}
-
-void InitPlayer(const Game& game, Player& player)
-{
-    player.lives = MAX_NUMBER_OF_LIVES;
-    player.spriteSize.width = PLAYER_SPRITE_WIDTH;
-    player.spriteSize.height = PLAYER_SPRITE_HEIGHT;
-    player.score = 0;
-    ResetPlayer(game, player);
-}
-
-void ResetPlayer(const Game& game, Player& player)
-{
-    player.position.x = game.windowSize.width / 2 - player.spriteSize.width / 2; // This puts the player in the center of the screen horizontally
-    player.position.y = game.windowSize.height - player.spriteSize.height - 1; // puts the player at bottom of the screen
-    player.animation = 0;
-    ResetMissile(player);
-}
-
-void ResetMissile(Player& player)
-{
-    player.missile.x = NOT_IN_PLAY;
-    player.missile.y = NOT_IN_PLAY;
-}
-
-/* Game Loop Functions */
-
-int HandleInput(Game& game, Player& player, AlienSwarm& aliens, Shield shields[], int numberOfShields, HighScoreTable& table)
-{
-    int input = GetChar();
-    switch (input)
-    {
-    case 's':
-        if (game.currentState == GS_INTRO)
-        {
-            game.currentState = GS_HIGH_SCORE;
-        }
-        break;
-    case 'q':
-        return input;
-    case AK_LEFT:
-        if (game.currentState == GS_PLAY)
-        {
-            MovePlayer(game, player, -PLAYER_MOVEMENT_AMOUNT);
-        }
-        else if (game.currentState == GS_GAME_OVER)
-        {
-            game.gameOverHPositionCursor = game.gameOverHPositionCursor - 1;
-            if (game.gameOverHPositionCursor < 0)
-            {
-                game.gameOverHPositionCursor = MAX_NUMBER_OF_CHARACTERS_IN_NAME - 1; // if we hit beginning of characters and try going left, take back to end of characters
-            }
-        }
-        
-        break;
-    case AK_RIGHT:
-        if (game.currentState == GS_PLAY)
-        {
-            MovePlayer(game, player, PLAYER_MOVEMENT_AMOUNT);
-        }
-        
-        else if (game.currentState == GS_GAME_OVER)
-        {
-            game.gameOverHPositionCursor = (game.gameOverHPositionCursor + 1) % MAX_NUMBER_OF_CHARACTERS_IN_NAME; // make sure you're still in bounds of 0 - 2
-        }
-        
-        break;
-    case AK_UP:
-        if (game.currentState == GS_GAME_OVER)
-        {
-            game.gameOverVPositionCursor[game.gameOverHPositionCursor] = game.gameOverVPositionCursor[game.gameOverHPositionCursor] - 1;
-
-            if (game.gameOverVPositionCursor[game.gameOverHPositionCursor] < 0)
-            {
-                game.gameOverVPositionCursor[game.gameOverHPositionCursor] = MAX_ALPHABET_CHARACTERS - 1;
-            }
-
-            game.playerName[game.gameOverHPositionCursor] = 'A' + game.gameOverVPositionCursor[game.gameOverHPositionCursor];
-        }
-        break;
-    case AK_DOWN:
-        if (game.currentState == GS_GAME_OVER)
-        {
-            game.gameOverVPositionCursor[game.gameOverHPositionCursor] = (game.gameOverVPositionCursor[game.gameOverHPositionCursor] + 1) % MAX_ALPHABET_CHARACTERS;
-
-            game.playerName[game.gameOverHPositionCursor] = 'A' + game.gameOverVPositionCursor[game.gameOverHPositionCursor];
-        }
-        break;
-    case ' ': 
-        if (game.currentState == GS_PLAY)
-        {
-            PlayerShoot(player);
-        }
-        else if (game.currentState == GS_PLAYER_DEAD)
-        {
-            player.lives--;
-            player.animation = 0;
-            if (player.lives == 0)
-            {
-                game.currentState = GS_GAME_OVER;
-
-                ResetGameOverPositionCursors(game);
-            }
-            else
-            {
-                game.currentState = GS_WAIT;
-                game.waitTimer = 10;
-            }
-        }
-        else if (game.currentState == GS_GAME_OVER)
-        {
-            game.playerName[MAX_NUMBER_OF_CHARACTERS_IN_NAME] = '\0';
-            AddHighScore(table, player.score, std::string(game.playerName));
-            game.currentState = GS_HIGH_SCORE;
-        }
-        else if (game.currentState == GS_HIGH_SCORE)
-        {
-            game.currentState = GS_INTRO;
-            ResetGame(game, player, aliens, shields, numberOfShields);
-        }
-        else if (game.currentState == GS_INTRO)
-        {
-            game.currentState = GS_PLAY;
-        }
-        break;
-    }
-
-    return input;
-}
-
-void UpdateGame(clock_t dt, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarm& aliens, AlienUFO& ufo)
-{
-    game.gameTimer += dt;
-
-    if (game.currentState == GS_PLAY)
-    {
-        UpdateMissile(player);
-
-        Position shieldCollisionPoint;
-
-        int shieldIndex = IsCollision(player.missile, shields, numberOfShields, shieldCollisionPoint);
-
-        if (shieldIndex != NOT_IN_PLAY)
-        {
-            ResetMissile(player);
-            ResolveShieldCollision(shields, shieldIndex, shieldCollisionPoint);
-        }
-
-        Position playerAlienCollisionPoint;
-        if (IsCollision(player, aliens, playerAlienCollisionPoint))
-        {
-            ResetMissile(player);
-            player.score += ResolveAlienCollision(aliens, playerAlienCollisionPoint);
-        }
-
-        if (UpdateAliens(game, aliens, player, shields, numberOfShields))
-        {
-            game.currentState = GS_PLAYER_DEAD;
-        }
-
-        if (aliens.numAliensLeft == 0)
-        {
-            game.level++;
-            game.level = (game.level % NUM_LEVELS) + 1;
-
-            game.currentState = GS_WAIT;
-            ResetGame(game, player, aliens, shields, numberOfShields);
-        }
-
-        if (ufo.position.x == NOT_IN_PLAY)
-        {
-            //put in play
-            if (game.gameTimer % 500 == 13)
-            {
-                PutUFOInPlay(game, ufo);
-            }
-        }
-        else
-        {
-            //update the ufo
-            if (IsCollision(player.missile, ufo.position, ufo.size))
-            {
-                player.score += ufo.points;
-                ResetMissile(player);
-                ResetUFO(game, ufo);
-            }
-            else
-            {
-                UpdateUFO(game, ufo);
-            }
-        }
-    }
-    else if (game.currentState == GS_PLAYER_DEAD)
-    {
-        player.animation = (player.animation + 1) % 2;
-    }
-    else if (game.currentState == GS_WAIT)
-    {
-            game.currentState = GS_PLAY;
-    }
-}
-
-void DrawGame(const Game& game, const Player& player, Shield shields[], int numberOfShields, const AlienSwarm& aliens, const AlienUFO& ufo, const HighScoreTable& table)
-{
-    if (game.currentState == GS_PLAY || game.currentState == GS_PLAYER_DEAD || game.currentState == GS_WAIT) // if we're playing game, and player is hit, or we're waiting
-    {
-        if (game.currentState == GS_PLAY || game.currentState == GS_WAIT)
-        {
-            DrawPlayer(player, PLAYER_SPRITE);
-        }
-        else
-        {
-            DrawPlayer(player, PLAYER_EXPLOSION_SPRITE);
-        }
-
-        DrawShileds(shields, numberOfShields);
-
-        DrawAliens(aliens);
-
-        DrawUFO(ufo);
-    }
-    else if(game.currentState == GS_GAME_OVER)
-    {
-        DrawGameOverScreen(game);
-    }
-    else if (game.currentState == GS_INTRO)
-    {
-        DrawIntroScreen(game);
-    }
-    else if (game.currentState == GS_HIGH_SCORE)
-    {
-        DrawHighScoreTable(game, table);
-    }
-}
-
-void MovePlayer(const Game& game, Player& player, int dx)
-{
-    if (player.position.x + player.spriteSize.width + dx > game.windowSize.width) // check if player would move offscreen to the right
-    {
-        player.position.x = game.windowSize.width - player.spriteSize.width; // right most position player can be
-    }
-    else if (player.position.x + dx < 0) // The player is off the screen to the left
-    {
-        player.position.x = 0;
-    }
-    else
-    {
-        player.position.x += dx;
-    }
-}
-
-void PlayerShoot(Player& player)
-{
-    if (player.missile.x == NOT_IN_PLAY || player.missile.y == NOT_IN_PLAY)
-    {
-        player.missile.y = player.position.y - 1; // one row above the player
-        player.missile.x = player.position.x + player.spriteSize.width / 2;
-    }
-}
-
-void DrawPlayer(const Player& player, const char* sprite[])
-{
-    DrawSprite(player.position.x, player.position.y, PLAYER_SPRITE, player.spriteSize.height, player.animation * player.spriteSize.height);
-
-    if (player.missile.x != NOT_IN_PLAY)
-    {
-        DrawCharacter(player.missile.x, player.missile.y, PLAYER_MISSILE_SPRITE);
-    }
-
-    mvprintw(0, 0, "SCORE: %i, LIVES: %i", player.score, player.lives);
-}
-
-void UpdateMissile(Player& player)
-{
-    if (player.missile.y != NOT_IN_PLAY)
-    {
-        player.missile.y -= PLAYER_MISSILE_SPEED;
-
-        if (player.missile.y < 0)
-        {
-            ResetMissile(player);
-        }
-    }
-}
-
-void DrawShileds(const Shield shields[], int numberOfShields)
-{
-    for (int i = 0; i < numberOfShields; i++)
-    {
-        const Shield& shield = shields[i];
-
-        DrawSprite(shield.position.x, shield.position.y, (const char**)shield.sprite, SHIELD_SPRITE_HEIGHT);
-    }
-}
-
-/* Shield Initialization functions */
-
-void InitShields(const Game& game, Shield shields[], int numberOfShields)
-{
-
-    for (int i = 0; i < numberOfShields; i++)
-    {
-        Shield& shield = shields[i];
-
-        for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
-        {
-            shield.sprite[row] = new char[SHIELD_SPRITE_WIDTH + 1];
-        }
-    }
-
-    ResetShields(game, shields, numberOfShields);
-}
-
-void CleanUpShields(Shield shields[], int numberOfShields)
-{
-    for (int i = 0; i < numberOfShields; i++)
-    {
-        Shield& shield = shields[i];
-
-        for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
-        {
-            delete[] shield.sprite[row];
-        }
-    }
-}
-
-/* Collision functions */
-
-int IsCollision(const Position& projectile, const Shield shields[], int numberOfShields, Position& shieldCollisionPoint)
-{
-    shieldCollisionPoint.x = NOT_IN_PLAY;
-    shieldCollisionPoint.y = NOT_IN_PLAY;
-
-    if (projectile.y != NOT_IN_PLAY)
-    {
-        for (int i = 0; i < numberOfShields; i++)
-        {
-            const Shield& shield = shields[i];
-
-            if ( 
-                (projectile.x >= shield.position.x && projectile.x < (shield.position.x + SHIELD_SPRITE_WIDTH) ) //in line horizaontally
-                && (projectile.y >= shield.position.y && projectile.y < (shield.position.y + SHIELD_SPRITE_HEIGHT) )  //in line vertically
-                && ( shield.sprite[projectile.y - shield.position.y][projectile.x - shield.position.x] != ' ') //does it collide with part of the shield or collide with empty space
-                )  
-            {
-                shieldCollisionPoint.x = projectile.x - shield.position.x;
-                shieldCollisionPoint.y = projectile.y - shield.position.y;
-                return i;
-            }
-        }
-    }
-
-    return NOT_IN_PLAY;
-}
-
-void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollisionPoint)
-{
-    shields[shieldIndex].sprite[shieldCollisionPoint.y][shieldCollisionPoint.x] = ' ';
-}
-
-/* Alien Init and Draw functions */
-
-void InitAliens(const Game& game, AlienSwarm& aliens)
-{
-    for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-    {
-        for (int col = 0; col < NUM_ALIEN_COLUMNS; col++)
-        {
-            aliens.aliens[row][col] = AS_ALIVE;
-        }
-    }
-
-    ResetMovementTime(aliens);
-
-    aliens.direction = 1;
-    aliens.numAliensLeft = NUM_ALIEN_ROWS * NUM_ALIEN_COLUMNS;
-    aliens.animation = 0;
-    aliens.spriteSize.width = ALIEN_SPRITE_WIDTH;
-    aliens.spriteSize.height = ALIEN_SPRITE_HEIGHT;
-    aliens.numberOfBombsInPlay = 0;
-    aliens.position.x = (game.windowSize.width - NUM_ALIEN_COLUMNS * (aliens.spriteSize.width + ALIENS_X_PADDING)) / 2;
-    aliens.position.y = game.windowSize.height - NUM_ALIEN_COLUMNS - NUM_ALIEN_ROWS * aliens.spriteSize.height - ALIENS_Y_PADDING * ( NUM_ALIEN_ROWS - 1 ) - 3 + game.level;
-    aliens.line = NUM_ALIEN_COLUMNS - (game.level - 1);
-    aliens.explosionTimer = NOT_IN_PLAY;
-
-    for (int i = 0; i < MAX_NUMBER_OF_ALIEN_BOMBS; i++)
-    {
-        aliens.bombs[i].animation = 0;
-        aliens.bombs[i].position.x = NOT_IN_PLAY;
-        aliens.bombs[i].position.y = NOT_IN_PLAY;
-    }
-}
-
-void DrawAliens(const AlienSwarm& aliens)
-{
-    const int NUM_30_POINT_ALIEN_ROWS = 1;
-
-    for (int col = 0; col < NUM_ALIEN_COLUMNS; col++)
-    {
-        int xPos = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-        int yPos = aliens.position.y;
-
-        if (aliens.aliens[0][col] == AS_ALIVE)
-        {
-            DrawSprite(xPos, yPos, ALIEN30_SPRITE, aliens.spriteSize.height, aliens.animation*aliens.spriteSize.height);
-        }
-        else if (aliens.aliens[0][col] == AS_EXPLODING)
-        {
-            DrawSprite(xPos, yPos, ALIEN_EXPLOSION, aliens.spriteSize.height);
-        }
-
-    }
-
-    const int NUM_20_POINT_ALIEN_ROWS = 2;
-
-    for (int row = 0; row < NUM_20_POINT_ALIEN_ROWS; row++)
-    {
-        for (int col = 0; col < NUM_ALIEN_COLUMNS; col++)
-        {
-            int xPos = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-            int yPos = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING) + NUM_30_POINT_ALIEN_ROWS * (aliens.spriteSize.height + ALIENS_Y_PADDING);
-
-            if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + row][col] == AS_ALIVE)
-            {
-                DrawSprite(xPos, yPos, ALIEN20_SPRITE, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
-            }
-            else if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + row][col] == AS_EXPLODING)
-            {
-                DrawSprite(xPos, yPos, ALIEN_EXPLOSION, aliens.spriteSize.height);
-            }
-        }
-
-    }
-
-    const int NUM_10_POINT_ALIEN_ROWS = 2;
-
-    for (int row = 0; row < NUM_10_POINT_ALIEN_ROWS; row++)
-    {
-        for (int col = 0; col < NUM_ALIEN_COLUMNS; col ++)
-        {
-            int xPos = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-            int yPos = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING) + NUM_30_POINT_ALIEN_ROWS * (aliens.spriteSize.height + ALIENS_Y_PADDING) + NUM_20_POINT_ALIEN_ROWS * (aliens.spriteSize.height + ALIENS_Y_PADDING);
-
-            if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + NUM_20_POINT_ALIEN_ROWS + row][col] == AS_ALIVE)
-            {
-                DrawSprite(xPos, yPos, ALIEN10_SPRITE, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
-            }
-            else if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + NUM_20_POINT_ALIEN_ROWS + row][col] == AS_EXPLODING)
-            {
-                DrawSprite(xPos, yPos, ALIEN_EXPLOSION, aliens.spriteSize.height);
-            }
-        }
-    }
-
-    if (aliens.numberOfBombsInPlay > 0)
-    {
-        for (int i = 0; i < MAX_NUMBER_OF_ALIEN_BOMBS; i++)
-        {
-            if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
-            {
-                DrawCharacter(aliens.bombs[i].position.x, aliens.bombs[i].position.y, ALIEN_BOMB_SPRITE[aliens.bombs[i].animation]);
-            }
-        }
-    }
-
-}
-
-/* Alien Collisions */
-
-bool IsCollision(const Player& player, const AlienSwarm& aliens, Position& alienCollisionPositionInArray)
-{
-    alienCollisionPositionInArray.x = NOT_IN_PLAY;
-    alienCollisionPositionInArray.y = NOT_IN_PLAY;
-
-    for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-    {
-        for (int col = 0; col < NUM_ALIEN_COLUMNS; col++)
-        {
-            int xPos = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-            int yPos = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING);
-
-            if (aliens.aliens[row][col] == AS_ALIVE &&
-                player.missile.x >= xPos && player.missile.x < xPos + aliens.spriteSize.width &&
-                player.missile.y >= yPos && player.missile.y < yPos + aliens.spriteSize.height) // is the missile within the x boundary of the current alien
-            {
-                alienCollisionPositionInArray.x = col;
-                alienCollisionPositionInArray.y = row;
-                return true;
-            }
-        }
-    }
-
-    return false;
-      
-}
-
-int ResolveAlienCollision(AlienSwarm& aliens, const Position& hitPositionInAliensArray)
-{
-    aliens.aliens[hitPositionInAliensArray.y][hitPositionInAliensArray.x] = AS_EXPLODING;
-    aliens.numAliensLeft--;
-
-    if (aliens.explosionTimer == NOT_IN_PLAY)
-    {
-        aliens.explosionTimer = ALIEN_EXPLOSION_TIME;
-    }
-
-    if (hitPositionInAliensArray.y == 0)
-    {
-        return 30;
-    }
-    else if (hitPositionInAliensArray.y >= 1 && hitPositionInAliensArray.y < 3)
-    {
-        return 20;
-    }
-    else
-    {
-        return 10;
-    }
-}
-
-bool UpdateAliens(Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields)
-{
-    if (UpdateBombs(game, aliens, player, shields, numberOfShields)) // If a player was hit
-    {
-        return true;
-    }
-
-    if (aliens.explosionTimer >= 0)
-    {
-        aliens.explosionTimer--; // if explosionTimer == 0, then explosionTimer will be set to NOT_IN_PLAY
-    }
-
-    for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-    {
-        for (int col = 0; col < NUM_ALIEN_COLUMNS; col++)
-        {
-            if (aliens.aliens[row][col] == AS_EXPLODING && aliens.explosionTimer == NOT_IN_PLAY)
-            {
-                aliens.aliens[row][col] = AS_DEAD;
-            }
-        }
-    }
-
-    /* Alien Movement */
-
-    aliens.movementTime--;
-
-    bool moveHorizontal = 0 >= aliens.movementTime; // if movementTime = 0, move horizontally
-    int emptyColsLeft = 0;
-    int emptyColsRight = 0;
-    int emptyRowsBottom = 0;
-
-    FindEmptyRowsAndColumns(aliens, emptyColsLeft, emptyColsRight, emptyRowsBottom);
-
-    int numberOfColumns = NUM_ALIEN_COLUMNS - emptyColsLeft - emptyColsRight;
-    int leftAlienPosition = aliens.position.x + emptyColsLeft * (aliens.spriteSize.width + ALIENS_X_PADDING);
-    int rightAlienPosition = leftAlienPosition + numberOfColumns * aliens.spriteSize.width + (numberOfColumns - 1) * ALIENS_Y_PADDING;
-
-    if (((rightAlienPosition >= game.windowSize.width && aliens.direction > 0) || (leftAlienPosition <= 0 && aliens.direction < 0)) && moveHorizontal&& aliens.line > 0)
-    {
-        //move down
-        moveHorizontal = false;
-        aliens.position.y++;
-        aliens.line--;
-        aliens.direction = -aliens.direction;
-        ResetMovementTime(aliens);
-        DestoryShields(aliens, shields, numberOfShields);
-
-        if (aliens.line == 0)
-        {
-            game.currentState = GS_GAME_OVER;
-            return false;
-        }
-    }
-
-    if (moveHorizontal)
-    {
-        aliens.position.x += aliens.direction;
-        ResetMovementTime(aliens);
-        aliens.animation = aliens.animation == 0 ? 1 : 0;
-        DestoryShields(aliens, shields, numberOfShields);
-    }
-
-    if (!moveHorizontal)
-    {
-        int activeColumns[NUM_ALIEN_COLUMNS]; // columns that still exist - some aliens are still alive in that column
-
-        int numActiveCols = 0;
-
-        for (int col = emptyColsLeft; col < numberOfColumns; col++)
-        {
-            for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-            {
-                if (aliens.aliens[row][col] == AS_ALIVE)
-                {
-                    activeColumns[numActiveCols] = col;
-                    numActiveCols++;
-                    break;
-                }
-            }
-        }
-        if (ShouldShootBomb(aliens))
-        {
-            if (numActiveCols > 0)
-            {
-                int numberOfShots = ((rand() % 3) + 1) - aliens.numberOfBombsInPlay; // makes sure that there are only 3 bombs in play
-
-                for (int i = 0; i < numberOfShots; i++)
-                {
-                    int columnToShoot = rand() % numActiveCols;
-
-                    ShootBomb(aliens, columnToShoot);
-                }
-            }
-        }
-    }
-    return false; // no player was hit
-}
-
-/* Alien Moveent Functions */
-
-void ResetMovementTime(AlienSwarm& aliens)
-{
-    aliens.movementTime = aliens.line * 2 + (5 * (float(aliens.numAliensLeft) / float(NUM_ALIEN_COLUMNS * NUM_ALIEN_ROWS))); // this formula can be changed, doesn't affect anything negatively
-}
-
-void FindEmptyRowsAndColumns(const AlienSwarm& aliens, int& emptyColsLeft, int& emptyColsRight, int& emptyRowsBottom)
-{
-    bool found = false;
-
-    for (int col = 0; col < NUM_ALIEN_COLUMNS && !found; col++)
-    {
-        for (int row = 0; row < NUM_ALIEN_ROWS && !found; row++)
-        {
-            if ((aliens.aliens[row][col] == AS_DEAD))
-            {
-                if (row == NUM_ALIEN_ROWS - 1) //last row
-                {
-                    emptyColsLeft++;
-                }
-            }
-            else
-            {
-                found = true;
-            }
-        }
-    }
-
-    found = false;
-
-    for (int col = NUM_ALIEN_COLUMNS - 1; col >= 0 && !found; col--)
-    {
-        for (int row = 0; row < NUM_ALIEN_ROWS && !found; row++)
-        {
-            if (aliens.aliens[row][col] == AS_DEAD)
-            {
-                if (row == NUM_ALIEN_ROWS - 1)
-                {
-                    emptyColsRight++;
-                }
-            }
-            else
-            {
-                found = true;
-            }
-        }
-    }
-
-    found = false;
-
-    for (int row = NUM_ALIEN_ROWS - 1; row >= 0 && !found; row--)
-    {
-        for (int col = 0; col < NUM_ALIEN_COLUMNS && !found; col++)
-        {
-            if (aliens.aliens[row][col] == AS_DEAD)
-            {
-                if (col == NUM_ALIEN_COLUMNS - 1)
-                {
-                    emptyRowsBottom++;
-                }
-            }
-            else
-            {
-                found = true;
-            }
-        }
-    }
-}
-
-/* Aliens vs Shields functions */
-
-void DestoryShields(const AlienSwarm& aliens, Shield shields[], int numberOfShields)
-{
-    for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-    {
-        for (int col = 0; col < NUM_ALIEN_COLUMNS; col++)
-        {
-            if (aliens.aliens[row][col] == AS_ALIVE)
-            {
-                int xPos = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-                int yPos = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING);
-
-                CollideShieldsWithAlien(shields, numberOfShields, xPos, yPos, aliens.spriteSize);
-            }
-        }
-    }
-}
-
-void CollideShieldsWithAlien(Shield shields[], int numberOfShields, int alienPositionX, int alienPositionY, const Size& size)
-{
-    for (int s = 0; s < numberOfShields; s++)
-    {
-        Shield& shield = shields[s];
-
-        if (alienPositionX < shield.position.x + SHIELD_SPRITE_WIDTH && alienPositionX + size.width >= shield.position.x && //If left edge of alien is less than right most edge of shield and the right most edge of alien is greater than left edge of shield
-            alienPositionY < shield.position.y + SHIELD_SPRITE_HEIGHT && alienPositionY + size.height >= shield.position.y)
-        {
-            int dy = alienPositionY - shield.position.y;
-            int dx = alienPositionX - shield.position.x;
-
-            for (int h = 0; h < size.height; h++)
-            {
-                int shieldY = dy + h;
-                if (shieldY >= 0 && shieldY < SHIELD_SPRITE_HEIGHT)
-                {
-                    for (int w = 0; w < size.width; w++)
-                    {
-                        int shieldX = dx + w;
-
-                        if (shieldX >= 0 && shieldX < SHIELD_SPRITE_WIDTH)
-                        {
-                            shield.sprite[shieldY][shieldX] = ' ';
-                        }
-                    }
-                }
-            }
-            break;
-        }
-    }
-}
-
-bool ShouldShootBomb(const AlienSwarm& aliens)
-{
-    return int(rand() % (70 - int(float(NUM_ALIEN_ROWS * NUM_ALIEN_COLUMNS) / float(aliens.numAliensLeft + 1)))) == 1;
-}
-
-void ShootBomb(AlienSwarm& aliens, int columnToShoot)
-{
-    int bombId = NOT_IN_PLAY;
-
-    for (int i = 0; i < MAX_NUMBER_OF_ALIEN_BOMBS; i++)
-    {
-        if (aliens.bombs[i].position.x == NOT_IN_PLAY || aliens.bombs[i].position.y == NOT_IN_PLAY)
-        {
-            bombId = i;
-            break;
-        }
-    }
-
-    for (int row = NUM_ALIEN_ROWS - 1; row >= 0; row--)
-    {
-        if (aliens.aliens[row][columnToShoot] == AS_ALIVE)
-        {
-            int xPos = aliens.position.x + columnToShoot * (aliens.spriteSize.width + ALIENS_X_PADDING) + 1; // middle of the alien
-            int yPos = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING) + aliens.spriteSize.height; // bottom of the alien
-
-            aliens.bombs[bombId].animation = 0;
-            aliens.bombs[bombId].position.x = xPos;
-            aliens.bombs[bombId].position.y = yPos;
-            aliens.numberOfBombsInPlay++;
-            break;
-        }
-    }
-}
-
-bool UpdateBombs(const Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields)
-{
-    int numBombSprites = strlen(ALIEN_BOMB_SPRITE);
-
-    for (int i = 0; i < MAX_NUMBER_OF_ALIEN_BOMBS; i++)
-    {
-        if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
-        {
-            aliens.bombs[i].position.y += ALIEN_BOMB_SPEED;
-
-            aliens.bombs[i].animation = (aliens.bombs[i].animation + 1) % numBombSprites;
-
-            Position collisionPoint;
-            int shieldIndex = IsCollision(aliens.bombs[i].position, shields, numberOfShields, collisionPoint);
-
-            if (shieldIndex != NOT_IN_PLAY)
-            {
-                aliens.bombs[i].position.x = NOT_IN_PLAY;
-                aliens.bombs[i].position.y = NOT_IN_PLAY;
-                aliens.bombs[i].animation = 0;
-                aliens.numberOfBombsInPlay--;
-                ResolveShieldCollision(shields, shieldIndex, collisionPoint);
-            }
-            else if (IsCollision(aliens.bombs[i].position, player.position, player.spriteSize))
-            {
-                aliens.bombs[i].position.x = NOT_IN_PLAY;
-                aliens.bombs[i].position.y = NOT_IN_PLAY;
-                aliens.bombs[i].animation = 0;
-                aliens.numberOfBombsInPlay--;
-                return true;
-            }
-            else if (aliens.bombs[i].position.y >= game.windowSize.height)
-            {
-                aliens.bombs[i].position.x = NOT_IN_PLAY;
-                aliens.bombs[i].position.y = NOT_IN_PLAY;
-                aliens.animation = 0;
-                aliens.numberOfBombsInPlay--;
-            }
-        }
-    }
-    return false;
-}
-
-/* Aliens vs player */
-
-bool IsCollision(const Position& projectile, const Position& spritePosition, const Size& spriteSize)
-{
-    return (projectile.x >= spritePosition.x && projectile.x < (spritePosition.x + spriteSize.width) &&
-        projectile.y >= spritePosition.y && projectile.y < (spritePosition.y + spriteSize.height));
-}
-
-/* Restting Game */
-
-void ResetGame(Game& game, Player& player, AlienSwarm& aliens, Shield shields[], int numberOfShields)
-{
-    game.waitTimer = 0;
-    game.gameTimer = 0;
-    ResetPlayer(game, player);
-    ResetShields(game, shields, numberOfShields);
-    InitAliens(game, aliens);
-}
-
-void ResetShields(const Game& game, Shield shields[], int numberOfShields)
-{
-    int firstPadding = ceil(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH) / float(numberOfShields + 1));
-    int xPadding = floor(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH) / float(numberOfShields + 1));
-
-    for (int i = 0; i < numberOfShields; i++)
-    {
-        Shield& shield = shields[i];
-        shield.position.x = firstPadding + i * (SHIELD_SPRITE_WIDTH + xPadding);
-        shield.position.y = game.windowSize.height - PLAYER_SPRITE_HEIGHT - 1 - SHIELD_SPRITE_HEIGHT - 2;
-
-        for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
-        {
-            strcpy(shield.sprite[row], SHIELD_SPRITE[row]);
-        }
-    }
-}
-
-/* Game States */
-
-void DrawGameOverScreen(const Game& game)
-{
-    string gameOverString = "GAME OVER!";
-    string pressSpaceString = "Press Space Bar to continue";
-
-    string namePromptString = "Please Enter your name: ";
-
-    const int yPos = game.windowSize.height / 3;
-    
-    const int gameOverXPos = game.windowSize.width / 2 - gameOverString.length() / 2;
-    const int pressSpaceXPos = game.windowSize.width / 2 - pressSpaceString.length() / 2;
-    const int namePromptXPos = game.windowSize.width / 2 - namePromptString.length() / 2;
-
-    DrawString(gameOverXPos, yPos, gameOverString);
-    DrawString(pressSpaceXPos, yPos + 1, pressSpaceString);
-    DrawString(namePromptXPos, yPos + 3, namePromptString);
-
-    for (int i = 0; i < MAX_NUMBER_OF_CHARACTERS_IN_NAME; i++)
-    {
-        if (i == game.gameOverHPositionCursor)
-        {
-            attron(A_UNDERLINE);
-        }
-
-        DrawCharacter(game.windowSize.width / 2 - MAX_NUMBER_OF_CHARACTERS_IN_NAME / 2 + i, yPos + 5, game.playerName[i]);
-
-        if (i == game.gameOverHPositionCursor)
-        {
-            attroff(A_UNDERLINE);
-        }
-    }
-}
-
-void DrawIntroScreen(const Game& game)
-{
-    string startString = "WELCOME TO TEXT INVADERS!";
-    string pressSpaceString = "Press Space Bar to continue";
-    string pressSString = "Press (s) to go to the high scores";
-
-    const int yPos = game.windowSize.height / 2 - 2;
-    const int startStringXPos = game.windowSize.width / 2 - startString.length() / 2;
-    const int pressSpaceXPos = game.windowSize.width / 2 - pressSpaceString.length() / 2;
-    const int pressSXPos = game.windowSize.width / 2 - pressSString.length() / 2;
-
-    DrawString(startStringXPos, yPos, startString);
-    DrawString(pressSpaceXPos, yPos + 1, pressSpaceString);
-    DrawString(pressSXPos, yPos + 2, pressSString);
-}
-
-/* UFO functions */
-
-void ResetUFO(const Game& game, AlienUFO& ufo)
-{
-    ufo.size.width = ALIEN_UFO_SPRITE_WIDTH;
-    ufo.size.height = ALIEN_UFO_SPRITE_HEIGHT;
-
-    ufo.points = ((rand() % 4) + 1) * 50;
-
-    ufo.position.x = NOT_IN_PLAY; // no UFO on screen, only moves left to right
-    ufo.position.y = ufo.size.height; // so it starts 2 down from top of screen
-}
-
-void PutUFOInPlay(const Game& game, AlienUFO& ufo)
-{
-    ufo.position.x = 0;
-}
-
-void UpdateUFO(const Game& game, AlienUFO& ufo)
-{
-    ufo.position.x += 1;
-
-    if (ufo.position.x + ufo.size.width >= game.windowSize.width)
-    {
-        ResetUFO(game, ufo);
-    }
-}
-
-void DrawUFO(const AlienUFO& ufo)
-{
-    if (ufo.position.x != NOT_IN_PLAY)
-    {
-        DrawSprite(ufo.position.x, ufo.position.y, ALIEN_UFO_SPRITE, ALIEN_SPRITE_HEIGHT);
-    }
-}
-
-/* Reset Game Over Cursor */
-
-void ResetGameOverPositionCursors(Game& game)
-{
-    game.gameOverHPositionCursor = 0;
-    for (int i = 0; i < MAX_NUMBER_OF_CHARACTERS_IN_NAME; i++)
-    {
-        game.playerName[i] = 'A';
-        game.gameOverVPositionCursor[i] = 0;
-    }
-}
-
-/* HighScore Table */
-
-void AddHighScore(HighScoreTable& table, int score, const string& name)
-{
-    Score highScore;
-    highScore.score = score;
-    highScore.name = name;
-
-    table.scores.push_back(highScore);
-
-    sort(table.scores.begin(), table.scores.end(), ScoreCompare);
-
-    SaveHighScores(table);
-}
-
-bool ScoreCompare(const Score& score1, const Score score2)
-{
-    return score1.score > score2.score; // descending order (highest score will be top)
-}
-
-void DrawHighScoreTable(const Game& game, const HighScoreTable& table)
-{
-    string title = "High Scores";
-    int titleXPos = game.windowSize.width / 2 - title.length()/2;
-    int yPos = 5;
-    int yPadding = 2;
-
-    attron(A_UNDERLINE);
-    DrawString(titleXPos, yPos, title);
-    attroff(A_UNDERLINE);
-
-    for (int i = 0; i < table.scores.size() && i < MAX_HIGH_SCORES; i++)
-    {
-        Score score = table.scores[i];
-        mvprintw(yPos + (i + 1) * yPadding, titleXPos - MAX_NUMBER_OF_CHARACTERS_IN_NAME, "%s\t\t%i", score.name.c_str(), score.score);
-    }
-}
-
-void SaveHighScores(const HighScoreTable& table)
-{
-    ofstream outFile;
-    outFile.open(FILE_NAME);
-    if (outFile.is_open())
-    {
-        for (int i = 0; i < table.scores.size() && i < MAX_HIGH_SCORES; i++)
-        {
-            outFile << table.scores[i].name << " " << table.scores[i].score << endl;
-        }
-
-        outFile.close();
-    }
-}
-
-void LoadHighScores(HighScoreTable& table)
-{
-    ifstream inFile;
-    inFile.open(FILE_NAME);
-
-    string name;
-    int scoreVal;
-
-    Score score;
-
-    if (inFile.is_open())
-    {
-        while (!inFile.eof())
-        {
-            inFile >> ws;
-            if (inFile.eof())
-            {
-                break;
-            }
-
-            inFile >> name >> scoreVal;
-            score.name = name;
-            score.score = scoreVal;
-
-            table.scores.push_back(score);
-        }
-
-        inFile.close();
-    }
-}
\ No newline at end of file
+// TextInvaders.cpp : This file contains the 'main' function. Program execution begins and ends there.
+//
+
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <ctime>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm> // for sorting
+#include <fstream> // for files
+#include <utility> // for pair
+
+#include "CursesUtils.h"
+#include "TextInvaders.h"
+#include "LevelTables.h"
+#include "SpriteMasks.h"
+#include "FrameExport.h"
+#include "SpectatorBroadcast.h"
+#include "FrameRecording.h"
+#include "RewindBuffer.h"
+#include "InputReplay.h"
+#include "StateHash.h"
+#include "StressSwarm.h"
+#include "ProjectilePool.h"
+#include "RawInput.h"
+#include "LatencyTracer.h"
+#include "GameServer.h"
+#include "LoadGenerator.h"
+#include "Netplay.h"
+#include "ScoreService.h"
+
+
+using namespace std;
+
+/* Initialize game and player */
+
+void InitGame(Game& game, unsigned int seed);
+void InitPlayer(const Game& game, Player& player);
+void ResetPlayer(const Game& game, Player& player);
+void ResetMissile(Player& player);
+
+/* Game Loop Functions */
+
+template<class Config>
+int HandleInput(const InputEvent& event, Game& game, Player& player, AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields, HighScoreTable& table); // returns the key
+template<class Config>
+void ProcessInput(int input, Game& game, Player& player, AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields, HighScoreTable& table);
+template<class Config>
+void UpdateGame(clock_t dt, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens, AlienUFO& ufo);
+template<class Config>
+void DrawGame(const Game& game, const Player& player, Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo, const HighScoreTable& table);
+template<class Config>
+void UpdateTimers(Game& game, AlienSwarmT<Config>& aliens, AlienUFO& ufo);
+void StartWait(Game& game, int waitTime);
+void ScheduleGameTimer(Game& game, TimerType type, int data, int classicTicks); // the wheel counts the game's ticks, tickRate / FPS to a classic tick
+int FixedPointStep(const Game& game, int speed); // how far something going speed (fixed point cells a classic tick) goes this tick
+bool IsLastSubTick(const Game& game); // the classic tick ends with this one
+bool IsTickDue(const Game& game, clock_t& lastTime, clock_t& dt); // dt is the clock ticks the tick stands for
+int TicksPerFrame(const Game& game); // ticks from one drawn frame to the next, so no more than MAX_DRAW_RATE are drawn a second
+void MovePlayer(const Game& game, Player& player, int dx);
+void PlayerShoot(Player& player);
+void DrawPlayer(const Player& player, const char* const sprite[]);
+template<class Config>
+int UpdateMissile(Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens); // returns how many cells the missile went without hitting anything - the UFO is tested along them later
+template<class Config>
+int MoveMissile(Game& game, Position& missile, int& missileY, int& score, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens); // the same for any missile in flight - it is NOT_IN_PLAY once it has hit something or gone off the top
+void DrawShileds(const Shield shields[], int numberOfShields);
+
+/* Shield Initializations */
+
+void InitShields(const Game& game, Shield shields[], int numberOfShields);
+
+/* Collision functions */
+
+// A projectile moving direction (-1 up, 1 down) goes through distance cells in a tick - from.y + direction, from.y + 2 * direction...
+// Everything it could hit is swept along all of them, so it cannot jump over anything at any speed. The sweeps return
+// how many cells along the first hit is, 0 if there is none.
+
+bool FindSweepSpan(const Position& from, int direction, int distance, int top, int height, int& first, int& last); // the cells along that are between top and top + height, returns false if there are none
+int SweepShields(const Position& from, int direction, int distance, const Shield shields[], int numberOfShields, int& shieldIndex, Position& shieldCollisionPoint); // shieldIndex of the shield hit, shield collision point
+void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollisionPoint);
+
+/* Aliens Initialize and Draw functions */
+
+template<class Config>
+void InitAliens(Game& game, AlienSwarmT<Config>& aliens);
+template<class Config>
+void DrawAliens(const AlienSwarmT<Config>& aliens);
+
+/* Alien Collisions */
+
+template<class Config>
+int SweepAliens(const Position& from, int direction, int distance, const AlienSwarmT<Config>& aliens, Position& alienCollisionPositionInArray);
+template<class Config>
+int ResolveAlienCollision(Game& game, AlienSwarmT<Config>& aliens, const Position& hitPositionInAliensArray);
+template<class Config>
+bool UpdateAliens(Game& game, AlienSwarmT<Config>& aliens, Player& player, Shield shields[], int numberOfShields);
+
+/* Alien Movement */
+
+template<class Config>
+void ResetMovementTime(AlienSwarmT<Config>& aliens);
+void ResetMovementTime(StressSwarm& aliens);
+template<class Config>
+void ScheduleSwarmStep(Game& game, AlienSwarmT<Config>& aliens);
+template<class Config>
+void FindEmptyRowsAndColumns(const AlienSwarmT<Config>& aliens, int& emptyColsLeft, int& emptyColsRight, int& emptyRowsBottom);
+template<class Config>
+void FinishAlienExplosion(AlienSwarmT<Config>& aliens, int row, int col);
+template<class Config>
+int CountActiveColumns(const AlienSwarmT<Config>& aliens, int firstColumn, int endColumn); // columns in [firstColumn, endColumn) with an AS_ALIVE alien
+int CountActiveColumns(const StressSwarm& aliens, int firstColumn, int endColumn);
+
+/* Swarm sizes and storage - constants for a GameConfig, the swarm's own for the stress swarm */
+
+template<class Config>
+int NumAlienRows(const AlienSwarmT<Config>& aliens);
+int NumAlienRows(const StressSwarm& aliens);
+template<class Config>
+int NumAlienColumns(const AlienSwarmT<Config>& aliens);
+int NumAlienColumns(const StressSwarm& aliens);
+template<class Config>
+int MaxAlienBombs(const AlienSwarmT<Config>& aliens);
+int MaxAlienBombs(const StressSwarm& aliens);
+template<class Config>
+int NumBombsInPlay(const AlienSwarmT<Config>& aliens);
+int NumBombsInPlay(const StressSwarm& aliens);
+template<class Config>
+int BombChanceDivisor(const AlienSwarmT<Config>& aliens); // the swarm shoots when DrawGameRandom() % divisor == 1
+int BombChanceDivisor(const StressSwarm& aliens);
+template<class Config>
+void StartAlienExplosion(Game& game, AlienSwarmT<Config>& aliens, int row, int col); // FinishAlienExplosion is called ALIEN_EXPLOSION_TIME classic ticks later
+void StartAlienExplosion(Game& game, StressSwarm& aliens, int row, int col);
+template<class Config>
+void RemoveAliveColumn(AlienSwarmT<Config>& aliens, int col); // the column has no AS_ALIVE alien left
+void RemoveAliveColumn(StressSwarm& aliens, int col);
+int AlienRowPoints(int row, int numRows); // 30, 20 or 10
+
+/* Aliens vs Shields functions */
+
+template<class Config>
+void DestoryShields(const AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields);
+void CollideShieldsWithAlien(Shield shields[], int numberOfShields, int xPos, int yPos, const Size& size);
+template<class Config>
+bool ShouldShootBomb(GameRandom& random, const AlienSwarmT<Config>& aliens);
+template<class Config>
+void ShootBombs(GameRandom& random, AlienSwarmT<Config>& aliens, int emptyColsLeft, int numberOfColumns); // the random bomb draw, every classic tick the swarm does not step
+template<class Config>
+void ShootBomb(AlienSwarmT<Config>& aliens, int columnToShoot);
+void ShootBomb(StressSwarm& aliens, int columnToShoot);
+template<class Config>
+bool UpdateBombs(const Game& game, AlienSwarmT<Config>& aliens, Player& player, Shield shields[], int numberOfShields);
+bool UpdateBombs(const Game& game, StressSwarm& aliens, Player& player, Shield shields[], int numberOfShields);
+BombFall DropBomb(const Game& game, Position& position, int& y, int& animation, const Player& player, Shield shields[], int numberOfShields); // one bomb in flight, for either - it takes out the part of a shield it hits
+
+/* Aliens vs Player */
+
+int SweepSprite(const Position& from, int direction, int distance, const Position& spritePosition, const Size& spriteSize, const SpriteMask& mask); // only the solid cells of the sprite
+
+/* Resetting the game */
+
+template<class Config>
+void ResetGame(Game& game, Player& player, AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields);
+void ResetShields(const Game& game, Shield shields[], int numberOfShields);
+
+/* Game States */
+
+void DrawGameOverScreen(const Game& game);
+void DrawIntroScreen(const Game& game);
+
+/* UFO functions */
+
+void ResetUFO(Game& game, AlienUFO& ufo);
+void PutUFOInPlay(const Game& game, AlienUFO& ufo);
+void UpdateUFO(Game& game, AlienUFO& ufo);
+void DrawUFO(const AlienUFO& ufo);
+
+/* Game Over Cursors */
+
+void ResetGameOverPositionCursors(Game& game);
+bool ScoreCompare(const Score& score1, const Score score2);
+
+/* HighScore table */
+
+void AddHighScore(HighScoreTable& table, int score, const string& name);
+void DrawHighScoreTable(const Game& game, const HighScoreTable& table);
+
+/* Read and Save Scores */
+
+void SaveHighScores(const HighScoreTable& table);
+void LoadHighScores(HighScoreTable& table);
+void UpdateHighScores(HighScoreTable& table); // takes in the score service's table, once a frame
+
+/* Replays */
+
+int RunReplay(const char* replayFileName, const char* hashLogFileName, bool fastForward, bool verifyFastForward, const GameVariant* variant, int tickRate);
+template<class Config>
+int ReplayGame(const InputReplay& replay, const char* hashLogFileName, bool fastForward, bool verifyFastForward); // every GameVariant's replay
+int CompareHashLogs(const char* fileNameA, const char* fileNameB); // with the variant the first one was written by
+template<class Config>
+void StartReplayGame(const InputReplay& replay, Game& game, Player& player, Shield shields[], AlienSwarmT<Config>& aliens, AlienUFO& ufo);
+template<class Config>
+uint64_t SimulateReplay(const InputReplay& replay, bool fastForward, StateHashLogT<Config>& hashLog, std::vector<std::pair<unsigned int, uint64_t> >* jumps, int& score, unsigned int& numUpdatedTicks);
+template<class Config>
+int SkipIdleTicks(Game& game, Player& player, AlienSwarmT<Config>& aliens, const AlienUFO& ufo, const unsigned int dts[], int maxTicks); // returns how many ticks it covered, 0 if the next one has to be run through UpdateGame
+
+/* Game variants */
+
+const GameVariant* FindGameVariant(const char* name); // nullptr if there is no such variant
+void PrintGameVariants(FILE* out);
+template<class Config>
+int PlayGameVariant(const GameVariant& variant, bool rawInput, const char* inputRecordingFileName, const char* hashLogFileName, bool practiceMode, int tickRate, unsigned int seed);
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = (unsigned int)time(NULL);
+    srand(seed);
+
+    const char* frameExportName = nullptr; // set with --export-frames [name], lets other processes watch the game
+    const char* spectatorSocketPath = nullptr; // set with --spectators [path], lets other terminals watch the game
+    const char* recordingFileName = nullptr; // set with --record file, saves what is drawn so it can be watched with --play file
+    bool practiceMode = false; // set with --practice, 'r' rewinds the game
+    const char* inputRecordingFileName = nullptr; // set with --record-inputs file, saves the inputs so --replay file can re-simulate the game
+    const char* hashLogFileName = nullptr; // set with --hash-log file, logs a hash of the game state every tick
+    const char* replayFileName = nullptr; // set with --replay file, re-simulates a game recorded with --record-inputs without a terminal
+    bool fastForward = false; // set with --fast-forward, replays jump over ticks where nothing happens
+    bool verifyFastForward = false; // set with --verify-fast-forward, checks those jumps against a tick by tick run
+    const GameVariant* variant = FindGameVariant("classic"); // set with --variant name
+    bool stressMode = false; // set with --stress [rowsxcolumns] or --bullet-hell [rowsxcolumns], plays the stress game instead
+    bool bulletHell = false;
+    const char* stressDimensions = nullptr;
+    int tickRate = FPS; // set with --tick-rate ticks, how many times a second the game ticks
+    bool rawInput = true; // cleared with --curses-input, keys come from getch instead of straight from the terminal
+    bool traceLatency = false; // set with --trace-latency [file], 'l' shows how long keys take to reach the screen
+    const char* latencyFileName = nullptr;
+    const char* serverSocketPath = nullptr; // set with --serve [path], hosts a game for every player that joins
+    int maxSessions = SERVER_MAX_SESSIONS; // set with --max-sessions sessions
+    int numShards = 0; // set with --shards shards, 0 for one per CPU
+    const char* joinSocketPath = nullptr; // set with --join [path], plays on a server
+    const char* loadTestSocketPath = nullptr; // set with --load-test [path], plays bots on a server and reports how it keeps up
+    const char* loadTestPlayers = "50,100,200"; // set with --load-players counts
+    int loadTestSeconds = LOAD_DEFAULT_SECONDS; // set with --load-seconds seconds
+    const char* versusSocketPath = nullptr; // set with --versus-host [path] or --versus-join [path], plays against one other player
+    bool versusHost = false;
+    int maxRollback = NETPLAY_DEFAULT_ROLLBACK; // set with --rollback ticks, how far ahead of the other player's keys a versus game runs
+    int netDelay = 0; // set with --net-delay milliseconds and --net-jitter milliseconds, holds back what a versus game sends
+    int netJitter = 0;
+    std::string userScoreServicePath = DefaultScoreServicePath(); // empty without $XDG_RUNTIME_DIR
+    const char* defaultScoreServicePath = userScoreServicePath.empty() ? "/tmp/TextInvadersScores.sock" : userScoreServicePath.c_str();
+    const char* scoreServicePath = nullptr; // set with --score-service [path], keeps one high score table for every instance
+    const char* scoreLogFileName = "TextInvadersScoreLog.txt"; // set with --score-log file
+    const char* submitScoresPath = userScoreServicePath.empty() ? nullptr : defaultScoreServicePath; // set with --submit-scores [path], the score service a game's scores go to if one answers there - the file if none does
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--export-frames") == 0)
+        {
+            frameExportName = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "/TextInvadersFrames";
+        }
+        else if (strcmp(argv[i], "--spectators") == 0)
+        {
+            spectatorSocketPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "/tmp/TextInvaders.sock";
+        }
+        else if (strcmp(argv[i], "--spectate") == 0)
+        {
+            return RunSpectator((i + 1 < argc && argv[i + 1][0] != '-') ? argv[i + 1] : "/tmp/TextInvaders.sock");
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordingFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--practice") == 0)
+        {
+            practiceMode = true;
+        }
+        else if (strcmp(argv[i], "--play") == 0 && i + 1 < argc)
+        {
+            return RunFramePlayback(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--record-inputs") == 0 && i + 1 < argc)
+        {
+            inputRecordingFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc)
+        {
+            hashLogFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replayFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--fast-forward") == 0)
+        {
+            fastForward = true;
+        }
+        else if (strcmp(argv[i], "--verify-fast-forward") == 0)
+        {
+            verifyFastForward = true;
+        }
+        else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc)
+        {
+            variant = FindGameVariant(argv[++i]);
+
+            if (variant == nullptr)
+            {
+                fprintf(stderr, "Unknown variant %s, the variants are:\n", argv[i]);
+                PrintGameVariants(stderr);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--stress") == 0 || strcmp(argv[i], "--bullet-hell") == 0)
+        {
+            stressMode = true;
+            bulletHell = strcmp(argv[i], "--bullet-hell") == 0;
+            stressDimensions = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : nullptr;
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            tickRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--curses-input") == 0)
+        {
+            rawInput = false;
+        }
+        else if (strcmp(argv[i], "--trace-latency") == 0)
+        {
+            traceLatency = true;
+            latencyFileName = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : nullptr;
+        }
+        else if (strcmp(argv[i], "--serve") == 0)
+        {
+            serverSocketPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "/tmp/TextInvadersServer.sock";
+        }
+        else if (strcmp(argv[i], "--max-sessions") == 0 && i + 1 < argc)
+        {
+            maxSessions = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc)
+        {
+            numShards = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--join") == 0)
+        {
+            joinSocketPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "/tmp/TextInvadersServer.sock";
+        }
+        else if (strcmp(argv[i], "--load-test") == 0)
+        {
+            loadTestSocketPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "/tmp/TextInvadersServer.sock";
+        }
+        else if (strcmp(argv[i], "--load-players") == 0 && i + 1 < argc)
+        {
+            loadTestPlayers = argv[++i];
+        }
+        else if (strcmp(argv[i], "--load-seconds") == 0 && i + 1 < argc)
+        {
+            loadTestSeconds = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--versus-host") == 0 || strcmp(argv[i], "--versus-join") == 0)
+        {
+            versusHost = strcmp(argv[i], "--versus-host") == 0;
+            versusSocketPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "/tmp/TextInvadersVersus.sock";
+        }
+        else if (strcmp(argv[i], "--rollback") == 0 && i + 1 < argc)
+        {
+            maxRollback = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--net-delay") == 0 && i + 1 < argc)
+        {
+            netDelay = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--net-jitter") == 0 && i + 1 < argc)
+        {
+            netJitter = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--score-service") == 0)
+        {
+            scoreServicePath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : defaultScoreServicePath;
+        }
+        else if (strcmp(argv[i], "--score-log") == 0 && i + 1 < argc)
+        {
+            scoreLogFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--submit-scores") == 0)
+        {
+            submitScoresPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : defaultScoreServicePath;
+        }
+        else if (strcmp(argv[i], "--benchmark-scores") == 0)
+        {
+            return RunScoreBenchmark((i + 1 < argc && argv[i + 1][0] != '-') ? argv[i + 1] : defaultScoreServicePath);
+        }
+        else if (strcmp(argv[i], "--compare-hash-logs") == 0 && i + 2 < argc)
+        {
+            return CompareHashLogs(argv[i + 1], argv[i + 2]);
+        }
+    }
+
+    if (tickRate != FPS && (scoreServicePath != nullptr || serverSocketPath != nullptr || joinSocketPath != nullptr || loadTestSocketPath != nullptr || versusSocketPath != nullptr))
+    {
+        fprintf(stderr, "--tick-rate only works with the classic game, --replay, --stress and --bullet-hell\n");
+        return 1;
+    }
+
+    if (scoreServicePath != nullptr)
+    {
+        return RunScoreService(scoreServicePath, scoreLogFileName);
+    }
+
+    ScoreClient scoreClient;
+    InitScoreClient(scoreClient, submitScoresPath != nullptr ? submitScoresPath : defaultScoreServicePath);
+
+    if (serverSocketPath != nullptr)
+    {
+        int scoreService = StartScoreService(scoreClient.path, scoreLogFileName); // unless one is running there already
+
+        if (scoreService < 0)
+        {
+            fprintf(stderr, "Could not start the score service on %s\n", scoreClient.path);
+            return 1;
+        }
+
+        HighScoreTable serverTable;
+        serverTable.fileName = nullptr; // never saved by a shard, they would each overwrite the others' scores
+        serverTable.service = &scoreClient; // each shard connects on its own
+        LoadHighScores(serverTable);
+
+        int result = RunGameServer(serverSocketPath, maxSessions, numShards, serverTable);
+        StopScoreService(scoreService);
+
+        return result;
+    }
+
+    if (joinSocketPath != nullptr)
+    {
+        return RunServerPlayer(joinSocketPath, rawInput);
+    }
+
+    if (loadTestSocketPath != nullptr)
+    {
+        return RunLoadTest(loadTestSocketPath, loadTestPlayers, loadTestSeconds);
+    }
+
+    if (versusSocketPath != nullptr)
+    {
+        return RunNetplay(versusSocketPath, versusHost, maxRollback, netDelay, netJitter, rawInput);
+    }
+
+    if (tickRate < FPS || tickRate > MAX_TICK_RATE || tickRate % FPS != 0)
+    {
+        fprintf(stderr, "The tick rate is a multiple of %i from %i to %i ticks a second: %i\n", (int)FPS, (int)FPS, (int)MAX_TICK_RATE, tickRate);
+        return 1;
+    }
+
+    if (stressMode)
+    {
+        return RunStressSwarm(stressDimensions, bulletHell, tickRate, rawInput, seed);
+    }
+
+    if (replayFileName != nullptr)
+    {
+        return RunReplay(replayFileName, hashLogFileName, fastForward, verifyFastForward, variant, tickRate);
+    }
+
+    if (variant->play != nullptr)
+    {
+        if (recordingFileName != nullptr || spectatorSocketPath != nullptr || frameExportName != nullptr)
+        {
+            fprintf(stderr, "--record, --spectators and --export-frames only work with the classic game, not --variant %s\n", variant->name);
+            return 1;
+        }
+
+        return variant->play(*variant, rawInput, inputRecordingFileName, hashLogFileName, practiceMode, tickRate, seed);
+    }
+
+    Game game;
+    Player player;
+    Shield shields[NUM_SHIELDS];
+    AlienSwarm aliens;
+    AlienUFO ufo;
+    HighScoreTable table;
+    table.fileName = FILE_NAME;
+    table.service = submitScoresPath != nullptr ? &scoreClient : nullptr; // until LoadHighScores finds there is no service
+
+    InitializeCurses(true);
+
+    RawInput keyboard;
+    InitRawInput(keyboard, rawInput);
+
+    InitGame(game, seed);
+    game.tickRate = tickRate; // before anything schedules a timer
+    game.level = 1;
+    InitPlayer(game, player);
+    InitShields(game, shields, NUM_SHIELDS);
+    InitAliens(game, aliens);
+    ResetUFO(game, ufo);
+
+    LoadHighScores(table);
+
+    FrameExporter frameExporter;
+    frameExporter.header = nullptr;
+
+    if (frameExportName != nullptr)
+    {
+        InitFrameExport(frameExporter, frameExportName, game.windowSize.width, game.windowSize.height); // the game carries on without exporting if this fails
+    }
+
+    SpectatorBroadcast spectatorBroadcast;
+    spectatorBroadcast.listenSocket = -1;
+
+    if (spectatorSocketPath != nullptr)
+    {
+        InitSpectatorBroadcast(spectatorBroadcast, spectatorSocketPath, game.windowSize.width, game.windowSize.height);
+    }
+
+    FrameRecorder frameRecorder;
+    frameRecorder.file = nullptr;
+
+    if (recordingFileName != nullptr)
+    {
+        StartFrameRecording(frameRecorder, recordingFileName, game.windowSize.width, game.windowSize.height);
+    }
+
+    RewindBuffer rewindBuffer;
+    ClearRewindBuffer(rewindBuffer);
+
+    InputRecorder inputRecorder;
+    inputRecorder.file = nullptr;
+
+    if (inputRecordingFileName != nullptr)
+    {
+        StartInputRecording(inputRecorder, inputRecordingFileName, variant->name, seed, game.windowSize.width, game.windowSize.height, game.tickRate);
+        practiceMode = false; // rewinding is not an input the replay can reproduce
+    }
+
+    StateHashLog hashLog;
+    hashLog.file = nullptr;
+
+    if (hashLogFileName != nullptr)
+    {
+        StartStateHashLog(hashLog, hashLogFileName, variant->name);
+    }
+
+    LatencyTracer latencyTracer;
+    InitLatencyTracer(latencyTracer, traceLatency, latencyFileName);
+
+    bool quit = false;
+    int input;
+
+    clock_t lastTime = clock(); // starts the game clock
+    clock_t startTime = lastTime;
+    int ticksUntilFrame = 0;
+
+    while (!quit)
+    {
+        InputEvent event = ReadInputEvent(keyboard);
+        BeginTraceInput(latencyTracer, event, game, player, shields, NUM_SHIELDS, aliens, ufo);
+        input = HandleInput(event, game, player, aliens, shields, NUM_SHIELDS, table);
+        EndTraceInput(latencyTracer, game, player, shields, NUM_SHIELDS, aliens, ufo);
+        RecordInput(inputRecorder, input);
+
+        if (input != 'q')
+        {
+            if (latencyTracer.enabled && input == 'l')
+            {
+                latencyTracer.showOverlay = !latencyTracer.showOverlay;
+            }
+
+            if (practiceMode && input == 'r' && (game.currentState == GS_PLAY || game.currentState == GS_PLAYER_DEAD))
+            {
+                Rewind(rewindBuffer, REWIND_STEP_TICKS, game, player, shields, NUM_SHIELDS, aliens, ufo);
+            }
+
+            clock_t dt;
+
+            /* Manages the speed of the game */
+
+            if (IsTickDue(game, lastTime, dt)) // a tick every CLOCKS_PER_SEC / game.tickRate clock ticks
+            {
+                UpdateGame(dt, game, player, shields, NUM_SHIELDS, aliens, ufo);
+                RecordTick(inputRecorder, (unsigned int)dt);
+                UpdateHighScores(table);
+
+                if (hashLog.file != nullptr)
+                {
+                    LogStateHash(hashLog, game, player, shields, NUM_SHIELDS, aliens, ufo);
+                }
+
+                if (practiceMode && game.subTick == 0) // a classic tick has ended - the rewind buffer holds one a classic tick at any tick rate
+                {
+                    if (game.currentState == GS_PLAY)
+                    {
+                        RecordRewindTick(rewindBuffer, game, player, shields, NUM_SHIELDS, aliens, ufo);
+                    }
+                    else if (game.currentState == GS_INTRO || game.currentState == GS_GAME_OVER)
+                    {
+                        ClearRewindBuffer(rewindBuffer); // nothing to go back to once the game is over
+                    }
+                }
+
+                if (--ticksUntilFrame > 0)
+                {
+                    continue; // drawn, exported, broadcast and recorded at MAX_DRAW_RATE at most
+                }
+
+                ticksUntilFrame = TicksPerFrame(game);
+
+                ClearScreen();
+                DrawGame(game, player, shields, NUM_SHIELDS, aliens, ufo, table);
+                PublishFrame(frameExporter, game, player, shields, NUM_SHIELDS, aliens, ufo);
+                BroadcastFrame(spectatorBroadcast);
+                RecordFrame(frameRecorder, (unsigned int)((lastTime - startTime) * 1000 / CLOCKS_PER_SEC));
+
+                if (latencyTracer.showOverlay)
+                {
+                    DrawLatencyOverlay(latencyTracer); // only on this terminal, not in what is exported or recorded
+                }
+
+                RefreshScreen();
+                TraceFlush(latencyTracer);
+            }
+        }
+        else
+        {
+            quit = true;
+        }
+
+    }
+    
+    if (table.service != nullptr)
+    {
+        ShutDownScoreClient(*table.service);
+
+        if (!table.service->queued.empty())
+        {
+            SaveHighScores(table); // the service has gone - the file keeps them until it takes them in
+        }
+    }
+
+    ShutDownLatencyTracer(latencyTracer);
+    StopStateHashLog(hashLog);
+    StopInputRecording(inputRecorder);
+    StopFrameRecording(frameRecorder);
+    ShutDownSpectatorBroadcast(spectatorBroadcast);
+    ShutDownFrameExport(frameExporter);
+    ShutDownRawInput(keyboard);
+    ShutDownCurses();
+
+    return 0;
+}
+
+/* Initialize game and player functions */
+
+void InitGame(Game& game, unsigned int seed)
+{
+    game.windowSize.width = ScreenWidth();
+    game.windowSize.height = ScreenHeight();
+    game.currentState = GS_INTRO; // For now - TODO: change to GS_INTRO at the end
+    game.gameTimer = 0;
+    ClearTimerWheel(game.timers);
+    game.tickRate = FPS;
+    game.subTick = 0;
+    SeedGameRandom(game.random, seed);
+
+    ResetGameOverPositionCursors(game);
+    
+}
+
+void InitPlayer(const Game& game, Player& player)
+{
+    player.lives = MAX_NUMBER_OF_LIVES;
+    player.spriteSize.width = PLAYER_SPRITE_WIDTH;
+    player.spriteSize.height = PLAYER_SPRITE_HEIGHT;
+    player.score = 0;
+    ResetPlayer(game, player);
+}
+
+void ResetPlayer(const Game& game, Player& player)
+{
+    player.position.x = game.windowSize.width / 2 - player.spriteSize.width / 2; // This puts the player in the center of the screen horizontally
+    player.position.y = game.windowSize.height - player.spriteSize.height - 1; // puts the player at bottom of the screen
+    player.animation = 0;
+    ResetMissile(player);
+}
+
+void ResetMissile(Player& player)
+{
+    player.missile.x = NOT_IN_PLAY;
+    player.missile.y = NOT_IN_PLAY;
+    player.missileY = NOT_IN_PLAY * FIXED_POINT_ONE;
+}
+
+/* Game Loop Functions */
+
+template<class Config>
+int HandleInput(const InputEvent& event, Game& game, Player& player, AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields, HighScoreTable& table)
+{
+    int input = event.key;
+    ProcessInput(input, game, player, aliens, shields, numberOfShields, table);
+    return input;
+}
+
+template<class Config>
+void ProcessInput(int input, Game& game, Player& player, AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields, HighScoreTable& table)
+{
+    switch (input)
+    {
+    case 's':
+        if (game.currentState == GS_INTRO)
+        {
+            game.currentState = GS_HIGH_SCORE;
+        }
+        break;
+    case AK_LEFT:
+        if (game.currentState == GS_PLAY)
+        {
+            MovePlayer(game, player, -PLAYER_MOVEMENT_AMOUNT);
+        }
+        else if (game.currentState == GS_GAME_OVER)
+        {
+            game.gameOverHPositionCursor = game.gameOverHPositionCursor - 1;
+            if (game.gameOverHPositionCursor < 0)
+            {
+                game.gameOverHPositionCursor = MAX_NUMBER_OF_CHARACTERS_IN_NAME - 1; // if we hit beginning of characters and try going left, take back to end of characters
+            }
+        }
+        
+        break;
+    case AK_RIGHT:
+        if (game.currentState == GS_PLAY)
+        {
+            MovePlayer(game, player, PLAYER_MOVEMENT_AMOUNT);
+        }
+        
+        else if (game.currentState == GS_GAME_OVER)
+        {
+            game.gameOverHPositionCursor = (game.gameOverHPositionCursor + 1) % MAX_NUMBER_OF_CHARACTERS_IN_NAME; // make sure you're still in bounds of 0 - 2
+        }
+        
+        break;
+    case AK_UP:
+        if (game.currentState == GS_GAME_OVER)
+        {
+            game.gameOverVPositionCursor[game.gameOverHPositionCursor] = game.gameOverVPositionCursor[game.gameOverHPositionCursor] - 1;
+
+            if (game.gameOverVPositionCursor[game.gameOverHPositionCursor] < 0)
+            {
+                game.gameOverVPositionCursor[game.gameOverHPositionCursor] = MAX_ALPHABET_CHARACTERS - 1;
+            }
+
+            game.playerName[game.gameOverHPositionCursor] = 'A' + game.gameOverVPositionCursor[game.gameOverHPositionCursor];
+        }
+        break;
+    case AK_DOWN:
+        if (game.currentState == GS_GAME_OVER)
+        {
+            game.gameOverVPositionCursor[game.gameOverHPositionCursor] = (game.gameOverVPositionCursor[game.gameOverHPositionCursor] + 1) % MAX_ALPHABET_CHARACTERS;
+
+            game.playerName[game.gameOverHPositionCursor] = 'A' + game.gameOverVPositionCursor[game.gameOverHPositionCursor];
+        }
+        break;
+    case ' ': 
+        if (game.currentState == GS_PLAY)
+        {
+            PlayerShoot(player);
+        }
+        else if (game.currentState == GS_PLAYER_DEAD)
+        {
+            player.lives--;
+            player.animation = 0;
+            if (player.lives == 0)
+            {
+                game.currentState = GS_GAME_OVER;
+
+                ResetGameOverPositionCursors(game);
+            }
+            else
+            {
+                StartWait(game, RESPAWN_WAIT_TIME);
+            }
+        }
+        else if (game.currentState == GS_GAME_OVER)
+        {
+            game.playerName[MAX_NUMBER_OF_CHARACTERS_IN_NAME] = '\0';
+            AddHighScore(table, player.score, std::string(game.playerName));
+            game.currentState = GS_HIGH_SCORE;
+        }
+        else if (game.currentState == GS_HIGH_SCORE)
+        {
+            game.currentState = GS_INTRO;
+            ResetGame(game, player, aliens, shields, numberOfShields);
+        }
+        else if (game.currentState == GS_INTRO)
+        {
+            game.currentState = GS_PLAY;
+        }
+        break;
+    }
+}
+
+template<class Config>
+void UpdateGame(clock_t dt, Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens, AlienUFO& ufo)
+{
+    game.gameTimer += dt;
+
+    UpdateTimers(game, aliens, ufo);
+
+    if (game.currentState == GS_PLAY)
+    {
+        Position missileStart = player.missile;
+        int missileDistance = UpdateMissile(game, player, shields, numberOfShields, aliens);
+
+        if (UpdateAliens(game, aliens, player, shields, numberOfShields))
+        {
+            game.currentState = GS_PLAYER_DEAD;
+        }
+
+        if (aliens.numAliensLeft == 0)
+        {
+            game.level++;
+            game.level = (game.level % NUM_LEVELS) + 1;
+
+            ResetGame(game, player, aliens, shields, numberOfShields);
+            StartWait(game, WAIT_TIME);
+        }
+
+        if (ufo.position.x != NOT_IN_PLAY) // the UFO is put in play by its timer
+        {
+            //update the ufo
+            if (SweepSprite(missileStart, -1, missileDistance, ufo.position, ufo.size, SPRITE_MASKS.alienUFO) > 0) // after the swarm has moved, as it always has been
+            {
+                player.score += ufo.points;
+                ResetMissile(player);
+                ResetUFO(game, ufo);
+            }
+            else
+            {
+                UpdateUFO(game, ufo);
+            }
+        }
+    }
+    else if (game.currentState == GS_PLAYER_DEAD && IsLastSubTick(game))
+    {
+        player.animation = (player.animation + 1) % 2;
+    }
+
+    game.subTick = IsLastSubTick(game) ? 0 : game.subTick + 1;
+}
+
+template<class Config>
+void UpdateTimers(Game& game, AlienSwarmT<Config>& aliens, AlienUFO& ufo)
+{
+    AdvanceTimerWheel(game.timers);
+
+    TimerType type;
+    int data;
+
+    while (PopExpiredTimer(game.timers, type, data))
+    {
+        switch (type)
+        {
+        case TIMER_ALIEN_EXPLOSION:
+            FinishAlienExplosion(aliens, data / NumAlienColumns(aliens), data % NumAlienColumns(aliens));
+            break;
+        case TIMER_SWARM_STEP:
+            aliens.stepDue = 1; // the swarm moves on its next update, after the bombs
+            break;
+        case TIMER_WAIT_OVER:
+            if (game.currentState == GS_WAIT)
+            {
+                game.currentState = GS_PLAY;
+            }
+            break;
+        case TIMER_UFO_SPAWN:
+            if (ufo.position.x != NOT_IN_PLAY)
+            {
+                break;
+            }
+
+            if (game.currentState == GS_PLAY)
+            {
+                PutUFOInPlay(game, ufo);
+            }
+            else
+            {
+                ScheduleGameTimer(game, TIMER_UFO_SPAWN, 0, FPS); // not playing right now - try again in a second
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void StartWait(Game& game, int waitTime)
+{
+    CancelTimers(game.timers, TIMER_WAIT_OVER);
+
+    game.currentState = GS_WAIT;
+    ScheduleGameTimer(game, TIMER_WAIT_OVER, 0, waitTime);
+}
+
+void ScheduleGameTimer(Game& game, TimerType type, int data, int classicTicks)
+{
+    ScheduleTimer(game.timers, type, data, classicTicks * (game.tickRate / FPS));
+}
+
+int FixedPointStep(const Game& game, int speed)
+{
+    int ticksPerClassicTick = game.tickRate / FPS;
+    return speed * (game.subTick + 1) / ticksPerClassicTick - speed * game.subTick / ticksPerClassicTick;
+}
+
+bool IsLastSubTick(const Game& game)
+{
+    return game.subTick + 1 >= game.tickRate / FPS;
+}
+
+bool IsTickDue(const Game& game, clock_t& lastTime, clock_t& dt)
+{
+    clock_t tickTime = CLOCKS_PER_SEC / game.tickRate;
+    clock_t currentTime = clock();
+    clock_t late = currentTime - lastTime;
+
+    if (late < tickTime)
+    {
+        return false;
+    }
+
+    if (late > MAX_LAG_TICKS * tickTime) // too far behind to catch up, the game slows down instead
+    {
+        dt = late;
+        lastTime = currentTime;
+    }
+    else // a tick late now is made up by the next one coming sooner, or a slow frame would slow the game down
+    {
+        dt = tickTime;
+        lastTime += tickTime;
+    }
+
+    return true;
+}
+
+int TicksPerFrame(const Game& game)
+{
+    return (game.tickRate + MAX_DRAW_RATE - 1) / MAX_DRAW_RATE;
+}
+
+template<class Config>
+void DrawGame(const Game& game, const Player& player, Shield shields[], int numberOfShields, const AlienSwarmT<Config>& aliens, const AlienUFO& ufo, const HighScoreTable& table)
+{
+    if (game.currentState == GS_PLAY || game.currentState == GS_PLAYER_DEAD || game.currentState == GS_WAIT) // if we're playing game, and player is hit, or we're waiting
+    {
+        if (game.currentState == GS_PLAY || game.currentState == GS_WAIT)
+        {
+            DrawPlayer(player, PLAYER_SPRITE);
+        }
+        else
+        {
+            DrawPlayer(player, PLAYER_EXPLOSION_SPRITE);
+        }
+
+        DrawShileds(shields, numberOfShields);
+
+        DrawAliens(aliens);
+
+        DrawUFO(ufo);
+    }
+    else if(game.currentState == GS_GAME_OVER)
+    {
+        DrawGameOverScreen(game);
+    }
+    else if (game.currentState == GS_INTRO)
+    {
+        DrawIntroScreen(game);
+    }
+    else if (game.currentState == GS_HIGH_SCORE)
+    {
+        DrawHighScoreTable(game, table);
+    }
+}
+
+void MovePlayer(const Game& game, Player& player, int dx)
+{
+    if (player.position.x + player.spriteSize.width + dx > game.windowSize.width) // check if player would move offscreen to the right
+    {
+        player.position.x = game.windowSize.width - player.spriteSize.width; // right most position player can be
+    }
+    else if (player.position.x + dx < 0) // The player is off the screen to the left
+    {
+        player.position.x = 0;
+    }
+    else
+    {
+        player.position.x += dx;
+    }
+}
+
+void PlayerShoot(Player& player)
+{
+    if (player.missile.x == NOT_IN_PLAY || player.missile.y == NOT_IN_PLAY)
+    {
+        player.missile.y = player.position.y - 1; // one row above the player
+        player.missile.x = player.position.x + player.spriteSize.width / 2;
+        player.missileY = player.missile.y * FIXED_POINT_ONE;
+    }
+}
+
+void DrawPlayer(const Player& player, const char* const sprite[])
+{
+    DrawSprite(player.position.x, player.position.y, PLAYER_SPRITE, player.spriteSize.height, player.animation * player.spriteSize.height);
+
+    if (player.missile.x != NOT_IN_PLAY)
+    {
+        DrawCharacter(player.missile.x, player.missile.y, PLAYER_MISSILE_SPRITE);
+    }
+
+    mvprintw(0, 0, "SCORE: %i, LIVES: %i", player.score, player.lives);
+}
+
+template<class Config>
+int UpdateMissile(Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens)
+{
+    if (player.missile.y == NOT_IN_PLAY)
+    {
+        return 0;
+    }
+
+    return MoveMissile(game, player.missile, player.missileY, player.score, shields, numberOfShields, aliens);
+}
+
+template<class Config>
+int MoveMissile(Game& game, Position& missile, int& missileY, int& score, Shield shields[], int numberOfShields, AlienSwarmT<Config>& aliens)
+{
+    Position from = missile;
+    int nextMissileY = missileY - FixedPointStep(game, PLAYER_MISSILE_SPEED * FIXED_POINT_ONE);
+    int distance = std::min(from.y - FixedPointToCell(nextMissileY), from.y); // only the cells still on the screen - none on most ticks at a high tick rate
+
+    int shieldIndex;
+    Position shieldCollisionPoint;
+    int shieldHit = SweepShields(from, -1, distance, shields, numberOfShields, shieldIndex, shieldCollisionPoint);
+
+    Position alienCollisionPoint;
+    int alienHit = SweepAliens(from, -1, distance, aliens, alienCollisionPoint);
+
+    bool hit = false;
+
+    if (shieldHit > 0 && (alienHit == 0 || shieldHit <= alienHit)) // the first thing in the way
+    {
+        ResolveShieldCollision(shields, shieldIndex, shieldCollisionPoint);
+        hit = true;
+    }
+    else if (alienHit > 0)
+    {
+        score += ResolveAlienCollision(game, aliens, alienCollisionPoint);
+        hit = true;
+    }
+
+    if (hit || FixedPointToCell(nextMissileY) < 0)
+    {
+        missile.x = NOT_IN_PLAY;
+        missile.y = NOT_IN_PLAY;
+        missileY = NOT_IN_PLAY * FIXED_POINT_ONE;
+        return hit ? 0 : distance;
+    }
+
+    missileY = nextMissileY;
+    missile.y = FixedPointToCell(nextMissileY);
+
+    return distance;
+}
+
+void DrawShileds(const Shield shields[], int numberOfShields)
+{
+    for (int i = 0; i < numberOfShields; i++)
+    {
+        const Shield& shield = shields[i];
+        char rows[SHIELD_SPRITE_HEIGHT][SHIELD_SPRITE_WIDTH + 1];
+        const char* sprite[SHIELD_SPRITE_HEIGHT];
+
+        for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+        {
+            for (int col = 0; col < SHIELD_SPRITE_WIDTH; col++)
+            {
+                rows[row][col] = (shield.rows[row] & (1u << col)) ? SHIELD_SPRITE[row][col] : ' ';
+            }
+
+            rows[row][SHIELD_SPRITE_WIDTH] = '\0';
+            sprite[row] = rows[row];
+        }
+
+        DrawSprite(shield.position.x, shield.position.y, sprite, SHIELD_SPRITE_HEIGHT);
+    }
+}
+
+/* Shield Initialization functions */
+
+void InitShields(const Game& game, Shield shields[], int numberOfShields)
+{
+    ResetShields(game, shields, numberOfShields);
+}
+
+/* Collision functions */
+
+bool FindSweepSpan(const Position& from, int direction, int distance, int top, int height, int& first, int& last)
+{
+    if (direction < 0)
+    {
+        first = std::max(1, from.y - (top + height - 1));
+        last = std::min(distance, from.y - top);
+    }
+    else
+    {
+        first = std::max(1, top - from.y);
+        last = std::min(distance, top + height - 1 - from.y);
+    }
+
+    return first <= last;
+}
+
+int SweepShields(const Position& from, int direction, int distance, const Shield shields[], int numberOfShields, int& shieldIndex, Position& shieldCollisionPoint)
+{
+    shieldIndex = NOT_IN_PLAY;
+    shieldCollisionPoint.x = NOT_IN_PLAY;
+    shieldCollisionPoint.y = NOT_IN_PLAY;
+
+    if (from.y == NOT_IN_PLAY)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < numberOfShields; i++)
+    {
+        const Shield& shield = shields[i];
+        int first, last;
+
+        if (from.x < shield.position.x || from.x >= shield.position.x + SHIELD_SPRITE_WIDTH || //in line horizaontally
+            !FindSweepSpan(from, direction, distance, shield.position.y, SHIELD_SPRITE_HEIGHT, first, last)) //passes it vertically
+        {
+            continue;
+        }
+
+        for (int cell = first; cell <= last; cell++)
+        {
+            int row = from.y + direction * cell - shield.position.y;
+
+            if (shield.rows[row] & (1u << (from.x - shield.position.x))) //does it collide with part of the shield or collide with empty space
+            {
+                shieldIndex = i;
+                shieldCollisionPoint.x = from.x - shield.position.x;
+                shieldCollisionPoint.y = row;
+                return cell; // shields are side by side, so no other one is in line
+            }
+        }
+    }
+
+    return 0;
+}
+
+void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollisionPoint)
+{
+    shields[shieldIndex].rows[shieldCollisionPoint.y] &= ~(1u << shieldCollisionPoint.x);
+}
+
+/* Alien Init and Draw functions */
+
+template<class Config>
+void InitAliens(Game& game, AlienSwarmT<Config>& aliens)
+{
+    for (int row = 0; row < Config::NUM_ALIEN_ROWS; row++)
+    {
+        for (int col = 0; col < Config::NUM_ALIEN_COLUMNS; col++)
+        {
+            aliens.aliens[row][col] = AS_ALIVE;
+        }
+
+        aliens.occupiedInRow[row] = Config::NUM_ALIEN_COLUMNS;
+    }
+
+    for (int col = 0; col < Config::NUM_ALIEN_COLUMNS; col++)
+    {
+        aliens.lowestAliveRow[col] = Config::NUM_ALIEN_ROWS - 1;
+        aliens.occupiedInColumn[col] = Config::NUM_ALIEN_ROWS;
+    }
+
+    aliens.aliveColumns = (1u << Config::NUM_ALIEN_COLUMNS) - 1;
+    aliens.leftColumn = 0;
+    aliens.rightColumn = Config::NUM_ALIEN_COLUMNS - 1;
+    aliens.bottomRow = Config::NUM_ALIEN_ROWS - 1;
+
+    aliens.direction = 1;
+    aliens.numAliensLeft = Config::NUM_ALIEN_ROWS * Config::NUM_ALIEN_COLUMNS;
+    aliens.animation = 0;
+    aliens.spriteSize.width = Config::ALIEN_SPRITE_WIDTH;
+    aliens.spriteSize.height = Config::ALIEN_SPRITE_HEIGHT;
+    aliens.numberOfBombsInPlay = 0;
+    aliens.stepped = 0;
+    aliens.position.x = (game.windowSize.width - Config::NUM_ALIEN_COLUMNS * (aliens.spriteSize.width + Config::ALIENS_X_PADDING)) / 2;
+    aliens.position.y = game.windowSize.height - LEVEL_TABLES<Config>.swarmStartRowsAboveBottom[game.level];
+    aliens.line = LEVEL_TABLES<Config>.swarmStartLine[game.level];
+
+    for (int i = 0; i < Config::MAX_NUMBER_OF_ALIEN_BOMBS; i++)
+    {
+        aliens.bombs[i].animation = 0;
+        aliens.bombs[i].position.x = NOT_IN_PLAY;
+        aliens.bombs[i].position.y = NOT_IN_PLAY;
+        aliens.bombs[i].y = NOT_IN_PLAY * FIXED_POINT_ONE;
+    }
+
+    CancelTimers(game.timers, TIMER_ALIEN_EXPLOSION); // from the swarm this one replaces
+    CancelTimers(game.timers, TIMER_SWARM_STEP);
+    ScheduleSwarmStep(game, aliens);
+}
+
+template<class Config>
+void DrawAliens(const AlienSwarmT<Config>& aliens)
+{
+    const int NUM_30_POINT_ALIEN_ROWS = Config::NUM_30_POINT_ALIEN_ROWS;
+
+    for (int row = 0; row < NUM_30_POINT_ALIEN_ROWS; row++)
+    {
+        for (int col = 0; col < Config::NUM_ALIEN_COLUMNS; col++)
+        {
+            int xPos = aliens.position.x + col * (aliens.spriteSize.width + Config::ALIENS_X_PADDING);
+            int yPos = aliens.position.y + row * (aliens.spriteSize.height + Config::ALIENS_Y_PADDING);
+
+            if (aliens.aliens[row][col] == AS_ALIVE)
+            {
+                DrawSprite(xPos, yPos, ALIEN30_SPRITE, aliens.spriteSize.height, aliens.animation*aliens.spriteSize.height);
+            }
+            else if (aliens.aliens[row][col] == AS_EXPLODING)
+            {
+                DrawSprite(xPos, yPos, ALIEN_EXPLOSION, aliens.spriteSize.height);
+            }
+        }
+
+    }
+
+    const int NUM_20_POINT_ALIEN_ROWS = Config::NUM_20_POINT_ALIEN_ROWS;
+
+    for (int row = 0; row < NUM_20_POINT_ALIEN_ROWS; row++)
+    {
+        for (int col = 0; col < Config::NUM_ALIEN_COLUMNS; col++)
+        {
+            int xPos = aliens.position.x + col * (aliens.spriteSize.width + Config::ALIENS_X_PADDING);
+            int yPos = aliens.position.y + row * (aliens.spriteSize.height + Config::ALIENS_Y_PADDING) + NUM_30_POINT_ALIEN_ROWS * (aliens.spriteSize.height + Config::ALIENS_Y_PADDING);
+
+            if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + row][col] == AS_ALIVE)
+            {
+                DrawSprite(xPos, yPos, ALIEN20_SPRITE, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
+            }
+            else if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + row][col] == AS_EXPLODING)
+            {
+                DrawSprite(xPos, yPos, ALIEN_EXPLOSION, aliens.spriteSize.height);
+            }
+        }
+
+    }
+
+    const int NUM_10_POINT_ALIEN_ROWS = Config::NUM_ALIEN_ROWS - NUM_30_POINT_ALIEN_ROWS - NUM_20_POINT_ALIEN_ROWS;
+
+    for (int row = 0; row < NUM_10_POINT_ALIEN_ROWS; row++)
+    {
+        for (int col = 0; col < Config::NUM_ALIEN_COLUMNS; col ++)
+        {
+            int xPos = aliens.position.x + col * (aliens.spriteSize.width + Config::ALIENS_X_PADDING);
+            int yPos = aliens.position.y + row * (aliens.spriteSize.height + Config::ALIENS_Y_PADDING) + NUM_30_POINT_ALIEN_ROWS * (aliens.spriteSize.height + Config::ALIENS_Y_PADDING) + NUM_20_POINT_ALIEN_ROWS * (aliens.spriteSize.height + Config::ALIENS_Y_PADDING);
+
+            if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + NUM_20_POINT_ALIEN_ROWS + row][col] == AS_ALIVE)
+            {
+                DrawSprite(xPos, yPos, ALIEN10_SPRITE, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
+            }
+            else if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + NUM_20_POINT_ALIEN_ROWS + row][col] == AS_EXPLODING)
+            {
+                DrawSprite(xPos, yPos, ALIEN_EXPLOSION, aliens.spriteSize.height);
+            }
+        }
+    }
+
+    if (aliens.numberOfBombsInPlay > 0)
+    {
+        for (int i = 0; i < Config::MAX_NUMBER_OF_ALIEN_BOMBS; i++)
+        {
+            if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
+            {
+                DrawCharacter(aliens.bombs[i].position.x, aliens.bombs[i].position.y, ALIEN_BOMB_SPRITE[aliens.bombs[i].animation]);
+            }
+        }
+    }
+
+}
+
+/* Alien Collisions */
+
+template<class Config>
+int SweepAliens(const Position& from, int direction, int distance, const AlienSwarmT<Config>& aliens, Position& alienCollisionPositionInArray)
+{
+    alienCollisionPositionInArray.x = NOT_IN_PLAY;
+    alienCollisionPositionInArray.y = NOT_IN_PLAY;
+
+    // the aliens sit on a grid, so the projectile only ever passes the one column of it that it is in line with
+    int cellWidth = aliens.spriteSize.width + Config::ALIENS_X_PADDING;
+    int cellHeight = aliens.spriteSize.height + Config::ALIENS_Y_PADDING;
+    int dx = from.x - aliens.position.x;
+
+    if (dx < 0 || dx % cellWidth >= aliens.spriteSize.width || dx / cellWidth >= NumAlienColumns(aliens)) // left or right of the swarm, or in the padding
+    {
+        return 0;
+    }
+
+    int col = dx / cellWidth;
+    int spriteX = dx % cellWidth;
+    int first, last;
+
+    if (!FindSweepSpan(from, direction, distance, aliens.position.y, NumAlienRows(aliens) * cellHeight, first, last))
+    {
+        return 0;
+    }
+
+    for (int cell = first; cell <= last; cell++)
+    {
+        int dy = from.y + direction * cell - aliens.position.y;
+        int row = dy / cellHeight;
+
+        if (dy % cellHeight >= aliens.spriteSize.height || row >= NumAlienRows(aliens) || aliens.aliens[row][col] != AS_ALIVE)
+        {
+            continue;
+        }
+
+        int points = AlienRowPoints(row, NumAlienRows(aliens));
+        const SpriteMask* masks = points == 30 ? SPRITE_MASKS.alien30 : (points == 20 ? SPRITE_MASKS.alien20 : SPRITE_MASKS.alien10);
+
+        if ((masks[aliens.animation].rows[dy % cellHeight] >> spriteX) & 1) // the frame on screen, not a blank in it
+        {
+            alienCollisionPositionInArray.x = col;
+            alienCollisionPositionInArray.y = row;
+            return cell;
+        }
+    }
+
+    return 0;
+}
+
+template<class Config>
+int ResolveAlienCollision(Game& game, AlienSwarmT<Config>& aliens, const Position& hitPositionInAliensArray)
+{
+    int row = hitPositionInAliensArray.y;
+    int col = hitPositionInAliensArray.x;
+
+    aliens.aliens[row][col] = AS_EXPLODING;
+    aliens.numAliensLeft--;
+
+    if (aliens.lowestAliveRow[col] == row) // the next one up the column is the new shooter
+    {
+        int newLowestRow = row - 1;
+        while (newLowestRow >= 0 && aliens.aliens[newLowestRow][col] != AS_ALIVE)
+        {
+            newLowestRow--;
+        }
+
+        if (newLowestRow >= 0)
+        {
+            aliens.lowestAliveRow[col] = newLowestRow;
+        }
+        else
+        {
+            aliens.lowestAliveRow[col] = NOT_IN_PLAY;
+            RemoveAliveColumn(aliens, col);
+        }
+    }
+
+    StartAlienExplosion(game, aliens, row, col); // each alien explodes for its own ALIEN_EXPLOSION_TIME
+
+    return AlienRowPoints(row, NumAlienRows(aliens));
+}
+
+template<class Config>
+bool UpdateAliens(Game& game, AlienSwarmT<Config>& aliens, Player& player, Shield shields[], int numberOfShields)
+{
+    if (UpdateBombs(game, aliens, player, shields, numberOfShields)) // If a player was hit
+    {
+        return true;
+    }
+
+    /* Alien Movement */
+
+    bool moveHorizontal = aliens.stepDue != 0; // the swarm step timer went off, move horizontally
+    int emptyColsLeft = 0;
+    int emptyColsRight = 0;
+    int emptyRowsBottom = 0;
+
+    FindEmptyRowsAndColumns(aliens, emptyColsLeft, emptyColsRight, emptyRowsBottom);
+
+    int numberOfColumns = NumAlienColumns(aliens) - emptyColsLeft - emptyColsRight;
+    int leftAlienPosition = aliens.position.x + emptyColsLeft * (aliens.spriteSize.width + Config::ALIENS_X_PADDING);
+    int rightAlienPosition = leftAlienPosition + numberOfColumns * aliens.spriteSize.width + (numberOfColumns - 1) * Config::ALIENS_Y_PADDING;
+
+    if (((rightAlienPosition >= game.windowSize.width && aliens.direction > 0) || (leftAlienPosition <= 0 && aliens.direction < 0)) && moveHorizontal&& aliens.line > 0)
+    {
+        //move down
+        moveHorizontal = false;
+        aliens.position.y++;
+        aliens.line--;
+        aliens.direction = -aliens.direction;
+        ScheduleSwarmStep(game, aliens);
+        DestoryShields(aliens, shields, numberOfShields);
+
+        if (aliens.line == 0)
+        {
+            game.currentState = GS_GAME_OVER;
+            return false;
+        }
+    }
+
+    if (moveHorizontal)
+    {
+        aliens.position.x += aliens.direction;
+        ScheduleSwarmStep(game, aliens);
+        aliens.animation = aliens.animation == 0 ? 1 : 0;
+        DestoryShields(aliens, shields, numberOfShields);
+        aliens.stepped = 1;
+    }
+
+    if (IsLastSubTick(game))
+    {
+        if (aliens.stepped == 0)
+        {
+            ShootBombs(game.random, aliens, emptyColsLeft, numberOfColumns);
+        }
+
+        aliens.stepped = 0;
+    }
+    return false; // no player was hit
+}
+
+template<class Config>
+void ShootBombs(GameRandom& random, AlienSwarmT<Config>& aliens, int emptyColsLeft, int numberOfColumns)
+{
+    int numActiveCols = CountActiveColumns(aliens, emptyColsLeft, numberOfColumns); // columns that still exist - some aliens are still alive in that column
+
+    if (ShouldShootBomb(random, aliens))
+    {
+        if (numActiveCols > 0)
+        {
+            int numberOfShots = ((DrawGameRandom(random) % MaxAlienBombs(aliens)) + 1) - NumBombsInPlay(aliens); // makes sure that there are only MaxAlienBombs in play
+
+            for (int i = 0; i < numberOfShots; i++)
+            {
+                int columnToShoot = DrawGameRandom(random) % numActiveCols;
+
+                ShootBomb(aliens, columnToShoot);
+            }
+        }
+    }
+}
+
+/* Alien Moveent Functions */
+
+template<class Config>
+void ResetMovementTime(AlienSwarmT<Config>& aliens)
+{
+    aliens.movementTime = LEVEL_TABLES<Config>.swarmStepTicks[aliens.line][aliens.numAliensLeft]; // MakeSwarmStepTicks in LevelTables.h can be changed, doesn't affect anything negatively
+}
+
+void ResetMovementTime(StressSwarm& aliens)
+{
+    aliens.movementTime = 1 + 4 * aliens.numAliensLeft / (aliens.numRows * aliens.numColumns); // there are no level tables for a swarm sized at run time
+}
+
+template<class Config>
+void ScheduleSwarmStep(Game& game, AlienSwarmT<Config>& aliens)
+{
+    ResetMovementTime(aliens);
+
+    aliens.stepDue = 0;
+    ScheduleGameTimer(game, TIMER_SWARM_STEP, 0, aliens.movementTime > 0 ? aliens.movementTime : 1);
+}
+
+template<class Config>
+void FindEmptyRowsAndColumns(const AlienSwarmT<Config>& aliens, int& emptyColsLeft, int& emptyColsRight, int& emptyRowsBottom)
+{
+    // a column or row only counts as empty once every alien in it is AS_DEAD - exploding aliens still take up space
+    emptyColsLeft = aliens.leftColumn;
+    emptyColsRight = NumAlienColumns(aliens) - 1 - aliens.rightColumn;
+    emptyRowsBottom = NumAlienRows(aliens) - 1 - aliens.bottomRow;
+}
+
+template<class Config>
+void FinishAlienExplosion(AlienSwarmT<Config>& aliens, int row, int col)
+{
+    if (aliens.aliens[row][col] != AS_EXPLODING)
+    {
+        return;
+    }
+
+    aliens.aliens[row][col] = AS_DEAD;
+    aliens.occupiedInColumn[col]--;
+    aliens.occupiedInRow[row]--;
+
+    while (aliens.leftColumn < NumAlienColumns(aliens) && aliens.occupiedInColumn[aliens.leftColumn] == 0)
+    {
+        aliens.leftColumn++;
+    }
+
+    while (aliens.rightColumn >= 0 && aliens.occupiedInColumn[aliens.rightColumn] == 0)
+    {
+        aliens.rightColumn--;
+    }
+
+    while (aliens.bottomRow >= 0 && aliens.occupiedInRow[aliens.bottomRow] == 0)
+    {
+        aliens.bottomRow--;
+    }
+}
+
+template<class Config>
+int CountActiveColumns(const AlienSwarmT<Config>& aliens, int firstColumn, int endColumn)
+{
+    if (endColumn <= firstColumn)
+    {
+        return 0;
+    }
+
+    unsigned int columns = aliens.aliveColumns & ((1u << endColumn) - 1) & ~((1u << firstColumn) - 1);
+
+    int numColumns = 0;
+    while (columns != 0)
+    {
+        columns &= columns - 1; // drops the lowest set bit
+        numColumns++;
+    }
+
+    return numColumns;
+}
+
+int CountActiveColumns(const StressSwarm& aliens, int firstColumn, int endColumn)
+{
+    int numColumns = 0;
+
+    for (int col = std::max(firstColumn, 0); col < endColumn && col < aliens.numColumns; col++)
+    {
+        if (aliens.lowestAliveRow[col] != NOT_IN_PLAY)
+        {
+            numColumns++;
+        }
+    }
+
+    return numColumns;
+}
+
+/* Swarm sizes and storage */
+
+template<class Config>
+int NumAlienRows(const AlienSwarmT<Config>&)
+{
+    return Config::NUM_ALIEN_ROWS;
+}
+
+int NumAlienRows(const StressSwarm& aliens)
+{
+    return aliens.numRows;
+}
+
+template<class Config>
+int NumAlienColumns(const AlienSwarmT<Config>&)
+{
+    return Config::NUM_ALIEN_COLUMNS;
+}
+
+int NumAlienColumns(const StressSwarm& aliens)
+{
+    return aliens.numColumns;
+}
+
+template<class Config>
+int MaxAlienBombs(const AlienSwarmT<Config>&)
+{
+    return Config::MAX_NUMBER_OF_ALIEN_BOMBS;
+}
+
+int MaxAlienBombs(const StressSwarm& aliens)
+{
+    return (int)aliens.bombs.slots.size();
+}
+
+template<class Config>
+int NumBombsInPlay(const AlienSwarmT<Config>& aliens)
+{
+    return aliens.numberOfBombsInPlay;
+}
+
+int NumBombsInPlay(const StressSwarm& aliens)
+{
+    return (int)aliens.bombs.projectiles.size();
+}
+
+template<class Config>
+int BombChanceDivisor(const AlienSwarmT<Config>& aliens)
+{
+    return LEVEL_TABLES<Config>.bombChanceDivisor[aliens.numAliensLeft];
+}
+
+int BombChanceDivisor(const StressSwarm& aliens)
+{
+    return aliens.bombChanceDivisor;
+}
+
+template<class Config>
+void StartAlienExplosion(Game& game, AlienSwarmT<Config>&, int row, int col)
+{
+    ScheduleGameTimer(game, TIMER_ALIEN_EXPLOSION, row * Config::NUM_ALIEN_COLUMNS + col, ALIEN_EXPLOSION_TIME);
+}
+
+void StartAlienExplosion(Game&, StressSwarm& aliens, int row, int col)
+{
+    StressExplosion explosion; // counted down by UpdateStressGame - the timer wheel holds far fewer than can be going off at once
+    explosion.row = row;
+    explosion.column = col;
+    explosion.ticksLeft = ALIEN_EXPLOSION_TIME;
+    aliens.explosions.push_back(explosion);
+}
+
+template<class Config>
+void RemoveAliveColumn(AlienSwarmT<Config>& aliens, int col)
+{
+    aliens.aliveColumns &= ~(1u << col);
+}
+
+void RemoveAliveColumn(StressSwarm&, int)
+{
+    // CountActiveColumns goes by lowestAliveRow, there is no bit per column to clear
+}
+
+int AlienRowPoints(int row, int numRows)
+{
+    if (row < numRows / 5) // the top fifth of the swarm, as in GameConfig
+    {
+        return 30;
+    }
+    else if (row < numRows / 5 + 2 * numRows / 5)
+    {
+        return 20;
+    }
+    else
+    {
+        return 10;
+    }
+}
+
+/* Aliens vs Shields functions */
+
+template<class Config>
+void DestoryShields(const AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields)
+{
+    if (aliens.bottomRow < 0 || numberOfShields <= 0)
+    {
+        return;
+    }
+
+    int shieldsTop = shields[0].position.y;
+    int shieldsBottom = shields[0].position.y + SHIELD_SPRITE_HEIGHT;
+
+    for (int s = 1; s < numberOfShields; s++)
+    {
+        shieldsTop = min(shieldsTop, shields[s].position.y);
+        shieldsBottom = max(shieldsBottom, shields[s].position.y + SHIELD_SPRITE_HEIGHT);
+    }
+
+    const int rowHeight = aliens.spriteSize.height + Config::ALIENS_Y_PADDING;
+    int swarmBottom = aliens.position.y + aliens.bottomRow * rowHeight + aliens.spriteSize.height;
+
+    if (swarmBottom < shieldsTop) // the swarm is still above the shields - nothing can touch them (most of the game)
+    {
+        return;
+    }
+
+    // only the aliens whose rows reach into the shield band can erode it, and in each column those are the lowest live
+    // one and at most one more above it - so walk up from the lowest and stop as soon as a row is above the band
+    for (int col = 0; col < NumAlienColumns(aliens); col++)
+    {
+        int xPos = aliens.position.x + col * (aliens.spriteSize.width + Config::ALIENS_X_PADDING);
+
+        for (int row = aliens.lowestAliveRow[col]; row >= 0; row--)
+        {
+            int yPos = aliens.position.y + row * rowHeight;
+
+            if (yPos + aliens.spriteSize.height < shieldsTop)
+            {
+                break;
+            }
+
+            if (yPos < shieldsBottom && aliens.aliens[row][col] == AS_ALIVE)
+            {
+                CollideShieldsWithAlien(shields, numberOfShields, xPos, yPos, aliens.spriteSize);
+            }
+        }
+    }
+}
+
+void CollideShieldsWithAlien(Shield shields[], int numberOfShields, int alienPositionX, int alienPositionY, const Size& size)
+{
+    for (int s = 0; s < numberOfShields; s++)
+    {
+        Shield& shield = shields[s];
+
+        if (alienPositionX < shield.position.x + SHIELD_SPRITE_WIDTH && alienPositionX + size.width >= shield.position.x && //If left edge of alien is less than right most edge of shield and the right most edge of alien is greater than left edge of shield
+            alienPositionY < shield.position.y + SHIELD_SPRITE_HEIGHT && alienPositionY + size.height >= shield.position.y)
+        {
+            int dy = alienPositionY - shield.position.y;
+            int dx = alienPositionX - shield.position.x;
+            int left = std::max(dx, 0);
+            int right = std::min(dx + size.width, (int)SHIELD_SPRITE_WIDTH);
+
+            if (left < right)
+            {
+                unsigned int footprint = (1u << right) - (1u << left); // the columns the alien covers, as one mask for every row
+
+                for (int shieldY = std::max(dy, 0); shieldY < dy + size.height && shieldY < SHIELD_SPRITE_HEIGHT; shieldY++)
+                {
+                    shield.rows[shieldY] &= ~footprint;
+                }
+            }
+            break;
+        }
+    }
+}
+
+template<class Config>
+bool ShouldShootBomb(GameRandom& random, const AlienSwarmT<Config>& aliens)
+{
+    return DrawGameRandom(random) % BombChanceDivisor(aliens) == 1;
+}
+
+template<class Config>
+void ShootBomb(AlienSwarmT<Config>& aliens, int columnToShoot)
+{
+    int bombId = NOT_IN_PLAY;
+
+    for (int i = 0; i < Config::MAX_NUMBER_OF_ALIEN_BOMBS; i++)
+    {
+        if (aliens.bombs[i].position.x == NOT_IN_PLAY || aliens.bombs[i].position.y == NOT_IN_PLAY)
+        {
+            bombId = i;
+            break;
+        }
+    }
+
+    int row = aliens.lowestAliveRow[columnToShoot];
+
+    if (row != NOT_IN_PLAY)
+    {
+        int xPos = aliens.position.x + columnToShoot * (aliens.spriteSize.width + Config::ALIENS_X_PADDING) + 1; // middle of the alien
+        int yPos = aliens.position.y + row * (aliens.spriteSize.height + Config::ALIENS_Y_PADDING) + aliens.spriteSize.height; // bottom of the alien
+
+        aliens.bombs[bombId].animation = 0;
+        aliens.bombs[bombId].position.x = xPos;
+        aliens.bombs[bombId].position.y = yPos;
+        aliens.bombs[bombId].y = yPos * FIXED_POINT_ONE;
+        aliens.numberOfBombsInPlay++;
+    }
+}
+
+void ShootBomb(StressSwarm& aliens, int columnToShoot)
+{
+    int row = aliens.lowestAliveRow[columnToShoot];
+
+    if (row != NOT_IN_PLAY)
+    {
+        Position bomb;
+        bomb.x = aliens.position.x + columnToShoot * (aliens.spriteSize.width + StressConfig::ALIENS_X_PADDING) + 1; // middle of the alien
+        bomb.y = aliens.position.y + row * (aliens.spriteSize.height + StressConfig::ALIENS_Y_PADDING) + aliens.spriteSize.height; // bottom of the alien
+        SpawnProjectile(aliens.bombs, bomb);
+    }
+}
+
+template<class Config>
+bool UpdateBombs(const Game& game, AlienSwarmT<Config>& aliens, Player& player, Shield shields[], int numberOfShields)
+{
+    for (int i = 0; i < Config::MAX_NUMBER_OF_ALIEN_BOMBS; i++)
+    {
+        if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
+        {
+            BombFall fall = DropBomb(game, aliens.bombs[i].position, aliens.bombs[i].y, aliens.bombs[i].animation, player, shields, numberOfShields);
+
+            if (fall == BF_HIT_SHIELD || fall == BF_HIT_PLAYER)
+            {
+                aliens.bombs[i].position.x = NOT_IN_PLAY;
+                aliens.bombs[i].position.y = NOT_IN_PLAY;
+                aliens.bombs[i].y = NOT_IN_PLAY * FIXED_POINT_ONE;
+                aliens.bombs[i].animation = 0;
+                aliens.numberOfBombsInPlay--;
+
+                if (fall == BF_HIT_PLAYER)
+                {
+                    return true;
+                }
+            }
+            else if (fall == BF_OFF_SCREEN)
+            {
+                aliens.bombs[i].position.x = NOT_IN_PLAY;
+                aliens.bombs[i].position.y = NOT_IN_PLAY;
+                aliens.bombs[i].y = NOT_IN_PLAY * FIXED_POINT_ONE;
+                aliens.animation = 0;
+                aliens.numberOfBombsInPlay--;
+            }
+        }
+    }
+    return false;
+}
+
+bool UpdateBombs(const Game& game, StressSwarm& aliens, Player& player, Shield shields[], int numberOfShields)
+{
+    ProjectilePool& bombs = aliens.bombs;
+
+    for (size_t i = 0; i < bombs.projectiles.size();)
+    {
+        Projectile& bomb = bombs.projectiles[i];
+        BombFall fall = DropBomb(game, bomb.position, bomb.y, bomb.animation, player, shields, numberOfShields);
+
+        if (fall == BF_FALLING)
+        {
+            i++;
+            continue;
+        }
+
+        RemoveProjectile(bombs, (int)i); // the last bomb is now at i
+
+        if (fall == BF_HIT_PLAYER)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+BombFall DropBomb(const Game& game, Position& position, int& y, int& animation, const Player& player, Shield shields[], int numberOfShields)
+{
+    int numBombSprites = strlen(ALIEN_BOMB_SPRITE);
+    Position from = position;
+
+    y += FixedPointStep(game, ALIEN_BOMB_SPEED * FIXED_POINT_ONE);
+    position.y = FixedPointToCell(y);
+    int distance = position.y - from.y;
+
+    animation = (animation + distance) % numBombSprites; // a frame a cell
+
+    int shieldIndex;
+    Position collisionPoint;
+    int shieldHit = SweepShields(from, 1, distance, shields, numberOfShields, shieldIndex, collisionPoint);
+    int playerHit = SweepSprite(from, 1, distance, player.position, player.spriteSize, SPRITE_MASKS.player);
+
+    if (shieldHit > 0 && (playerHit == 0 || shieldHit <= playerHit)) // the first thing in the way
+    {
+        ResolveShieldCollision(shields, shieldIndex, collisionPoint);
+        return BF_HIT_SHIELD;
+    }
+    else if (playerHit > 0)
+    {
+        return BF_HIT_PLAYER;
+    }
+    else if (position.y >= game.windowSize.height)
+    {
+        return BF_OFF_SCREEN;
+    }
+
+    return BF_FALLING;
+}
+
+/* Aliens vs player */
+
+int SweepSprite(const Position& from, int direction, int distance, const Position& spritePosition, const Size& spriteSize, const SpriteMask& mask)
+{
+    int first, last;
+
+    if (from.x < spritePosition.x || from.x >= spritePosition.x + spriteSize.width ||
+        !FindSweepSpan(from, direction, distance, spritePosition.y, spriteSize.height, first, last))
+    {
+        return 0;
+    }
+
+    for (int cell = first; cell <= last; cell++)
+    {
+        if ((mask.rows[from.y + direction * cell - spritePosition.y] >> (from.x - spritePosition.x)) & 1) // not a blank in the sprite
+        {
+            return cell;
+        }
+    }
+
+    return 0;
+}
+
+/* Restting Game */
+
+template<class Config>
+void ResetGame(Game& game, Player& player, AlienSwarmT<Config>& aliens, Shield shields[], int numberOfShields)
+{
+    game.gameTimer = 0;
+    ResetPlayer(game, player);
+    ResetShields(game, shields, numberOfShields);
+    InitAliens(game, aliens);
+}
+
+void ResetShields(const Game& game, Shield shields[], int numberOfShields)
+{
+    int firstPadding = ceil(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH) / float(numberOfShields + 1));
+    int xPadding = floor(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH) / float(numberOfShields + 1));
+
+    for (int i = 0; i < numberOfShields; i++)
+    {
+        Shield& shield = shields[i];
+        shield.position.x = firstPadding + i * (SHIELD_SPRITE_WIDTH + xPadding);
+        shield.position.y = game.windowSize.height - PLAYER_SPRITE_HEIGHT - 1 - SHIELD_SPRITE_HEIGHT - 2;
+
+        for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+        {
+            shield.rows[row] = SPRITE_MASKS.shield.rows[row];
+        }
+    }
+}
+
+/* Game States */
+
+void DrawGameOverScreen(const Game& game)
+{
+    string gameOverString = "GAME OVER!";
+    string pressSpaceString = "Press Space Bar to continue";
+
+    string namePromptString = "Please Enter your name: ";
+
+    const int yPos = game.windowSize.height / 3;
+    
+    const int gameOverXPos = game.windowSize.width / 2 - gameOverString.length() / 2;
+    const int pressSpaceXPos = game.windowSize.width / 2 - pressSpaceString.length() / 2;
+    const int namePromptXPos = game.windowSize.width / 2 - namePromptString.length() / 2;
+
+    DrawString(gameOverXPos, yPos, gameOverString);
+    DrawString(pressSpaceXPos, yPos + 1, pressSpaceString);
+    DrawString(namePromptXPos, yPos + 3, namePromptString);
+
+    for (int i = 0; i < MAX_NUMBER_OF_CHARACTERS_IN_NAME; i++)
+    {
+        if (i == game.gameOverHPositionCursor)
+        {
+            attron(A_UNDERLINE);
+        }
+
+        DrawCharacter(game.windowSize.width / 2 - MAX_NUMBER_OF_CHARACTERS_IN_NAME / 2 + i, yPos + 5, game.playerName[i]);
+
+        if (i == game.gameOverHPositionCursor)
+        {
+            attroff(A_UNDERLINE);
+        }
+    }
+}
+
+void DrawIntroScreen(const Game& game)
+{
+    string startString = "WELCOME TO TEXT INVADERS!";
+    string pressSpaceString = "Press Space Bar to continue";
+    string pressSString = "Press (s) to go to the high scores";
+
+    const int yPos = game.windowSize.height / 2 - 2;
+    const int startStringXPos = game.windowSize.width / 2 - startString.length() / 2;
+    const int pressSpaceXPos = game.windowSize.width / 2 - pressSpaceString.length() / 2;
+    const int pressSXPos = game.windowSize.width / 2 - pressSString.length() / 2;
+
+    DrawString(startStringXPos, yPos, startString);
+    DrawString(pressSpaceXPos, yPos + 1, pressSpaceString);
+    DrawString(pressSXPos, yPos + 2, pressSString);
+}
+
+/* UFO functions */
+
+void ResetUFO(Game& game, AlienUFO& ufo)
+{
+    ufo.size.width = ALIEN_UFO_SPRITE_WIDTH;
+    ufo.size.height = ALIEN_UFO_SPRITE_HEIGHT;
+
+    ufo.points = ((DrawGameRandom(game.random) % 4) + 1) * 50;
+
+    ufo.position.x = NOT_IN_PLAY; // no UFO on screen, only moves left to right
+    ufo.x = NOT_IN_PLAY * FIXED_POINT_ONE;
+    ufo.position.y = ufo.size.height; // so it starts 2 down from top of screen
+
+    ScheduleGameTimer(game, TIMER_UFO_SPAWN, 0, UFO_SPAWN_TIME);
+}
+
+void PutUFOInPlay(const Game& game, AlienUFO& ufo)
+{
+    ufo.position.x = 0;
+    ufo.x = 0;
+}
+
+void UpdateUFO(Game& game, AlienUFO& ufo)
+{
+    ufo.x += FixedPointStep(game, FIXED_POINT_ONE); // a cell a classic tick
+    ufo.position.x = FixedPointToCell(ufo.x);
+
+    if (ufo.position.x + ufo.size.width >= game.windowSize.width)
+    {
+        ResetUFO(game, ufo);
+    }
+}
+
+void DrawUFO(const AlienUFO& ufo)
+{
+    if (ufo.position.x != NOT_IN_PLAY)
+    {
+        DrawSprite(ufo.position.x, ufo.position.y, ALIEN_UFO_SPRITE, ALIEN_SPRITE_HEIGHT);
+    }
+}
+
+/* Reset Game Over Cursor */
+
+void ResetGameOverPositionCursors(Game& game)
+{
+    game.gameOverHPositionCursor = 0;
+    for (int i = 0; i < MAX_NUMBER_OF_CHARACTERS_IN_NAME; i++)
+    {
+        game.playerName[i] = 'A';
+        game.gameOverVPositionCursor[i] = 0;
+    }
+}
+
+/* HighScore Table */
+
+void AddHighScore(HighScoreTable& table, int score, const string& name)
+{
+    Score highScore;
+    highScore.score = score;
+    highScore.name = name;
+
+    table.scores.push_back(highScore);
+
+    sort(table.scores.begin(), table.scores.end(), ScoreCompare);
+
+    if (table.service != nullptr)
+    {
+        SubmitScore(*table.service, score, name); // the service saves it along with every other instance's
+    }
+    else
+    {
+        SaveHighScores(table);
+    }
+}
+
+bool ScoreCompare(const Score& score1, const Score score2)
+{
+    return score1.score > score2.score; // descending order (highest score will be top)
+}
+
+void DrawHighScoreTable(const Game& game, const HighScoreTable& table)
+{
+    string title = "High Scores";
+    int titleXPos = game.windowSize.width / 2 - title.length()/2;
+    int yPos = 5;
+    int yPadding = 2;
+
+    attron(A_UNDERLINE);
+    DrawString(titleXPos, yPos, title);
+    attroff(A_UNDERLINE);
+
+    for (int i = 0; i < table.scores.size() && i < MAX_HIGH_SCORES; i++)
+    {
+        Score score = table.scores[i];
+        mvprintw(yPos + (i + 1) * yPadding, titleXPos - MAX_NUMBER_OF_CHARACTERS_IN_NAME, "%s\t\t%i", score.name.c_str(), score.score);
+    }
+}
+
+void SaveHighScores(const HighScoreTable& table)
+{
+    if (table.fileName == nullptr)
+    {
+        return;
+    }
+
+    ofstream outFile;
+    outFile.open(table.fileName);
+    if (outFile.is_open())
+    {
+        for (int i = 0; i < table.scores.size() && i < MAX_HIGH_SCORES; i++)
+        {
+            outFile << table.scores[i].name << " " << table.scores[i].score << endl;
+        }
+
+        outFile.close();
+    }
+}
+
+void LoadHighScores(HighScoreTable& table)
+{
+    unsigned int numScoresInLog = 0;
+
+    if (table.service != nullptr && FetchTopScores(table.service->path, table.scores, numScoresInLog))
+    {
+        return;
+    }
+
+    table.service = nullptr; // no service answered - the file, as before there was one
+
+    if (table.fileName == nullptr)
+    {
+        return;
+    }
+
+    ifstream inFile;
+    inFile.open(table.fileName);
+
+    string name;
+    int scoreVal;
+
+    Score score;
+
+    if (inFile.is_open())
+    {
+        while (!inFile.eof())
+        {
+            inFile >> ws;
+            if (inFile.eof())
+            {
+                break;
+            }
+
+            inFile >> name >> scoreVal;
+            score.name = name;
+            score.score = scoreVal;
+
+            table.scores.push_back(score);
+        }
+
+        inFile.close();
+    }
+}
+
+void UpdateHighScores(HighScoreTable& table)
+{
+    if (table.service != nullptr)
+    {
+        UpdateScoreClient(*table.service, table.scores);
+    }
+}
+/* Replays */
+
+int RunReplay(const char* replayFileName, const char* hashLogFileName, bool fastForward, bool verifyFastForward, const GameVariant* variant, int tickRate)
+{
+    InputReplay replay;
+
+    if (!LoadInputReplay(replay, replayFileName))
+    {
+        fprintf(stderr, "Could not load replay %s\n", replayFileName);
+        return 1;
+    }
+
+    if (replay.variant != variant->name)
+    {
+        fprintf(stderr, "Replay %s was recorded with --variant %s, not %s\n", replayFileName, replay.variant.c_str(), variant->name);
+        return 1;
+    }
+
+    if (replay.tickRate != tickRate)
+    {
+        fprintf(stderr, "Replay %s was recorded with --tick-rate %i, not %i\n", replayFileName, replay.tickRate, tickRate);
+        return 1;
+    }
+
+    return variant->replay(replay, hashLogFileName, fastForward, verifyFastForward);
+}
+
+template<class Config>
+int ReplayGame(const InputReplay& replay, const char* hashLogFileName, bool fastForward, bool verifyFastForward)
+{
+    StateHashLogT<Config> hashLog;
+    hashLog.file = nullptr;
+    hashLog.tick = 0;
+
+    if (hashLogFileName != nullptr && !StartStateHashLog(hashLog, hashLogFileName, replay.variant.c_str()))
+    {
+        fprintf(stderr, "Could not create %s\n", hashLogFileName);
+    }
+
+    unsigned int numTicks = (unsigned int)replay.tickDts.size();
+    unsigned int numUpdatedTicks;
+    int score;
+    std::vector<std::pair<unsigned int, uint64_t> > jumps; // tick every jump landed on and the state hash there
+
+    clock_t startTime = clock();
+    uint64_t hash = SimulateReplay<Config>(replay, fastForward || verifyFastForward, hashLog, verifyFastForward ? &jumps : nullptr, score, numUpdatedTicks);
+    clock_t endTime = clock();
+
+    StopStateHashLog(hashLog);
+
+    printf("Replayed %u ticks, score %i, final state hash %016llx\n", numTicks, score, (unsigned long long)hash);
+
+    printf("Ran %u ticks through UpdateGame and jumped over %u in %.3f s\n", numUpdatedTicks, numTicks - numUpdatedTicks, double(endTime - startTime) / CLOCKS_PER_SEC);
+
+    if (!verifyFastForward)
+    {
+        return 0;
+    }
+
+    // the same game again a tick at a time, checking the state wherever fast-forward landed
+    StateHashLogT<Config> checkLog;
+    checkLog.file = nullptr;
+    checkLog.tick = 0;
+
+    Game game;
+    Player player;
+    Shield shields[Config::NUM_SHIELDS];
+    AlienSwarmT<Config> aliens;
+    AlienUFO ufo;
+    HighScoreTable table;
+    table.fileName = nullptr;
+    table.service = nullptr;
+
+    StartReplayGame(replay, game, player, shields, aliens, ufo);
+
+    unsigned int input = 0;
+    size_t jump = 0;
+
+    for (unsigned int tick = 0; tick < numTicks; tick++)
+    {
+        for (; input < replay.tickInputsEnd[tick]; input++)
+        {
+            ProcessInput(replay.inputs[input], game, player, aliens, shields, Config::NUM_SHIELDS, table);
+        }
+
+        UpdateGame(replay.tickDts[tick], game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+
+        if (jump < jumps.size() && jumps[jump].first == tick + 1)
+        {
+            uint64_t tickHash = LogStateHash(checkLog, game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+
+            if (tickHash != jumps[jump].second)
+            {
+                printf("Fast-forward differs from a tick by tick run after tick %u - run both with --hash-log to see what changed\n", tick + 1);
+                return 1;
+            }
+
+            jump++;
+        }
+    }
+
+    if (LogStateHash(checkLog, game, player, shields, Config::NUM_SHIELDS, aliens, ufo) != hash)
+    {
+        printf("Fast-forward ends in a different state from a tick by tick run\n");
+        return 1;
+    }
+
+    printf("Fast-forward matches a tick by tick run at all %u jumps\n", (unsigned int)jumps.size());
+    return 0;
+}
+
+int CompareHashLogs(const char* fileNameA, const char* fileNameB)
+{
+    std::string variantName;
+    const GameVariant* variant = ReadStateHashLogVariant(fileNameA, variantName) ? FindGameVariant(variantName.c_str()) : nullptr;
+
+    if (variant == nullptr)
+    {
+        fprintf(stderr, "%s is not a state hash log from a build with this layout\n", fileNameA);
+        return 2;
+    }
+
+    return variant->compareHashLogs(fileNameA, fileNameB);
+}
+
+template<class Config>
+void StartReplayGame(const InputReplay& replay, Game& game, Player& player, Shield shields[], AlienSwarmT<Config>& aliens, AlienUFO& ufo)
+{
+    InitGame(game, replay.seed);
+    game.windowSize.width = replay.width;
+    game.windowSize.height = replay.height;
+    game.tickRate = replay.tickRate;
+    game.level = 1;
+    InitPlayer(game, player);
+    InitShields(game, shields, Config::NUM_SHIELDS);
+    InitAliens(game, aliens);
+    ResetUFO(game, ufo);
+}
+
+template<class Config>
+uint64_t SimulateReplay(const InputReplay& replay, bool fastForward, StateHashLogT<Config>& hashLog, std::vector<std::pair<unsigned int, uint64_t> >* jumps, int& score, unsigned int& numUpdatedTicks)
+{
+    Game game;
+    Player player;
+    Shield shields[Config::NUM_SHIELDS];
+    AlienSwarmT<Config> aliens;
+    AlienUFO ufo;
+    HighScoreTable table;
+    table.fileName = nullptr; // a replay must never overwrite the saved high scores
+    table.service = nullptr;
+
+    StartReplayGame(replay, game, player, shields, aliens, ufo);
+
+    unsigned int numTicks = (unsigned int)replay.tickDts.size();
+    unsigned int input = 0;
+    unsigned int nextInputTick = 0;
+
+    numUpdatedTicks = 0;
+
+    for (unsigned int tick = 0; tick < numTicks;)
+    {
+        if (fastForward && hashLog.file == nullptr) // a hash log needs every tick
+        {
+            while (nextInputTick < numTicks && (nextInputTick < tick || replay.tickInputsEnd[nextInputTick] == (nextInputTick > 0 ? replay.tickInputsEnd[nextInputTick - 1] : 0)))
+            {
+                nextInputTick++;
+            }
+
+            int numSkipped = SkipIdleTicks(game, player, aliens, ufo, &replay.tickDts[tick], nextInputTick - tick);
+
+            if (numSkipped > 0)
+            {
+                tick += numSkipped;
+
+                if (jumps != nullptr)
+                {
+                    jumps->push_back(std::make_pair(tick, LogStateHash(hashLog, game, player, shields, Config::NUM_SHIELDS, aliens, ufo)));
+                }
+                continue;
+            }
+        }
+
+        for (; input < replay.tickInputsEnd[tick]; input++)
+        {
+            ProcessInput(replay.inputs[input], game, player, aliens, shields, Config::NUM_SHIELDS, table);
+        }
+
+        UpdateGame(replay.tickDts[tick], game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+        numUpdatedTicks++;
+        tick++;
+
+        if (hashLog.file != nullptr)
+        {
+            LogStateHash(hashLog, game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+        }
+    }
+
+    score = player.score;
+
+    StateHashLogT<Config> finalState;
+    finalState.file = nullptr;
+    finalState.tick = 0;
+
+    return LogStateHash(finalState, game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+}
+
+/* Game server sessions */
+
+void StartServerGame(GameWorld& state, int width, int height, unsigned int seed)
+{
+    InitGame(state.game, seed);
+    state.game.windowSize.width = width;
+    state.game.windowSize.height = height;
+    state.game.level = 1;
+    InitPlayer(state.game, state.player);
+    InitShields(state.game, state.shields, NUM_SHIELDS);
+    InitAliens(state.game, state.aliens);
+    ResetUFO(state.game, state.ufo);
+}
+
+int HandleServerInput(const InputEvent& event, GameWorld& state, HighScoreTable& table)
+{
+    return HandleInput(event, state.game, state.player, state.aliens, state.shields, NUM_SHIELDS, table);
+}
+
+void UpdateServerGame(GameWorld& state)
+{
+    UpdateGame(CLOCKS_PER_SEC / FPS, state.game, state.player, state.shields, NUM_SHIELDS, state.aliens, state.ufo);
+}
+
+void DrawServerGame(GameWorld& state, const HighScoreTable& table)
+{
+    DrawGame(state.game, state.player, state.shields, NUM_SHIELDS, state.aliens, state.ufo, table);
+}
+
+/* Stress swarm */
+
+void StartStressGame(StressGame& stress, const Size& fieldSize, int tickRate, unsigned int seed)
+{
+    Game& game = stress.game;
+
+    InitGame(game, seed);
+    game.windowSize = fieldSize;
+    game.tickRate = tickRate; // before anything schedules a timer
+    game.level = 1;
+    game.currentState = GS_PLAY;
+    InitPlayer(game, stress.player);
+    ResetUFO(game, stress.ufo);
+    ScheduleSwarmStep(game, stress.aliens);
+}
+
+void UpdateStressGame(StressGame& stress)
+{
+    Game& game = stress.game;
+    Player& player = stress.player;
+    StressSwarm& aliens = stress.aliens;
+    AlienUFO& ufo = stress.ufo;
+    Shield* shields = stress.shields.data();
+    int numberOfShields = (int)stress.shields.size();
+
+    if (game.currentState != GS_PLAY)
+    {
+        return;
+    }
+
+    UpdateTimers(game, aliens, ufo);
+
+    if (IsLastSubTick(game))
+    {
+        for (size_t i = 0; i < aliens.explosions.size();)
+        {
+            StressExplosion& explosion = aliens.explosions[i];
+
+            if (--explosion.ticksLeft <= 0)
+            {
+                FinishAlienExplosion(aliens, explosion.row, explosion.column);
+                explosion = aliens.explosions.back();
+                aliens.explosions.pop_back();
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    // every missile goes the way the classic game's one does, UFO included
+    ProjectilePool& missiles = stress.missiles;
+
+    for (size_t i = 0; i < missiles.projectiles.size();)
+    {
+        Projectile& missile = missiles.projectiles[i];
+        Position from = missile.position;
+        int distance = MoveMissile(game, missile.position, missile.y, player.score, shields, numberOfShields, aliens);
+
+        if (ufo.position.x != NOT_IN_PLAY && SweepSprite(from, -1, distance, ufo.position, ufo.size, SPRITE_MASKS.alienUFO) > 0)
+        {
+            player.score += ufo.points;
+            ResetUFO(game, ufo);
+            missile.position.y = NOT_IN_PLAY;
+        }
+
+        if (missile.position.y == NOT_IN_PLAY)
+        {
+            RemoveProjectile(missiles, (int)i); // the last missile is now at i
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (UpdateAliens(game, aliens, player, shields, numberOfShields)) // If a player was hit
+    {
+        ClearProjectilePool(aliens.bombs); // there is no wait between lives, so the next one starts under a clear sky
+
+        if (--player.lives <= 0)
+        {
+            game.currentState = GS_GAME_OVER;
+        }
+    }
+
+    if (ufo.position.x != NOT_IN_PLAY)
+    {
+        UpdateUFO(game, ufo);
+    }
+
+    if (aliens.numAliensLeft == 0 && aliens.explosions.empty())
+    {
+        game.currentState = GS_GAME_OVER; // the swarm is gone
+    }
+
+    game.subTick = IsLastSubTick(game) ? 0 : game.subTick + 1;
+}
+
+/* Fast-forward */
+
+template<class Config>
+int SkipIdleTicks(Game& game, Player& player, AlienSwarmT<Config>& aliens, const AlienUFO& ufo, const unsigned int dts[], int maxTicks)
+{
+    if (maxTicks <= 0)
+    {
+        return 0;
+    }
+
+    if (game.currentState == GS_PLAY)
+    {
+        // with nothing flying and the swarm between steps, a tick only draws the random number for the bombs
+        if (player.missile.y != NOT_IN_PLAY || ufo.position.x != NOT_IN_PLAY || aliens.stepDue != 0 || aliens.stepped != 0 || aliens.numAliensLeft == 0)
+        {
+            return 0;
+        }
+
+        for (int i = 0; i < Config::MAX_NUMBER_OF_ALIEN_BOMBS; i++)
+        {
+            if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
+            {
+                return 0;
+            }
+        }
+    }
+
+    unsigned int ticksUntilTimer = TicksUntilNextTimer(game.timers);
+
+    if (ticksUntilTimer <= 1)
+    {
+        return 0;
+    }
+
+    int numTicks = ticksUntilTimer - 1 < (unsigned int)maxTicks ? int(ticksUntilTimer - 1) : maxTicks; // stop short of the next timer
+    int ticksPerClassicTick = game.tickRate / FPS;
+
+    if (game.currentState == GS_PLAY)
+    {
+        // the bomb roll is drawn on the last tick of each classic tick - skip the rolls that miss and stop short of the one that shoots
+        int numRolls = (game.subTick + numTicks) / ticksPerClassicTick;
+        int numMisses = SkipGameRandomUntil(game.random, BombChanceDivisor(aliens), 1, numRolls);
+
+        if (numMisses < numRolls)
+        {
+            numTicks = (numMisses + 1) * ticksPerClassicTick - game.subTick - 1;
+
+            if (numTicks == 0)
+            {
+                return 0;
+            }
+        }
+    }
+
+    for (int tick = 0; tick < numTicks; tick++)
+    {
+        game.gameTimer += dts[tick];
+    }
+
+    SkipTimerWheel(game.timers, numTicks);
+
+    int numClassicTicks = (game.subTick + numTicks) / ticksPerClassicTick; // that ended along the way
+    game.subTick = (game.subTick + numTicks) % ticksPerClassicTick;
+
+    if (game.currentState == GS_PLAYER_DEAD)
+    {
+        player.animation = (player.animation + numClassicTicks) % 2;
+    }
+
+    return numTicks;
+}
+
+/* Game variants */
+
+const GameVariant GAME_VARIANTS[] =
+{
+    { "classic", "5 rows of 11 aliens, 3 bombs and 4 shields", 0, 0, nullptr, ReplayGame<ClassicConfig>, CompareStateHashLogs<ClassicConfig> },
+    { "wide", "8 rows of 20 aliens, 5 bombs and 5 shields - needs a terminal at least 110 wide and 40 high", 110, 40, PlayGameVariant<WideConfig>, ReplayGame<WideConfig>, CompareStateHashLogs<WideConfig> },
+};
+
+const GameVariant* FindGameVariant(const char* name)
+{
+    for (size_t i = 0; i < sizeof(GAME_VARIANTS) / sizeof(GAME_VARIANTS[0]); i++)
+    {
+        if (strcmp(GAME_VARIANTS[i].name, name) == 0)
+        {
+            return &GAME_VARIANTS[i];
+        }
+    }
+
+    return nullptr;
+}
+
+void PrintGameVariants(FILE* out)
+{
+    for (size_t i = 0; i < sizeof(GAME_VARIANTS) / sizeof(GAME_VARIANTS[0]); i++)
+    {
+        fprintf(out, "  %-10s %s\n", GAME_VARIANTS[i].name, GAME_VARIANTS[i].description);
+    }
+}
+
+template<class Config>
+int PlayGameVariant(const GameVariant& variant, bool rawInput, const char* inputRecordingFileName, const char* hashLogFileName, bool practiceMode, int tickRate, unsigned int seed)
+{
+    Game game;
+    Player player;
+    Shield shields[Config::NUM_SHIELDS];
+    AlienSwarmT<Config> aliens;
+    AlienUFO ufo;
+    HighScoreTable table;
+    table.fileName = nullptr; // scores from other variants don't belong in the classic table
+    table.service = nullptr;
+
+    InitializeCurses(true);
+
+    if (ScreenWidth() < variant.minWidth || ScreenHeight() < variant.minHeight)
+    {
+        int width = ScreenWidth();
+        int height = ScreenHeight();
+        ShutDownCurses();
+
+        fprintf(stderr, "--variant %s needs a terminal at least %i wide and %i high, this one is %ix%i\n", variant.name, variant.minWidth, variant.minHeight, width, height);
+        return 1;
+    }
+
+    RawInput keyboard;
+    InitRawInput(keyboard, rawInput);
+
+    InitGame(game, seed);
+    game.tickRate = tickRate; // before anything schedules a timer
+    game.level = 1;
+    InitPlayer(game, player);
+    InitShields(game, shields, Config::NUM_SHIELDS);
+    InitAliens(game, aliens);
+    ResetUFO(game, ufo);
+
+    RewindBufferT<Config> rewindBuffer;
+    ClearRewindBuffer(rewindBuffer);
+
+    InputRecorder inputRecorder;
+    inputRecorder.file = nullptr;
+
+    if (inputRecordingFileName != nullptr)
+    {
+        StartInputRecording(inputRecorder, inputRecordingFileName, variant.name, seed, game.windowSize.width, game.windowSize.height, game.tickRate);
+        practiceMode = false; // rewinding is not an input the replay can reproduce
+    }
+
+    StateHashLogT<Config> hashLog;
+    hashLog.file = nullptr;
+
+    if (hashLogFileName != nullptr)
+    {
+        StartStateHashLog(hashLog, hashLogFileName, variant.name);
+    }
+
+    bool quit = false;
+    int input;
+
+    clock_t lastTime = clock();
+    int ticksUntilFrame = 0;
+
+    while (!quit)
+    {
+        input = HandleInput(ReadInputEvent(keyboard), game, player, aliens, shields, Config::NUM_SHIELDS, table);
+        RecordInput(inputRecorder, input);
+
+        if (input != 'q')
+        {
+            if (practiceMode && input == 'r' && (game.currentState == GS_PLAY || game.currentState == GS_PLAYER_DEAD))
+            {
+                Rewind(rewindBuffer, REWIND_STEP_TICKS, game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+            }
+
+            clock_t dt;
+
+            if (IsTickDue(game, lastTime, dt))
+            {
+                UpdateGame(dt, game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+                RecordTick(inputRecorder, (unsigned int)dt);
+
+                if (hashLog.file != nullptr)
+                {
+                    LogStateHash(hashLog, game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+                }
+
+                if (practiceMode && game.subTick == 0)
+                {
+                    if (game.currentState == GS_PLAY)
+                    {
+                        RecordRewindTick(rewindBuffer, game, player, shields, Config::NUM_SHIELDS, aliens, ufo);
+                    }
+                    else if (game.currentState == GS_INTRO || game.currentState == GS_GAME_OVER)
+                    {
+                        ClearRewindBuffer(rewindBuffer);
+                    }
+                }
+
+                if (--ticksUntilFrame > 0)
+                {
+                    continue;
+                }
+
+                ticksUntilFrame = TicksPerFrame(game);
+
+                ClearScreen();
+                DrawGame(game, player, shields, Config::NUM_SHIELDS, aliens, ufo, table);
+                RefreshScreen();
+            }
+        }
+        else
+        {
+            quit = true;
+        }
+    }
+
+    StopStateHashLog(hashLog);
+    StopInputRecording(inputRecorder);
+    ShutDownRawInput(keyboard);
+    ShutDownCurses();
+
+    return 0;
+}
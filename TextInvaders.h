@@ -1,301 +1,423 @@
-#pragma once
-#ifndef TEXTINVADERS_H_
-#define TEXTINVADERS_H_
-
-#include <string>
-#include <vector>
-
-const char* PLAYER_SPRITE[] = { " =A= ", "=====" };
-
-const char* PLAYER_EXPLOSION_SPRITE[] = { ",~^,'", "=====", "'+-`.", "=====" };
-
-const char PLAYER_MISSILE_SPRITE = '|';
-
-const char* SHIELD_SPRITE[] = { "/IIIII\\", "IIIIIII", "I/   \\I"};
-
-const char* ALIEN30_SPRITE[] = { "/oo\\", "<  >", "/oo\\", "/\"\"\\" };
-
-const char* ALIEN20_SPRITE[] = { " >< ", "|\\/|", "|><|", "/  \\" };
-
-const char* ALIEN10_SPRITE[] = { "/--\\", "/  \\", "/--\\", "<  >" };
-
-const char* ALIEN_EXPLOSION[] = { "\\||/", "/||\\" };
-
-const char* ALIEN_BOMB_SPRITE = "\\|/-";
-
-const char* ALIEN_UFO_SPRITE[] = { "_/oo\\_", "=q==p=" };
-
-const char* FILE_NAME = "TextInvadersHighScoresTable.txt";
-
-enum
-{
-	SHIELD_SPRITE_HEIGHT = 3,
-	SHIELD_SPRITE_WIDTH = 7,
-	NUM_ALIEN_ROWS = 5,
-	NUM_ALIEN_COLUMNS = 11,
-	MAX_NUMBER_OF_ALIEN_BOMBS = 3,
-	MAX_NUMBER_OF_LIVES = 3,
-	PLAYER_SPRITE_WIDTH = 5,
-	PLAYER_SPRITE_HEIGHT = 2,
-	NOT_IN_PLAY = -1,
-	PLAYER_MOVEMENT_AMOUNT = 2,
-	PLAYER_MISSILE_SPEED = 1,
-	FPS = 20,
-	NUM_SHIELDS = 4,
-	ALIEN_SPRITE_WIDTH = 4,
-	ALIEN_SPRITE_HEIGHT = 2,
-	ALIENS_X_PADDING = 1,
-	ALIENS_Y_PADDING = 1,
-	ALIEN_EXPLOSION_TIME = 4,
-	ALIEN_BOMB_SPEED = 1,
-	WAIT_TIME = 1,
-	NUM_LEVELS = 10,
-	ALIEN_UFO_SPRITE_WIDTH = 6,
-	ALIEN_UFO_SPRITE_HEIGHT = 2,
-	MAX_NUMBER_OF_CHARACTERS_IN_NAME = 3,
-	MAX_ALPHABET_CHARACTERS = 26,
-	MAX_HIGH_SCORES = 10,
-};
-
-enum AlienState
-{
-	AS_ALIVE = 0,
-	AS_DEAD,
-	AS_EXPLODING
-};
-
-enum GameState
-{
-	GS_INTRO = 0,
-	GS_HIGH_SCORE,
-	GS_PLAY,
-	GS_PLAYER_DEAD,
-	GS_WAIT,
-	GS_GAME_OVER
-};
-
-struct Position
-{
-	int x;
-	int y;
-};
-
-struct Size
-{
-	int width;
-	int height;
-};
-
-struct Player
-{
-	Position position;
-	Position missile;
-	Size spriteSize;
-	int animation;
-	int lives; // Max 3
-	int score;
-};
-
-struct Shield
-{
-	Position position;
-	char* sprite[SHIELD_SPRITE_HEIGHT];
-};
-
-struct AlienBomb
-{
-	Position position;
-	int animation;
-};
-
-struct AlienSwarm
-{
-	Position position;
-	AlienState aliens[NUM_ALIEN_ROWS][NUM_ALIEN_COLUMNS];
-	AlienBomb bombs[MAX_NUMBER_OF_ALIEN_BOMBS];
-	Size spriteSize;
-	int animation;
-	int direction; // > 0 - for going right, < 0 - for going left
-	int numberOfBombsInPlay;
-	int movementTime; // this is going to capture how fast the aliens should be going
-	int explosionTimer; // this is going to capture how long to explode for
-	int numAliensLeft; // this is to capture when to go to the next level
-	int line; // this is to capture when the aliens win - starts at the current level and decreases to 0 - once it's 0, then the aliens win
-};
-
-struct AlienUFO
-{
-	Position position;
-	Size size;
-	int points; // from 50 - 200
-};
-
-struct Score
-{
-	int score;
-	std::string name; //std:: because we're not saying using namespace std
-};
-
-struct HighScoreTable
-{
-	std::vector<Score> scores;
-};
-
-struct Game
-{
-	Size windowSize;
-	GameState currentState;
-	int level;
-	int waitTimer;
-	clock_t gameTimer;
-
-	int gameOverHPositionCursor; // where the horizontal cursor is
-	char playerName[MAX_NUMBER_OF_CHARACTERS_IN_NAME + 1];
-	int gameOverVPositionCursor[MAX_NUMBER_OF_CHARACTERS_IN_NAME]; // store where we were
-
-};
-
-/*
-Text Invaders:
-
-(from: http://www.classicgaming.cc/classics/space-invaders/play-guide)
-
-The object of the game is to shoot the invaders with your missile base while avoiding their shots and preventing an invasion.
-Amassing a high score is a further objective and one that must be prioritised against your continued survival.
-Each game screen starts with five rows of 11 invaders.
-The bottom 2 rows score 10 points per large invader, the middle 2 rows 20 points for each medium invader and the top row scores 30 points for
-each small invader. This makes each screen worth a total of 990 points.
-The score for each screen can be dramatically increased by the destruction of the 'mystery' value spaceships that frequently fly from
-one side of the screen to the other. The mystery ufo should have a points value of 50 to 200 points.
-Temporary sanctuary can be sought beneath the 4 base shields. Shields are destructable by both the player and the aliens. Only the part of the
-shield hit by either a player missile or an alien bomb should be destroyed not the entire shield.
-
-The invaders travel sideways and each time they touch the side they drop down 1 line.
-On level 1 they need to drop 11 lines to reach the bottom and 'invade'.
-From level 2 through to screen 9 they start progressively lower down the screen.
-At screen 10 the game reverts to the screen 1 start position and the cycle begins again.
-
-There is no time limit, except for the fact that if you do not shoot them all before they reach the bottom of the screen the game ends.
-
-The more invaders the player shoots, the faster the remaining invaders move.
-When the invaders are low enough to touch the base shelters they erase them as they pass. The last invader moves very quickly.
-
-Any bombs dropped by an invader on the row above 'invasion' row will not harm the player's missile.
-
-The aliens can have a maximum of 3 bombs on screen at any one time. The player can have only 1 missile shot on screen at any one time.
-
-If the player is hit, the game should pause, and the player should be showing the exploding animation.
-
-If an alien is hit, they should explode for a short period of time then disappear.
-
-There should be an intro screen, game over screen (where the player can enter their name), and high score screen
-
-There should be a high score table that can be seen from the initial welcome screen and after the game is over and the player enters his/her 3 letter name
-
-
-All regular aliens are 2 by 4 in terms of size (2 rows of 4 columns)
-Player is 2 by 5
-Alien UFO is 2 by 6
-
-Alien sprites:
-30 point aliens:  /oo\  /oo\
-				  <  >  /""\
-
-20 point aliens:  ><  |><|
-				 |\/| /  \
-
-10 point aliens: /--\  /--\
-				 /  \  <  >
-
-Alien Explosion: \||/
-				 /||\
-
-alien bombs: \ | / -
-
-Alien UFO: _/oo\_
-		   =q==p=
-
-Player sprite:  =A=
-			   =====
-					0    1
-Player explosion: ,~^.' '+-`.
-				  ===== =====
-
-Shield: /IIIII\
-		IIIIIII
-		I/   \I
-
-
-General Data:
--------------
-Player
-Aliens
-Shields
-Alien bombs
-Player missiles
-Game states
-Scores
-High Score table
-
-
-Player
-------
-Position
-Missile - position
-Animation State
-Size of the sprite
-Lives (3)
-Score
-
-Shields
--------
-Sprite - the sprite can change
-Position
-
-Alien Swarm (all the 10, 20, and 30 point aliens)
------------
-Position
-direction (left or right)
-animation state
-size of each alien
-State of each alien - alive, dead, or exploding
-Alien bombs
-
-Alien UFO
----------
-size
-position
-points
-
-Position
---------
-x, y coordinate
-
-Alien Bomb
----------
-position
-animation state - \ | / -
-
-Missile (sprite - |)
--------
-Position
-
-Game
------
-Game State
-Level
-size of the window
-
-Score
------
-score value
-name
-
-High Score table
-----------------
-vector of scores
-
-*/
-
-
+#pragma once
+#ifndef TEXTINVADERS_H_
+#define TEXTINVADERS_H_
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "TimerWheel.h"
+#include "GameRandom.h"
+
+constexpr const char* PLAYER_SPRITE[] = { " =A= ", "=====" };
+
+constexpr const char* PLAYER_EXPLOSION_SPRITE[] = { ",~^,'", "=====", "'+-`.", "=====" };
+
+const char PLAYER_MISSILE_SPRITE = '|';
+
+constexpr const char* SHIELD_SPRITE[] = { "/IIIII\\", "IIIIIII", "I/   \\I"};
+
+constexpr const char* ALIEN30_SPRITE[] = { "/oo\\", "<  >", "/oo\\", "/\"\"\\" };
+
+constexpr const char* ALIEN20_SPRITE[] = { " >< ", "|\\/|", "|><|", "/  \\" };
+
+constexpr const char* ALIEN10_SPRITE[] = { "/--\\", "/  \\", "/--\\", "<  >" };
+
+constexpr const char* ALIEN_EXPLOSION[] = { "\\||/", "/||\\" };
+
+const char* const ALIEN_BOMB_SPRITE = "\\|/-";
+
+constexpr const char* ALIEN_UFO_SPRITE[] = { "_/oo\\_", "=q==p=" };
+
+const char* const FILE_NAME = "TextInvadersHighScoresTable.txt";
+
+/*
+Game Config:
+
+The swarm, bomb and shield counts and the size of an alien the simulation is built for. Everything that loops over
+aliens, bombs or shields takes its config as a template argument, so each variant is compiled with its own constant
+bounds - the loops unroll and fold the same as if the numbers were typed in.
+
+Every variant draws the same alien sprites for now, so they all have the same alien size - a variant with sprites of
+its own sizes them here. The player, shield and UFO sizes are not part of a config: Player, Shield and AlienUFO are one
+type for every variant, and a shield's rows are bytes sized by SHIELD_SPRITE_HEIGHT.
+*/
+
+template<int Rows, int Columns, int Lines, int MaxBombs, int Shields>
+struct GameConfig
+{
+	enum
+	{
+		NUM_ALIEN_ROWS = Rows,
+		NUM_ALIEN_COLUMNS = Columns,
+		NUM_ALIEN_LINES = Lines, // how many lines the swarm drops on level 1 before it invades
+		NUM_30_POINT_ALIEN_ROWS = Rows / 5, // the top fifth of the swarm is worth 30, the next two fifths 20 and the rest 10
+		NUM_20_POINT_ALIEN_ROWS = 2 * Rows / 5,
+		MAX_NUMBER_OF_ALIEN_BOMBS = MaxBombs,
+		NUM_SHIELDS = Shields,
+		ALIENS_X_PADDING = 1,
+		ALIENS_Y_PADDING = 1,
+		ALIEN_SPRITE_WIDTH = 4,
+		ALIEN_SPRITE_HEIGHT = 2, // of one animation frame
+	};
+
+	static_assert(Columns <= 32, "AlienSwarm keeps one bit per column in an unsigned int");
+	static_assert(Rows * Columns <= 256, "an alien's explosion timer carries its index in a byte");
+};
+
+typedef GameConfig<5, 11, 11, 3, 4> ClassicConfig;
+typedef GameConfig<8, 20, 11, 5, 5> WideConfig; // --variant wide
+
+enum
+{
+	SHIELD_SPRITE_HEIGHT = 3,
+	SHIELD_SPRITE_WIDTH = 7,
+	NUM_ALIEN_ROWS = ClassicConfig::NUM_ALIEN_ROWS,
+	NUM_ALIEN_COLUMNS = ClassicConfig::NUM_ALIEN_COLUMNS,
+	MAX_NUMBER_OF_ALIEN_BOMBS = ClassicConfig::MAX_NUMBER_OF_ALIEN_BOMBS,
+	MAX_NUMBER_OF_LIVES = 3,
+	PLAYER_SPRITE_WIDTH = 5,
+	PLAYER_SPRITE_HEIGHT = 2,
+	NOT_IN_PLAY = -1,
+	PLAYER_MOVEMENT_AMOUNT = 2,
+	PLAYER_MISSILE_SPEED = 1,
+	FPS = 20,
+	MAX_TICK_RATE = 12 * FPS, // --tick-rate
+	MAX_DRAW_RATE = 3 * FPS, // frames a second at most, whatever the tick rate
+	MAX_LAG_TICKS = 10, // ticks the game can fall behind the clock before it stops catching up
+	NUM_SHIELDS = ClassicConfig::NUM_SHIELDS,
+	ALIEN_SPRITE_WIDTH = ClassicConfig::ALIEN_SPRITE_WIDTH,
+	ALIEN_SPRITE_HEIGHT = ClassicConfig::ALIEN_SPRITE_HEIGHT,
+	ALIENS_X_PADDING = ClassicConfig::ALIENS_X_PADDING,
+	ALIENS_Y_PADDING = ClassicConfig::ALIENS_Y_PADDING,
+	ALIEN_EXPLOSION_TIME = 4,
+	UFO_SPAWN_TIME = 25 * FPS, // ticks between one UFO leaving and the next one coming on
+	ALIEN_BOMB_SPEED = 1,
+	WAIT_TIME = 1,
+	RESPAWN_WAIT_TIME = 10,
+	NUM_LEVELS = 10,
+	ALIEN_UFO_SPRITE_WIDTH = 6,
+	ALIEN_UFO_SPRITE_HEIGHT = 2,
+	MAX_NUMBER_OF_CHARACTERS_IN_NAME = 3,
+	MAX_ALPHABET_CHARACTERS = 26,
+	MAX_HIGH_SCORES = 10,
+};
+
+enum AlienState
+{
+	AS_ALIVE = 0,
+	AS_DEAD,
+	AS_EXPLODING
+};
+
+enum GameState
+{
+	GS_INTRO = 0,
+	GS_HIGH_SCORE,
+	GS_PLAY,
+	GS_PLAYER_DEAD,
+	GS_WAIT,
+	GS_GAME_OVER
+};
+
+enum BombFall
+{
+	BF_FALLING = 0,
+	BF_HIT_SHIELD,
+	BF_HIT_PLAYER,
+	BF_OFF_SCREEN
+};
+
+struct Position
+{
+	int x;
+	int y;
+};
+
+struct Size
+{
+	int width;
+	int height;
+};
+
+struct Player
+{
+	Position position;
+	Position missile;
+	int missileY; // fixed point height of the missile, missile.y is this rounded
+	Size spriteSize;
+	int animation;
+	int lives; // Max 3
+	int score;
+};
+
+static_assert(SHIELD_SPRITE_WIDTH <= 8, "a shield row is one byte of bits");
+
+struct Shield
+{
+	Position position;
+	unsigned char rows[SHIELD_SPRITE_HEIGHT]; // bit x is set while the SHIELD_SPRITE character at x is still standing
+};
+
+struct AlienBomb
+{
+	Position position;
+	int y; // fixed point height, position.y is this rounded
+	int animation;
+};
+
+template<class Config>
+struct AlienSwarmT
+{
+	Position position;
+	AlienState aliens[Config::NUM_ALIEN_ROWS][Config::NUM_ALIEN_COLUMNS];
+	AlienBomb bombs[Config::MAX_NUMBER_OF_ALIEN_BOMBS];
+	Size spriteSize;
+	int animation;
+	int direction; // > 0 - for going right, < 0 - for going left
+	int numberOfBombsInPlay;
+	int movementTime; // this is going to capture how fast the aliens should be going - ticks between steps
+	int stepDue; // set by the TIMER_SWARM_STEP timer, cleared once the swarm has moved - an int so the struct has no padding to snapshot
+	int stepped; // set when the swarm steps sideways, so it shoots no bombs that classic tick - cleared at the end of each one
+	int numAliensLeft; // this is to capture when to go to the next level
+	int line; // this is to capture when the aliens win - starts at the current level and decreases to 0 - once it's 0, then the aliens win
+
+	// kept up to date by InitAliens, ResolveAlienCollision and FinishAlienExplosion so nothing has to scan the whole swarm every tick
+	int lowestAliveRow[Config::NUM_ALIEN_COLUMNS]; // bottom most AS_ALIVE alien of each column - NOT_IN_PLAY once the column has none
+	unsigned int aliveColumns; // bit per column that still has an AS_ALIVE alien
+	int occupiedInColumn[Config::NUM_ALIEN_COLUMNS]; // aliens that are not AS_DEAD yet (alive or exploding) in each column
+	int occupiedInRow[Config::NUM_ALIEN_ROWS]; // same for each row
+	int leftColumn; // first column with an alien that is not AS_DEAD - NUM_ALIEN_COLUMNS if there are none
+	int rightColumn; // last column with an alien that is not AS_DEAD - -1 if there are none
+	int bottomRow; // last row with an alien that is not AS_DEAD - -1 if there are none
+};
+
+typedef AlienSwarmT<ClassicConfig> AlienSwarm; // the game everything else (snapshots, hashes, frame export) is written for
+
+struct AlienUFO
+{
+	Position position;
+	int x; // fixed point, position.x is this rounded
+	Size size;
+	int points; // from 50 - 200
+};
+
+struct Score
+{
+	int score;
+	std::string name; //std:: because we're not saying using namespace std
+};
+
+struct ScoreClient; // ScoreService.h
+
+struct HighScoreTable
+{
+	std::vector<Score> scores;
+	const char* fileName; // where scores are saved and loaded, nullptr keeps them in memory only (replays)
+	ScoreClient* service; // the score service scores go to instead of fileName, nullptr for none
+};
+
+/*
+Tick Rate:
+
+The game ticks FPS times a second, and every timing in it - the swarm's step table, explosions, waits, the UFO - is
+counted in those classic ticks. TextInvaders --tick-rate ticks runs it at any multiple of FPS up to MAX_TICK_RATE
+instead, so a key is acted on and drawn within a few milliseconds rather than up to a whole classic tick later. It plays
+at the same speed at any rate:
+
+- the missile, the bombs and the UFO have fixed point positions (FIXED_POINT_ONE to a cell) and on the nth of the N
+  ticks in a classic tick move speed * (n + 1) / N - speed * n / N, so each classic tick adds up to exactly their
+  classic speed - they are drawn and hit tested in the cell they are nearest to
+- timers are still given in classic ticks and go on the wheel as N times as many ticks, so swarm steps, explosions and
+  waits take as long as ever but go off on the tick they are due rather than on the next classic tick
+- the player and the swarm move whole cells at once, the player as soon as its key comes in and the swarm when its step
+  timer goes off
+- the bomb roll and the dead player's animation happen once a classic tick, on its last tick
+
+At FPS ticks a second every tick is a whole classic tick and the game is exactly what it was. An input replay keeps the
+rate it was recorded at and only plays back at that rate.
+*/
+
+struct Game
+{
+	Size windowSize;
+	GameState currentState;
+	int level;
+	clock_t gameTimer;
+	TimerWheel timers; // explosions, swarm steps, waits and UFOs - advanced once per UpdateGame
+	int tickRate; // ticks a second, a multiple of FPS - set by InitGame to FPS
+	int subTick; // of the current classic tick, 0 to tickRate / FPS - 1
+	GameRandom random; // every random number the simulation draws
+
+	int gameOverHPositionCursor; // where the horizontal cursor is
+	char playerName[MAX_NUMBER_OF_CHARACTERS_IN_NAME + 1];
+	int gameOverVPositionCursor[MAX_NUMBER_OF_CHARACTERS_IN_NAME]; // store where we were
+
+};
+
+struct GameWorld // one whole game, for code that runs many of them side by side
+{
+	Game game;
+	Player player;
+	Shield shields[NUM_SHIELDS];
+	AlienSwarm aliens;
+	AlienUFO ufo;
+};
+
+struct InputReplay;
+
+struct GameVariant
+{
+	const char* name;
+	const char* description;
+	int minWidth; // the terminal it needs
+	int minHeight;
+	int (*play)(const GameVariant& variant, bool rawInput, const char* inputRecordingFileName, const char* hashLogFileName, bool practiceMode, int tickRate, unsigned int seed); // nullptr for the classic game, which main plays with every option - rawInput is false with --curses-input, the files are nullptr without --record-inputs and --hash-log
+	int (*replay)(const InputReplay& replay, const char* hashLogFileName, bool fastForward, bool verifyFastForward);
+	int (*compareHashLogs)(const char* fileNameA, const char* fileNameB); // two --hash-log files written by this variant
+};
+
+/*
+Text Invaders:
+
+(from: http://www.classicgaming.cc/classics/space-invaders/play-guide)
+
+The object of the game is to shoot the invaders with your missile base while avoiding their shots and preventing an invasion.
+Amassing a high score is a further objective and one that must be prioritised against your continued survival.
+Each game screen starts with five rows of 11 invaders.
+The bottom 2 rows score 10 points per large invader, the middle 2 rows 20 points for each medium invader and the top row scores 30 points for
+each small invader. This makes each screen worth a total of 990 points.
+The score for each screen can be dramatically increased by the destruction of the 'mystery' value spaceships that frequently fly from
+one side of the screen to the other. The mystery ufo should have a points value of 50 to 200 points.
+Temporary sanctuary can be sought beneath the 4 base shields. Shields are destructable by both the player and the aliens. Only the part of the
+shield hit by either a player missile or an alien bomb should be destroyed not the entire shield.
+
+The invaders travel sideways and each time they touch the side they drop down 1 line.
+On level 1 they need to drop 11 lines to reach the bottom and 'invade'.
+From level 2 through to screen 9 they start progressively lower down the screen.
+At screen 10 the game reverts to the screen 1 start position and the cycle begins again.
+
+There is no time limit, except for the fact that if you do not shoot them all before they reach the bottom of the screen the game ends.
+
+The more invaders the player shoots, the faster the remaining invaders move.
+When the invaders are low enough to touch the base shelters they erase them as they pass. The last invader moves very quickly.
+
+Any bombs dropped by an invader on the row above 'invasion' row will not harm the player's missile.
+
+The aliens can have a maximum of 3 bombs on screen at any one time. The player can have only 1 missile shot on screen at any one time.
+
+If the player is hit, the game should pause, and the player should be showing the exploding animation.
+
+If an alien is hit, they should explode for a short period of time then disappear.
+
+There should be an intro screen, game over screen (where the player can enter their name), and high score screen
+
+There should be a high score table that can be seen from the initial welcome screen and after the game is over and the player enters his/her 3 letter name
+
+
+All regular aliens are 2 by 4 in terms of size (2 rows of 4 columns)
+Player is 2 by 5
+Alien UFO is 2 by 6
+
+Alien sprites:
+30 point aliens:  /oo\  /oo\
+				  <  >  /""\
+
+20 point aliens:  ><  |><|
+				 |\/| /  \
+
+10 point aliens: /--\  /--\
+				 /  \  <  >
+
+Alien Explosion: \||/
+				 /||\
+
+alien bombs: \ | / -
+
+Alien UFO: _/oo\_
+		   =q==p=
+
+Player sprite:  =A=
+			   =====
+					0    1
+Player explosion: ,~^.' '+-`.
+				  ===== =====
+
+Shield: /IIIII\
+		IIIIIII
+		I/   \I
+
+
+General Data:
+-------------
+Player
+Aliens
+Shields
+Alien bombs
+Player missiles
+Game states
+Scores
+High Score table
+
+
+Player
+------
+Position
+Missile - position
+Animation State
+Size of the sprite
+Lives (3)
+Score
+
+Shields
+-------
+Sprite - the sprite can change
+Position
+
+Alien Swarm (all the 10, 20, and 30 point aliens)
+-----------
+Position
+direction (left or right)
+animation state
+size of each alien
+State of each alien - alive, dead, or exploding
+Alien bombs
+
+Alien UFO
+---------
+size
+position
+points
+
+Position
+--------
+x, y coordinate
+
+Alien Bomb
+---------
+position
+animation state - \ | / -
+
+Missile (sprite - |)
+-------
+Position
+
+Game
+-----
+Game State
+Level
+size of the window
+
+Score
+-----
+score value
+name
+
+High Score table
+----------------
+vector of scores
+
+*/
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,197 @@
+
+#include <climits>
+#include <cstring>
+
+#include "TimerWheel.h"
+
+static short* SlotFor(TimerWheel& wheel, unsigned int due)
+{
+	unsigned int ticksLeft = due - wheel.now;
+
+	if (ticksLeft < TIMER_WHEEL_SLOTS)
+	{
+		return &wheel.slots[0][due % TIMER_WHEEL_SLOTS];
+	}
+	else if (ticksLeft < TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS)
+	{
+		return &wheel.slots[1][(due / TIMER_WHEEL_SLOTS) % TIMER_WHEEL_SLOTS];
+	}
+
+	return &wheel.slots[1][(wheel.now / TIMER_WHEEL_SLOTS + TIMER_WHEEL_SLOTS - 1) % TIMER_WHEEL_SLOTS]; // the furthest slot, placed again when it comes down
+}
+
+static void InsertTimer(TimerWheel& wheel, short index)
+{
+	short* slot = SlotFor(wheel, wheel.timers[index].due);
+
+	wheel.timers[index].next = *slot;
+	*slot = index;
+}
+
+static void FreeTimer(TimerWheel& wheel, short index)
+{
+	wheel.timers[index].type = TIMER_FREE;
+	wheel.timers[index].due = 0;
+	wheel.timers[index].data = 0;
+	wheel.timers[index].next = wheel.freeTimers;
+	wheel.freeTimers = index;
+}
+
+void ClearTimerWheel(TimerWheel& wheel)
+{
+	memset(&wheel, 0, sizeof(wheel));
+	memset(wheel.slots, 0xff, sizeof(wheel.slots)); // NO_TIMER in every slot
+
+	wheel.expired = NO_TIMER;
+	wheel.freeTimers = 0;
+
+	for (int i = 0; i < MAX_NUMBER_OF_TIMERS; i++)
+	{
+		wheel.timers[i].next = i + 1 < MAX_NUMBER_OF_TIMERS ? (short)(i + 1) : (short)NO_TIMER;
+	}
+}
+
+bool ScheduleTimer(TimerWheel& wheel, TimerType type, int data, unsigned int delay)
+{
+	short index = wheel.freeTimers;
+
+	if (index == NO_TIMER || data < 0 || data > UCHAR_MAX) // rather than go off with some other alien's data
+	{
+		return false;
+	}
+
+	if (delay == 0) // this tick's slot has already been emptied
+	{
+		delay = 1;
+	}
+
+	wheel.freeTimers = wheel.timers[index].next;
+	wheel.timers[index].due = wheel.now + delay;
+	wheel.timers[index].type = (unsigned char)type;
+	wheel.timers[index].data = (unsigned char)data;
+
+	InsertTimer(wheel, index);
+	return true;
+}
+
+static void CancelTimersInList(TimerWheel& wheel, short& list, TimerType type)
+{
+	short* link = &list;
+
+	while (*link != NO_TIMER)
+	{
+		short index = *link;
+
+		if (wheel.timers[index].type == type)
+		{
+			*link = wheel.timers[index].next;
+			FreeTimer(wheel, index);
+		}
+		else
+		{
+			link = &wheel.timers[index].next;
+		}
+	}
+}
+
+void CancelTimers(TimerWheel& wheel, TimerType type)
+{
+	for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+		{
+			CancelTimersInList(wheel, wheel.slots[level][slot], type);
+		}
+	}
+
+	CancelTimersInList(wheel, wheel.expired, type);
+}
+
+void AdvanceTimerWheel(TimerWheel& wheel)
+{
+	wheel.now++;
+
+	if (wheel.now % TIMER_WHEEL_SLOTS == 0) // the first level wrapped around - bring down the next block of the second level
+	{
+		short* slot = &wheel.slots[1][(wheel.now / TIMER_WHEEL_SLOTS) % TIMER_WHEEL_SLOTS];
+		short index = *slot;
+		*slot = NO_TIMER;
+
+		while (index != NO_TIMER)
+		{
+			short next = wheel.timers[index].next;
+			InsertTimer(wheel, index);
+			index = next;
+		}
+	}
+
+	short* slot = &wheel.slots[0][wheel.now % TIMER_WHEEL_SLOTS];
+
+	if (*slot != NO_TIMER)
+	{
+		short* tail = &wheel.expired;
+
+		while (*tail != NO_TIMER)
+		{
+			tail = &wheel.timers[*tail].next;
+		}
+
+		*tail = *slot;
+		*slot = NO_TIMER;
+	}
+}
+
+bool PopExpiredTimer(TimerWheel& wheel, TimerType& type, int& data)
+{
+	short index = wheel.expired;
+
+	if (index == NO_TIMER)
+	{
+		return false;
+	}
+
+	type = (TimerType)wheel.timers[index].type;
+	data = wheel.timers[index].data;
+	wheel.expired = wheel.timers[index].next;
+	FreeTimer(wheel, index);
+
+	return true;
+}
+
+unsigned int TicksUntilNextTimer(const TimerWheel& wheel)
+{
+	if (wheel.expired != NO_TIMER)
+	{
+		return 0;
+	}
+
+	unsigned int ticksLeft = UINT_MAX;
+
+	for (int i = 0; i < MAX_NUMBER_OF_TIMERS; i++) // the pool is small, looking at every timer is cheaper than walking the slots
+	{
+		if (wheel.timers[i].type != TIMER_FREE && wheel.timers[i].due - wheel.now < ticksLeft)
+		{
+			ticksLeft = wheel.timers[i].due - wheel.now;
+		}
+	}
+
+	return ticksLeft;
+}
+
+void SkipTimerWheel(TimerWheel& wheel, unsigned int numTicks)
+{
+	while (numTicks > 0)
+	{
+		unsigned int ticksToNextBlock = TIMER_WHEEL_SLOTS - wheel.now % TIMER_WHEEL_SLOTS;
+
+		if (numTicks < ticksToNextBlock)
+		{
+			wheel.now += numTicks; // the first level slots in between are empty
+			return;
+		}
+
+		wheel.now += ticksToNextBlock - 1;
+		numTicks -= ticksToNextBlock;
+		AdvanceTimerWheel(wheel); // crosses into the next block, bringing it down from the second level
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+/*
+Timer Wheel:
+
+Everything in the game that happens "n ticks from now" - an alien finishing its explosion, the swarm taking its next
+step, the wait before play resumes, the next UFO - is a timer on the game's wheel instead of its own countdown.
+
+Two levels of TIMER_WHEEL_SLOTS slots. A timer due within TIMER_WHEEL_SLOTS ticks goes in the first level at due %
+TIMER_WHEEL_SLOTS; a later one goes in the second level by due / TIMER_WHEEL_SLOTS and is moved down when the first
+level wraps around to it. Anything further out than the second level reaches waits in its last slot and is placed again
+on the way down. Advancing a tick only looks at one slot, so ticks where nothing is due cost nothing per timer.
+
+Time is counted in ticks, not clock ticks, and the wheel is plain data with indices instead of pointers, so it is saved
+and restored with the rest of the game (GameSnapshot) and plays back exactly the same in a replay.
+*/
+
+enum
+{
+	TIMER_WHEEL_SLOTS = 64,
+	TIMER_WHEEL_LEVELS = 2,
+	MAX_NUMBER_OF_TIMERS = 64,
+	NO_TIMER = -1,
+};
+
+enum TimerType
+{
+	TIMER_FREE = 0,
+	TIMER_ALIEN_EXPLOSION, // data - row * NUM_ALIEN_COLUMNS + column of the alien
+	TIMER_SWARM_STEP,
+	TIMER_WAIT_OVER,
+	TIMER_UFO_SPAWN,
+};
+
+struct Timer
+{
+	unsigned int due; // tick the timer fires on
+	short next; // next timer in the same slot or list
+	unsigned char type; // TimerType
+	unsigned char data;
+};
+
+struct TimerWheel
+{
+	unsigned int now; // ticks since the wheel was cleared
+	short expired; // timers that fired this tick and have not been popped yet
+	short freeTimers;
+	short slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	Timer timers[MAX_NUMBER_OF_TIMERS];
+};
+
+void ClearTimerWheel(TimerWheel& wheel);
+bool ScheduleTimer(TimerWheel& wheel, TimerType type, int data, unsigned int delay); // delay in ticks, at least 1, data 0 to 255 - returns false if every timer is in use or data does not fit
+void CancelTimers(TimerWheel& wheel, TimerType type); // every pending timer of this type, wherever it is
+void AdvanceTimerWheel(TimerWheel& wheel); // moves on a tick, the timers due on it are then popped with PopExpiredTimer
+bool PopExpiredTimer(TimerWheel& wheel, TimerType& type, int& data);
+
+unsigned int TicksUntilNextTimer(const TimerWheel& wheel); // 0 if timers are waiting to be popped, UINT_MAX if nothing is scheduled
+void SkipTimerWheel(TimerWheel& wheel, unsigned int numTicks); // same as numTicks AdvanceTimerWheel calls - nothing may be due in between
+
+#endif // TIMERWHEEL_H_